@@ -0,0 +1,657 @@
+#define _POSIX_C_SOURCE 200809L	 // clock_gettime
+
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "RasterModelBinary.h"
+#include "RasterScene.h"
+#include "RasterTarget.h"
+
+// Prints one JSON object per line on stdout, progress and errors go to stderr
+
+#define DEFAULT_ITERATIONS 50
+#define DEFAULT_WIDTH 1920
+#define DEFAULT_HEIGHT 1080
+
+#define TRIANGLES_PER_BATCH 1024
+
+#define MESH_RINGS 240
+#define MESH_SEGMENTS 256
+
+// World units seen by the model benches, the sphere being 4 units wide
+#define MODEL_VIEW_HEIGHT 5.0f
+#define MODEL_ZOOMED_VIEW_HEIGHT 0.5f
+
+// Small spheres on a grid twice as wide and high as the view, so about three quarters of them are culled
+#define INSTANCE_RINGS 8
+#define INSTANCE_SEGMENTS 12
+#define INSTANCE_GRID_SIZE 64
+#define INSTANCE_GRID_EXTENT 10.0f
+
+// Same spheres and spacing as the instances, over a grid the view only sees a small part of
+#define SCENE_GRID_SIZE 256
+
+#define TEXTURE_SIZE 512
+#define TEXTURE_CELLS 32
+
+#define BENCH_MODEL_PATH "lurasterizer_bench.obj"
+#define BENCH_BINARY_PATH "lurasterizer_bench.obj" RASTER_MODEL_BINARY_EXT
+#define BENCH_FRAME_PATH "lurasterizer_bench.bmp"
+#define BENCH_STREAM_PATH "lurasterizer_bench.video"
+
+typedef struct BenchOptions {
+	uint32_t iterations;
+	uint32_t width;
+	uint32_t height;
+	uint32_t threadCount;
+} BenchOptions;
+
+// Work done by a single iteration, used to derive the throughputs
+typedef struct BenchWork {
+	double vertices;
+	double triangles;  // Rasterized, for model draws (see MeasureDrawWork)
+	double trianglesSubmitted;
+	double trianglesCulled;
+	double pixels;
+	double bytes;
+} BenchWork;
+
+typedef void (*BenchFunc)(void* userData);
+
+static double NowSeconds(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int CompareDoubles(const void* a, const void* b) {
+	const double lhs = *(const double*)a;
+	const double rhs = *(const double*)b;
+	return (lhs > rhs) - (lhs < rhs);
+}
+
+static double Percentile(const double* sorted, uint32_t count, double percent) {
+	const uint32_t index = Min((uint32_t)ceil(percent / 100.0 * count), count) - 1;
+	return sorted[index];
+}
+
+static bool RunBench(const char* name, const BenchOptions* options, BenchWork work, BenchFunc func, void* userData) {
+	double* samples = NULL;
+	if (!Malloc(samples, options->iterations * sizeof(double))) return false;
+
+	LogMessage("Running %s...\n", name);
+	func(userData);	 // Warm up
+
+	double total = 0.0;
+	for (uint32_t i = 0; i < options->iterations; i++) {
+		const double start = NowSeconds();
+		func(userData);
+		samples[i] = NowSeconds() - start;
+		total += samples[i];
+	}
+	qsort(samples, options->iterations, sizeof(double), CompareDoubles);
+
+	printf("{\"name\":\"%s\",\"iterations\":%u,\"threads\":%u,\"mean_ns\":%.0f,\"p50_ns\":%.0f,\"p99_ns\":%.0f", name, options->iterations,
+		   options->threadCount, total / options->iterations * 1e9, Percentile(samples, options->iterations, 50) * 1e9,
+		   Percentile(samples, options->iterations, 99) * 1e9);
+	if (work.vertices > 0) printf(",\"vertices_per_sec\":%.0f", work.vertices * options->iterations / total);
+	if (work.triangles > 0) printf(",\"triangles_per_sec\":%.0f", work.triangles * options->iterations / total);
+	if (work.trianglesSubmitted > 0) {
+		printf(",\"triangles_submitted\":%.0f,\"triangles_culled\":%.0f,\"triangles_rasterized\":%.0f", work.trianglesSubmitted,
+			   work.trianglesCulled, work.triangles);
+	}
+	if (work.pixels > 0) printf(",\"pixels_per_sec\":%.0f", work.pixels * options->iterations / total);
+	if (work.bytes > 0) printf(",\"mb_per_sec\":%.2f", work.bytes * options->iterations / total / (1024.0 * 1024.0));
+	printf("}\n");
+	fflush(stdout);
+
+	Free(samples);
+	return true;
+}
+
+// Triangles a model draw rasterizes (once clipped) and culls, counted over one run of it, as most of the triangles
+// submitted by the zoomed in, instanced and scene draws are culled before even being transformed
+static BenchWork MeasureDrawWork(RasterTarget* screen, BenchFunc func, void* userData) {
+	const RasterCullStats start = RasterTargetGetCullStats(screen);
+	func(userData);
+	const RasterCullStats end = RasterTargetGetCullStats(screen);
+
+	return (BenchWork){
+		.triangles = end.rasterized - start.rasterized,
+		.trianglesSubmitted = end.submitted - start.submitted,
+		.trianglesCulled = (end.frustumCulled - start.frustumCulled) + (end.backFaceCulled - start.backFaceCulled) +
+						   (end.degenerate - start.degenerate),
+	};
+}
+
+// ============== Clear ==============
+
+// Alternating colors, so every clear rewrites the whole target
+static void BenchClear(void* userData) {
+	static bool pink = false;
+	pink = !pink;
+	RasterTargetClearBackground(userData, pink ? PINK : RAYWHITE);
+}
+
+// A single tile drawn to per clear, which then only rewrites that tile
+static void BenchClearTile(void* userData) {
+	RasterTarget* screen = userData;
+	RasterTargetDrawPixel(screen, 0, 0, WHITE);
+	RasterTargetClearBackground(screen, PINK);
+}
+
+// ============= Triangles =============
+
+typedef struct TriangleBatch {
+	RasterTarget* screen;
+	Vector2 vertices[TRIANGLES_PER_BATCH][3];
+} TriangleBatch;
+
+static float RandomRange(float min, float max) { return min + (max - min) * (rand() / (float)RAND_MAX); }
+
+// Random positions for a triangle of the given size, wound the way RasterTargetDrawTriangle draws
+static void FillTriangleBatch(TriangleBatch* batch, float sizeX, float sizeY) {
+	const float maxX = Max(batch->screen->width - sizeX, 1.0f);
+	const float maxY = Max(batch->screen->height - sizeY, 1.0f);
+
+	for (uint32_t i = 0; i < TRIANGLES_PER_BATCH; i++) {
+		const Vector2 a = (Vector2){.x = RandomRange(0, maxX), .y = RandomRange(0, maxY)};
+		batch->vertices[i][0] = a;
+		batch->vertices[i][1] = (Vector2){.x = a.x, .y = a.y + sizeY};
+		batch->vertices[i][2] = (Vector2){.x = a.x + sizeX, .y = a.y};
+	}
+}
+
+static double TriangleBatchPixels(const TriangleBatch* batch) {
+	const RasterRect bounds = (RasterRect){0, 0, batch->screen->width, batch->screen->height};
+
+	double pixels = 0;
+	for (uint32_t i = 0; i < TRIANGLES_PER_BATCH; i++) {
+		RasterTriangle tri;
+		if (!RasterTriangleSetup(&tri, batch->vertices[i][0], batch->vertices[i][1], batch->vertices[i][2], bounds)) continue;
+
+		for (int32_t y = tri.bounds.minY; y < tri.bounds.maxY; y++) {
+			int32_t spanMinX;
+			int32_t spanMaxX;
+			if (RasterTriangleRowSpan(&tri, y, &spanMinX, &spanMaxX)) pixels += spanMaxX - spanMinX;
+		}
+	}
+
+	return pixels;
+}
+
+static void BenchTriangles(void* userData) {
+	TriangleBatch* batch = userData;
+	for (uint32_t i = 0; i < TRIANGLES_PER_BATCH; i++) {
+		RasterTargetDrawTriangle(batch->screen, batch->vertices[i][0], batch->vertices[i][1], batch->vertices[i][2], WHITE);
+	}
+}
+
+static bool RunTriangleBenches(RasterTarget* screen, const BenchOptions* options) {
+	typedef struct TriangleShape {
+		const char* name;
+		float sizeX;
+		float sizeY;
+	} TriangleShape;
+
+	const TriangleShape shapes[] = {
+		{"draw_triangle_small", 4, 4},
+		{"draw_triangle_medium", 32, 32},
+		{"draw_triangle_large", 512, 512},
+		{"draw_triangle_sliver", 1024, 1},
+	};
+
+	TriangleBatch* batch = NULL;
+	if (!Malloc(batch, sizeof(TriangleBatch))) return false;
+	batch->screen = screen;
+
+	srand(1);
+	for (size_t i = 0; i < sizeof(shapes) / sizeof(shapes[0]); i++) {
+		FillTriangleBatch(batch, shapes[i].sizeX, shapes[i].sizeY);
+
+		const BenchWork work = (BenchWork){
+			.triangles = TRIANGLES_PER_BATCH,
+			.pixels = TriangleBatchPixels(batch),
+		};
+		if (!RunBench(shapes[i].name, options, work, BenchTriangles, batch)) FreeAndReturn(batch, false);
+	}
+
+	Free(batch);
+	return true;
+}
+
+// ============== Models ==============
+
+// UV sphere made of quads, written as text so the loader gets benchmarked on a multi-megabyte file too
+static bool WriteSphereObj(const char* path, uint32_t rings, uint32_t segments, double* fileSize) {
+	FILE* file = TryOpenFile(path, "w");
+	if (!file) return false;
+
+	const float radius = 2.0f;
+	for (uint32_t ring = 0; ring <= rings; ring++) {
+		const float theta = PI * ring / rings;
+		for (uint32_t segment = 0; segment < segments; segment++) {
+			const float phi = 2.0f * PI * segment / segments;
+			fprintf(file, "v %f %f %f\n", radius * sinf(theta) * cosf(phi), radius * cosf(theta), radius * sinf(theta) * sinf(phi));
+		}
+	}
+
+	for (uint32_t ring = 0; ring <= rings; ring++) {
+		for (uint32_t segment = 0; segment < segments; segment++) {
+			fprintf(file, "vt %f %f\n", segment / (float)segments, ring / (float)rings);
+		}
+	}
+	fprintf(file, "vn 0.0000 1.0000 0.0000\n");
+
+	for (uint32_t ring = 0; ring < rings; ring++) {
+		for (uint32_t segment = 0; segment < segments; segment++) {
+			const uint32_t a = ring * segments + segment + 1;
+			const uint32_t b = ring * segments + (segment + 1) % segments + 1;
+			const uint32_t c = (ring + 1) * segments + (segment + 1) % segments + 1;
+			const uint32_t d = (ring + 1) * segments + segment + 1;
+			fprintf(file, "f %u/%u/1 %u/%u/1 %u/%u/1 %u/%u/1\n", a, a, b, b, c, c, d, d);
+		}
+	}
+
+	*fileSize = ftell(file);
+
+	CloseFile(file);
+	return true;
+}
+
+static void BenchLoadObj(void* userData) {
+	RasterModel* model = LoadRasterModelFromObj(userData);
+	if (model) RasterModelFree(model);
+}
+
+static void BenchLoadBinary(void* userData) {
+	RasterModel* model = LoadRasterModelFromBinary(userData, NULL);
+	if (model) RasterModelFree(model);
+}
+
+static bool RunLoadBenches(const RasterModel* model, const BenchOptions* options, double objSize) {
+	const BenchWork objWork = (BenchWork){.bytes = objSize};
+	if (!RunBench("load_model_obj", options, objWork, BenchLoadObj, BENCH_MODEL_PATH)) return false;
+
+	uint64_t binarySize;
+	int64_t modificationTime;
+	if (!RasterModelSaveBinary(model, BENCH_BINARY_PATH, (RasterModelSourceInfo){0})) return false;
+	if (!RasterFileStat(BENCH_BINARY_PATH, &binarySize, &modificationTime)) return false;
+
+	const BenchWork binaryWork = (BenchWork){.bytes = binarySize};
+	return RunBench("load_model_binary", options, binaryWork, BenchLoadBinary, BENCH_BINARY_PATH);
+}
+
+typedef struct ModelDraw {
+	RasterTarget* screen;
+	const RasterModel* model;
+} ModelDraw;
+
+// Depth tested draws start from a cleared depth buffer, or everything would be occluded after the first iteration
+// Multisampled draws are resolved, as they would be before being output
+static void BenchDrawModel(void* userData) {
+	ModelDraw* draw = userData;
+	if (draw->screen->depth) RasterDepthBufferClear(draw->screen->depth);
+	RasterTargetDrawModel(draw->screen, draw->model);
+	RasterTargetResolve(draw->screen);
+}
+
+typedef struct ModelTransform {
+	const RasterModel* model;
+	RasterScreenVertex* screenVertices;
+	uint16_t* outcodes;
+	uint32_t width;
+	uint32_t height;
+} ModelTransform;
+
+static void BenchTransformModel(void* userData) {
+	ModelTransform* transform = userData;
+	const Matrix mvp = RasterDefaultViewProjection(transform->width, transform->height, MODEL_VIEW_HEIGHT);
+	RasterTransformVertices(transform->model->positions, transform->model->verticesSize, mvp, transform->width, transform->height,
+							transform->screenVertices, transform->outcodes);
+}
+
+static bool RunTransformBench(RasterTarget* screen, const BenchOptions* options, const RasterModel* model) {
+	ModelTransform transform = (ModelTransform){.model = model, .width = screen->width, .height = screen->height};
+	if (!Malloc(transform.screenVertices, Max(model->verticesSize, 1) * sizeof(RasterScreenVertex))) return false;
+	if (!Malloc(transform.outcodes, Max(model->verticesSize, 1) * sizeof(uint16_t))) FreeAndReturn(transform.screenVertices, false);
+
+	const BenchWork work = (BenchWork){.vertices = model->verticesSize};
+	const bool success = RunBench("transform_sphere", options, work, BenchTransformModel, &transform);
+
+	Free(transform.screenVertices);
+	Free(transform.outcodes);
+	return success;
+}
+
+// Same as RasterDefaultViewProjection, but always with the depth range of the whole view, the default one shrinking with
+// the view would clip the whole sphere away once zoomed in
+static Matrix ModelViewProjection(uint32_t width, uint32_t height, float heightInWorld) {
+	const double halfHeight = heightInWorld / 2.0;
+	const double halfWidth = halfHeight * width / height;
+	return MatrixOrtho(-halfWidth, halfWidth, halfHeight, -halfHeight, MODEL_VIEW_HEIGHT, -MODEL_VIEW_HEIGHT);
+}
+
+static bool RunDrawModelBenches(RasterTarget* screen, const BenchOptions* options, const RasterModel* model) {
+	const struct {
+		const char* name;
+		RasterDepthFormat depthFormat;
+		RasterShading shading;
+		bool textured;
+		RasterTextureFilter filter;
+		float heightInWorld;  // The zoomed in view only sees a small part of the sphere, most of its meshlets are culled
+		uint32_t samplesCount;
+	} variants[] = {
+		{"draw_model_sphere", RASTER_DEPTH_NONE, RASTER_SHADING_FLAT, false, RASTER_TEXTURE_NEAREST, MODEL_VIEW_HEIGHT, 1},
+		{"draw_model_sphere_depth16", RASTER_DEPTH_16, RASTER_SHADING_FLAT, false, RASTER_TEXTURE_NEAREST, MODEL_VIEW_HEIGHT, 1},
+		{"draw_model_sphere_depth32", RASTER_DEPTH_32F, RASTER_SHADING_FLAT, false, RASTER_TEXTURE_NEAREST, MODEL_VIEW_HEIGHT, 1},
+		{"draw_model_sphere_vertex", RASTER_DEPTH_NONE, RASTER_SHADING_VERTEX, false, RASTER_TEXTURE_NEAREST, MODEL_VIEW_HEIGHT, 1},
+		{"draw_model_sphere_lambert", RASTER_DEPTH_NONE, RASTER_SHADING_LAMBERT, false, RASTER_TEXTURE_NEAREST, MODEL_VIEW_HEIGHT, 1},
+		{"draw_model_sphere_lambert_depth32", RASTER_DEPTH_32F, RASTER_SHADING_LAMBERT, false, RASTER_TEXTURE_NEAREST, MODEL_VIEW_HEIGHT, 1},
+		{"draw_model_sphere_depth_only32", RASTER_DEPTH_32F, RASTER_SHADING_DEPTH_ONLY, false, RASTER_TEXTURE_NEAREST, MODEL_VIEW_HEIGHT, 1},
+		{"draw_model_sphere_nearest", RASTER_DEPTH_NONE, RASTER_SHADING_FLAT, true, RASTER_TEXTURE_NEAREST, MODEL_VIEW_HEIGHT, 1},
+		{"draw_model_sphere_bilinear", RASTER_DEPTH_NONE, RASTER_SHADING_FLAT, true, RASTER_TEXTURE_BILINEAR, MODEL_VIEW_HEIGHT, 1},
+		{"draw_model_sphere_bilinear_depth32", RASTER_DEPTH_32F, RASTER_SHADING_FLAT, true, RASTER_TEXTURE_BILINEAR, MODEL_VIEW_HEIGHT, 1},
+		{"draw_model_sphere_zoomed", RASTER_DEPTH_NONE, RASTER_SHADING_FLAT, false, RASTER_TEXTURE_NEAREST, MODEL_ZOOMED_VIEW_HEIGHT, 1},
+		{"draw_model_sphere_msaa4", RASTER_DEPTH_NONE, RASTER_SHADING_FLAT, false, RASTER_TEXTURE_NEAREST, MODEL_VIEW_HEIGHT, 4},
+		{"draw_model_sphere_msaa8", RASTER_DEPTH_NONE, RASTER_SHADING_FLAT, false, RASTER_TEXTURE_NEAREST, MODEL_VIEW_HEIGHT, 8},
+		{"draw_model_sphere_lambert_msaa4", RASTER_DEPTH_NONE, RASTER_SHADING_LAMBERT, false, RASTER_TEXTURE_NEAREST, MODEL_VIEW_HEIGHT, 4},
+		{"draw_model_sphere_bilinear_msaa4", RASTER_DEPTH_NONE, RASTER_SHADING_FLAT, true, RASTER_TEXTURE_BILINEAR, MODEL_VIEW_HEIGHT, 4},
+		{"draw_model_sphere_depth32_msaa4", RASTER_DEPTH_32F, RASTER_SHADING_FLAT, false, RASTER_TEXTURE_NEAREST, MODEL_VIEW_HEIGHT, 4},
+	};
+
+	RasterTexture* texture = RasterTextureCreateChecker(TEXTURE_SIZE, TEXTURE_CELLS, RAYWHITE, DARKGRAY, true);
+	if (!texture) return false;
+
+	ModelDraw draw = (ModelDraw){.screen = screen, .model = model};
+
+	bool success = true;
+	for (uint32_t i = 0; i < sizeof(variants) / sizeof(variants[0]) && success; i++) {
+		RasterTargetSetTexture(screen, variants[i].textured ? texture : NULL, variants[i].filter);
+		RasterTargetSetShading(screen, variants[i].shading);
+		RasterTargetSetViewProjection(screen, ModelViewProjection(screen->width, screen->height, variants[i].heightInWorld));
+		success = RasterTargetSetDepthFormat(screen, variants[i].depthFormat) && RasterTargetSetSampleCount(screen, variants[i].samplesCount);
+		if (!success) break;
+
+		const BenchWork work = MeasureDrawWork(screen, BenchDrawModel, &draw);
+		success = RunBench(variants[i].name, options, work, BenchDrawModel, &draw);
+	}
+
+	RasterTargetSetTexture(screen, NULL, RASTER_TEXTURE_NEAREST);
+	RasterTargetSetShading(screen, RASTER_SHADING_FLAT);
+	RasterTargetSetViewProjection(screen, RasterDefaultViewProjection(screen->width, screen->height, MODEL_VIEW_HEIGHT));
+	RasterTargetSetDepthFormat(screen, RASTER_DEPTH_NONE);
+	RasterTargetSetSampleCount(screen, 1);
+	RasterTextureFree(texture);
+	return success;
+}
+
+static bool RunModelBenches(RasterTarget* screen, const BenchOptions* options) {
+	double fileSize;
+	if (!WriteSphereObj(BENCH_MODEL_PATH, MESH_RINGS, MESH_SEGMENTS, &fileSize)) return false;
+
+	RasterModel* model = LoadRasterModelFromObj(BENCH_MODEL_PATH);
+	const bool loaded = model && RunLoadBenches(model, options, fileSize);
+	remove(BENCH_MODEL_PATH);
+	remove(BENCH_BINARY_PATH);
+	if (!loaded) {
+		if (model) RasterModelFree(model);
+		return false;
+	}
+
+	const bool success = RunTransformBench(screen, options, model) && RunDrawModelBenches(screen, options, model);
+
+	RasterModelFree(model);
+	return success;
+}
+
+// ============= Instances =============
+
+typedef struct InstancesDraw {
+	RasterTarget* screen;
+	const RasterModel* model;
+	const Matrix* transforms;
+	uint32_t instancesCount;
+} InstancesDraw;
+
+static void BenchDrawInstanced(void* userData) {
+	InstancesDraw* draw = userData;
+	RasterDepthBufferClear(draw->screen->depth);
+	RasterTargetDrawModelInstanced(draw->screen, draw->model, draw->transforms, NULL, draw->instancesCount);
+}
+
+// Same draw as BenchDrawInstanced, one model at a time
+static void BenchDrawInstancesLoop(void* userData) {
+	InstancesDraw* draw = userData;
+	RasterDepthBufferClear(draw->screen->depth);
+	for (uint32_t i = 0; i < draw->instancesCount; i++) RasterTargetDrawModelEx(draw->screen, draw->model, draw->transforms[i]);
+}
+
+static bool RunInstanceBenches(RasterTarget* screen, const BenchOptions* options) {
+	double fileSize;
+	if (!WriteSphereObj(BENCH_MODEL_PATH, INSTANCE_RINGS, INSTANCE_SEGMENTS, &fileSize)) return false;
+
+	RasterModel* model = LoadRasterModelFromObj(BENCH_MODEL_PATH);
+	remove(BENCH_MODEL_PATH);
+	if (!model) return false;
+
+	const uint32_t instancesCount = INSTANCE_GRID_SIZE * INSTANCE_GRID_SIZE;
+	Matrix* transforms = NULL;
+	if (!Malloc(transforms, instancesCount * sizeof(Matrix))) {
+		RasterModelFree(model);
+		return false;
+	}
+
+	const float spacing = 2.0f * INSTANCE_GRID_EXTENT / INSTANCE_GRID_SIZE;
+	for (uint32_t i = 0; i < instancesCount; i++) {
+		const float x = -INSTANCE_GRID_EXTENT + spacing * (i % INSTANCE_GRID_SIZE + 0.5f);
+		const float y = -INSTANCE_GRID_EXTENT + spacing * (i / INSTANCE_GRID_SIZE + 0.5f);
+		transforms[i] = MatrixMultiply(MatrixScale(spacing / 2.0f, spacing / 2.0f, spacing / 2.0f), MatrixTranslate(x, y, 0.0f));
+	}
+
+	InstancesDraw draw = (InstancesDraw){.screen = screen, .model = model, .transforms = transforms, .instancesCount = instancesCount};
+
+	// Both draws cull the same copies, so they rasterize the same triangles
+	bool success = RasterTargetSetDepthFormat(screen, RASTER_DEPTH_32F);
+	if (success) {
+		const BenchWork work = MeasureDrawWork(screen, BenchDrawInstanced, &draw);
+		success = RunBench("draw_instanced_spheres", options, work, BenchDrawInstanced, &draw);
+		success = success && RunBench("draw_instances_loop", options, work, BenchDrawInstancesLoop, &draw);
+	}
+
+	RasterTargetSetDepthFormat(screen, RASTER_DEPTH_NONE);
+	Free(transforms);
+	RasterModelFree(model);
+	return success;
+}
+
+// ============= Scenes =============
+
+typedef struct SceneDraw {
+	RasterTarget* screen;
+	RasterScene* scene;
+	const RasterModel* model;
+	const Matrix* transforms;
+	uint32_t objectsCount;
+} SceneDraw;
+
+static void BenchCullScene(void* userData) {
+	SceneDraw* draw = userData;
+	RasterSceneCull(draw->scene, draw->screen->viewProjection);
+}
+
+static void BenchDrawScene(void* userData) {
+	SceneDraw* draw = userData;
+	RasterDepthBufferClear(draw->screen->depth);
+	RasterSceneDraw(draw->scene, draw->screen);
+}
+
+// Same draw as BenchDrawScene, culling every object one by one instead of through the hierarchy
+static void BenchDrawSceneInstanced(void* userData) {
+	SceneDraw* draw = userData;
+	RasterDepthBufferClear(draw->screen->depth);
+	RasterTargetDrawModelInstanced(draw->screen, draw->model, draw->transforms, NULL, draw->objectsCount);
+}
+
+static bool RunSceneBenches(RasterTarget* screen, const BenchOptions* options) {
+	double fileSize;
+	if (!WriteSphereObj(BENCH_MODEL_PATH, INSTANCE_RINGS, INSTANCE_SEGMENTS, &fileSize)) return false;
+
+	RasterModel* model = LoadRasterModelFromObj(BENCH_MODEL_PATH);
+	remove(BENCH_MODEL_PATH);
+	if (!model) return false;
+
+	const uint32_t objectsCount = SCENE_GRID_SIZE * SCENE_GRID_SIZE;
+	Matrix* transforms = NULL;
+	RasterScene* scene = RasterSceneCreate();
+	if (!scene || !Malloc(transforms, objectsCount * sizeof(Matrix))) {
+		if (scene) RasterSceneFree(scene);
+		RasterModelFree(model);
+		return false;
+	}
+
+	bool success = true;
+	const float spacing = 2.0f * INSTANCE_GRID_EXTENT / INSTANCE_GRID_SIZE;
+	const float extent = spacing * SCENE_GRID_SIZE / 2.0f;
+	for (uint32_t i = 0; i < objectsCount && success; i++) {
+		const float x = -extent + spacing * (i % SCENE_GRID_SIZE + 0.5f);
+		const float y = -extent + spacing * (i / SCENE_GRID_SIZE + 0.5f);
+		transforms[i] = MatrixMultiply(MatrixScale(spacing / 2.0f, spacing / 2.0f, spacing / 2.0f), MatrixTranslate(x, y, 0.0f));
+		success = RasterSceneAdd(scene, model, transforms[i]) != RASTER_SCENE_INVALID_ID;
+	}
+
+	SceneDraw draw = (SceneDraw){.screen = screen, .scene = scene, .model = model, .transforms = transforms, .objectsCount = objectsCount};
+
+	success = success && RasterSceneUpdate(scene) && RasterTargetSetDepthFormat(screen, RASTER_DEPTH_32F);
+	success = success && RunBench("cull_scene", options, (BenchWork){0}, BenchCullScene, &draw);
+	if (success) {
+		const BenchWork work = MeasureDrawWork(screen, BenchDrawScene, &draw);
+		success = RunBench("draw_scene_spheres", options, work, BenchDrawScene, &draw);
+	}
+	if (success) {
+		const BenchWork work = MeasureDrawWork(screen, BenchDrawSceneInstanced, &draw);
+		success = RunBench("draw_scene_spheres_instanced", options, work, BenchDrawSceneInstanced, &draw);
+	}
+
+	RasterTargetSetDepthFormat(screen, RASTER_DEPTH_NONE);
+	RasterSceneFree(scene);
+	Free(transforms);
+	RasterModelFree(model);
+	return success;
+}
+
+// ============== Save ==============
+
+static void BenchSave(void* userData) { RasterTargetSaveToFile(userData, BENCH_FRAME_PATH); }
+
+static bool RunSaveBench(RasterTarget* screen, const BenchOptions* options) {
+	const uint32_t rowSize = (screen->width * 3 + 3) & -4;
+	const BenchWork work = (BenchWork){
+		.pixels = screen->width * screen->height,
+		.bytes = 54.0 + rowSize * screen->height,
+	};
+
+	const bool success = RunBench("save_bmp", options, work, BenchSave, screen);
+	remove(BENCH_FRAME_PATH);
+	return success;
+}
+
+// Synchronous streams, so the conversion and write of every frame is timed
+static void BenchStream(void* userData) { RasterTargetStreamFrame(userData); }
+
+static bool RunStreamBenches(RasterTarget* screen, const BenchOptions* options) {
+	const double pixelsCount = (double)screen->width * screen->height;
+	const struct {
+		const char* name;
+		RasterVideoFormat format;
+		double bytesPerPixel;
+	} variants[] = {
+		{"stream_y4m", RASTER_VIDEO_Y4M, 1.5},
+		{"stream_ppm", RASTER_VIDEO_PPM, 3.0},
+	};
+
+	bool success = true;
+	for (uint32_t i = 0; i < sizeof(variants) / sizeof(variants[0]) && success; i++) {
+		const BenchWork work = (BenchWork){.pixels = pixelsCount, .bytes = pixelsCount * variants[i].bytesPerPixel};
+
+		success = RasterTargetOpenVideoStream(screen, BENCH_STREAM_PATH, variants[i].format, 30, 0);
+		success = success && RunBench(variants[i].name, options, work, BenchStream, screen);
+		success = RasterTargetCloseVideoStream(screen) && success;
+	}
+
+	remove(BENCH_STREAM_PATH);
+	return success;
+}
+
+// ============== Main ==============
+
+static bool ParseUInt32Arg(const char* arg, uint32_t minValue, uint32_t maxValue, uint32_t* value) {
+	char* end = NULL;
+	const unsigned long long parsed = strtoull(arg, &end, 10);
+	if (end == arg || *end || *arg == '-' || parsed < minValue || parsed > maxValue) return false;
+
+	*value = parsed;
+	return true;
+}
+
+static bool ParseArgs(BenchOptions* options, int argc, char** argv) {
+	*options = (BenchOptions){
+		.iterations = DEFAULT_ITERATIONS,
+		.width = DEFAULT_WIDTH,
+		.height = DEFAULT_HEIGHT,
+		.threadCount = 1,
+	};
+
+	for (int32_t i = 1; i + 1 < argc; i += 2) {
+		const char* arg = argv[i];
+		const char* value = argv[i + 1];
+
+		bool validArg = false;
+		if (strcmp(arg, "-n") == 0) validArg = ParseUInt32Arg(value, 1, UINT32_MAX, &options->iterations);
+		if (strcmp(arg, "-w") == 0) validArg = ParseUInt32Arg(value, 1, 16384, &options->width);
+		if (strcmp(arg, "-h") == 0) validArg = ParseUInt32Arg(value, 1, 16384, &options->height);
+		if (strcmp(arg, "-t") == 0) validArg = ParseUInt32Arg(value, 0, UINT16_MAX, &options->threadCount);
+		if (!validArg) return false;
+	}
+
+	return (argc % 2) == 1;
+}
+
+int main(int argc, char** argv) {
+	BenchOptions options;
+	if (!ParseArgs(&options, argc, argv)) {
+		LogMessage("Usage: %s [-n <iterations>] [-w <width>] [-h <height>] [-t <threads, 0 for one per core>]\n", argv[0]);
+		exit(EXIT_FAILURE);
+	}
+
+	RasterTarget* screen = RasterTargetCreateHeadless(options.width, options.height);
+	if (!screen) exit(EXIT_FAILURE);
+
+	if (!RasterTargetSetThreadCount(screen, options.threadCount)) LogString("Could not start the raster worker threads\n");
+	options.threadCount = RasterTargetGetThreadCount(screen);
+
+	bool success = true;
+
+	const BenchWork clearWork = (BenchWork){
+		.pixels = options.width * options.height,
+		.bytes = options.width * options.height * sizeof(Color),
+	};
+	success = success && RunBench("clear_background", &options, clearWork, BenchClear, screen);
+
+	const BenchWork clearTileWork = (BenchWork){
+		.pixels = RASTER_TILE_SIZE * RASTER_TILE_SIZE,
+		.bytes = RASTER_TILE_SIZE * RASTER_TILE_SIZE * sizeof(Color),
+	};
+	success = success && RunBench("clear_background_tile", &options, clearTileWork, BenchClearTile, screen);
+
+	success = success && RunTriangleBenches(screen, &options);
+	success = success && RunModelBenches(screen, &options);
+	success = success && RunInstanceBenches(screen, &options);
+	success = success && RunSceneBenches(screen, &options);
+	success = success && RunSaveBench(screen, &options);
+	success = success && RunStreamBenches(screen, &options);
+
+	RasterTargetFree(screen);
+	exit(success ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -1,12 +1,27 @@
 #ifndef APP_H
 #define APP_H
 
+#include "RasterGovernor.h"
+#include "RasterPipeline.h"
+#include "RasterScene.h"
 #include "RasterTarget.h"
 
 typedef struct App {
 	RasterTarget* rasterTarget;
 
 	RasterModel* cubeModel;
+	RasterTexture* cubeTexture;
+	uint32_t cubeShading;  // Flat colors, Lambert lighting, then nearest and bilinear texturing, cycled with F4
+
+	RasterScene* scene;	 // Grid of cubeModel
+
+	RasterPipeline* pipeline;  // Renders the next frame while the current one is presented
+	double time;			   // Of the frame being rendered
+
+	RasterGovernor governor;  // Scales the viewport to hold the frame rate
+	bool dynamicResolution;	  // Toggled with F5, the whole target is drawn otherwise
+
+	bool showStats;  // Toggled with F3
 } App;
 
 bool AppInit(App* app);
@@ -0,0 +1,36 @@
+#ifndef BATCH_RENDER_H
+#define BATCH_RENDER_H
+
+#include "RasterPipeline.h"
+
+// Renders a model into a headless RasterTarget and saves every frame, never initialising a window or GL
+typedef struct BatchRenderOptions {
+	const char* modelPath;
+	const char* outputPrefix;  // Frame i is saved to "<outputPrefix><i, 4 digits>.bmp"
+
+	uint32_t framesCount;
+	uint32_t width;
+	uint32_t height;
+	uint32_t threadCount;  // Same as RasterTargetSetThreadCount, 0 uses every core
+	RasterDepthFormat depthFormat;
+	uint32_t samplesCount;  // Same as RasterTargetSetSampleCount, only without depth buffer
+	RasterCullMode cullMode;
+	RasterShading shading;
+	const char* texturePath;  // Models are textured when set, "checker" generates a checkerboard
+	RasterTextureFilter textureFilter;
+	uint32_t saveQueueDepth;  // Same as RasterTargetSetSaveQueueDepth, 0 saves synchronously
+	uint32_t buffersCount;	  // 2 renders the next frame on a RasterPipeline thread while the previous one is output
+
+	const char* streamPath;  // Frames are streamed there instead of being saved when set
+	RasterVideoFormat streamFormat;
+	uint32_t framesPerSecond;
+
+	const char* statsPath;  // Per frame stats are written there when set, as JSON lines if it ends with .json or .jsonl, CSV otherwise
+} BatchRenderOptions;
+
+void BatchRenderPrintUsage(const char* programName);
+bool BatchRenderParseArgs(BatchRenderOptions* options, int argc, char** argv);
+
+bool BatchRender(const BatchRenderOptions* options);
+
+#endif	// BATCH_RENDER_H
@@ -0,0 +1,43 @@
+#ifndef RASTER_ARENA_H
+#define RASTER_ARENA_H
+
+#include "RasterCommon.h"
+
+// Every allocation is aligned on this, which covers every type stored in arenas and SIMD loads
+#define RASTER_ARENA_ALIGNMENT 16
+
+typedef struct RasterArenaBlock RasterArenaBlock;
+
+// Linear allocator, allocations are carved out of large blocks in order and are only freed all at once, or back to a mark
+typedef struct RasterArena {
+	RasterArenaBlock* block;  // The one allocations are carved from, linked to the previous ones
+	size_t blockSize;		  // Minimum size of the blocks, larger allocations get a block of their own
+
+	uint32_t blocksCount;
+	size_t reservedSize;  // Bytes currently held in blocks
+	size_t peakSize;	  // Most bytes held at once since the arena was initialized
+} RasterArena;
+
+// Position in an arena to rewind it to
+typedef struct RasterArenaMark {
+	RasterArenaBlock* block;
+	size_t used;
+} RasterArenaMark;
+
+// No block is allocated until the first allocation
+void RasterArenaInit(RasterArena* arena, size_t blockSize);
+void RasterArenaFree(RasterArena* arena);
+
+// Returns NULL if out of memory, size can be 0
+void* RasterArenaAlloc(RasterArena* arena, size_t size);
+// Same as RasterArenaAlloc, NULL if count * elementSize overflows too
+void* RasterArenaAllocArray(RasterArena* arena, size_t count, size_t elementSize);
+
+// Size actually taken from a block by an allocation of size bytes, to size an arena exactly
+size_t RasterArenaAlignedSize(size_t size);
+
+RasterArenaMark RasterArenaGetMark(const RasterArena* arena);
+// Frees every allocation made since the mark, and the blocks that only held those
+void RasterArenaRewind(RasterArena* arena, RasterArenaMark mark);
+
+#endif	// RASTER_ARENA_H
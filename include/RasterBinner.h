@@ -0,0 +1,63 @@
+#ifndef RASTER_BINNER_H
+#define RASTER_BINNER_H
+
+#include "RasterDepth.h"
+
+#include <LuLib/LuArray.h>
+
+#define RASTER_TILE_SIZE 64
+
+DeclareArrayType(RasterTriangle, RasterTriangleArray);
+DeclareArrayMethods(RasterTriangle, RasterTriangleArray);
+
+DeclareArrayType(Color, RasterColorArray);
+DeclareArrayMethods(Color, RasterColorArray);
+
+DeclareArrayType(RasterUVPlanes, RasterUVPlanesArray);
+DeclareArrayMethods(RasterUVPlanes, RasterUVPlanesArray);
+
+DeclareArrayType(RasterColorPlanes, RasterColorPlanesArray);
+DeclareArrayMethods(RasterColorPlanes, RasterColorPlanesArray);
+
+DeclareArrayType(uint32_t, RasterTileBin);
+DeclareArrayMethods(uint32_t, RasterTileBin);
+
+// Sorts set up triangles into RASTER_TILE_SIZE squared screen tiles, each tile keeping them in submission order, so
+// tiles can be rasterized independently (and concurrently) with the same result as drawing the triangles in order
+typedef struct RasterBinner {
+	RasterTriangleArray* triangles;
+	RasterColorArray* colors;
+	RasterUVPlanesArray* uvPlanes;		  // One per triangle with a textured kernel, empty otherwise
+	RasterColorPlanesArray* colorPlanes;  // One per triangle with the Gouraud kernel, empty otherwise
+
+	// Every binned triangle is filled the same way
+	RasterShadeKernel kernel;
+	RasterFillFunc fill;
+	const RasterTexture* texture;  // Sampled by the textured kernels
+
+	RasterTileBin** tiles;
+	uint32_t tilesX;
+	uint32_t tilesY;
+	uint32_t tilesSize;	 // Bins allocated, for the size the binner was created with
+} RasterBinner;
+
+RasterBinner* RasterBinnerCreate(uint32_t width, uint32_t height);
+void RasterBinnerFree(RasterBinner* binner);
+
+// Bins the triangles of a smaller (or the original) size from now on, reusing the bins, false if it needs more of them
+// Also resets the binner
+bool RasterBinnerSetSize(RasterBinner* binner, uint32_t width, uint32_t height);
+void RasterBinnerReset(RasterBinner* binner);
+// Flat triangles filled without depth test by default, only change it while the binner is empty
+// fill must be the kernel's, selected for the depth format of the buffers the tiles are drawn with
+void RasterBinnerSetKernel(RasterBinner* binner, RasterShadeKernel kernel, RasterFillFunc fill, const RasterTexture* texture);
+// uv is only read by the textured kernels, colorPlanes by the Gouraud one
+bool RasterBinnerPush(RasterBinner* binner, const RasterTriangle* tri, Color col, const RasterUVPlanes* uv,
+					  const RasterColorPlanes* colorPlanes);
+
+RasterRect RasterBinnerTileRect(const RasterBinner* binner, uint32_t tileIndex);
+// Depth tests the triangles if target->depth isn't NULL, which the fill must have been selected for, as for the sample
+// buffer (tiles are aligned on the depth blocks, so they don't share any)
+RasterFillCounts RasterBinnerDrawTile(const RasterBinner* binner, uint32_t tileIndex, const RasterFillTarget* target);
+
+#endif	// RASTER_BINNER_H
@@ -0,0 +1,38 @@
+#ifndef RASTER_CULL_H
+#define RASTER_CULL_H
+
+#include "RasterTransform.h"
+
+// Front faces are counter-clockwise on the screen, the winding RasterTriangleSetup draws
+typedef enum RasterCullMode {
+	RASTER_CULL_BACK = 0,
+	RASTER_CULL_FRONT,
+	RASTER_CULL_NONE,
+} RasterCullMode;
+
+// Triangles of drawn models, counted by the first test that removed them
+typedef struct RasterCullStats {
+	uint64_t submitted;
+	uint64_t frustumCulled;    // Entirely outside of the view, or nothing left once clipped
+	uint64_t backFaceCulled;   // Facing away from the camera for RASTER_CULL_BACK, towards it for RASTER_CULL_FRONT
+	uint64_t degenerate;       // No area on the screen
+	uint64_t clipped;          // Crossed the near or far plane or the guard band, and were clipped
+	uint64_t rasterized;       // Triangles given to setup, each clipped triangle can add several of them
+	uint64_t instancesCulled;  // Instanced copies entirely outside of the view, their triangles count as frustumCulled
+	uint64_t meshletsCulled;   // Meshlets outside of the view or facing away, their triangles count as culled for that reason
+} RasterCullStats;
+
+// Each clipping plane adds at most one vertex to the triangle
+#define RASTER_CLIP_MAX_VERTICES 9
+
+// Clips the transformed triangle against the planes in RASTER_OUT_CLIP_MASK its outcodes cross, and divides the
+// vertices of the resulting convex polygon, which keeps the triangle's winding
+// weights (unless NULL) gets the barycentric weights of each polygon vertex in the triangle, to interpolate attributes
+// Returns the polygon's vertex count, 0 if nothing is left of it
+uint32_t RasterClipTriangle(const RasterScreenVertex* triangle[3], const uint16_t outcodes[3], RasterScreenVertex* polygon,
+							Vector3* weights);
+
+// Twice the signed area of the divided polygon on the screen, positive for front faces
+double RasterPolygonArea(const RasterScreenVertex* polygon, uint32_t size);
+
+#endif	// RASTER_CULL_H
@@ -0,0 +1,55 @@
+#ifndef RASTER_DEPTH_H
+#define RASTER_DEPTH_H
+
+#include "RasterShade.h"
+
+// Depths are in [0, 1], smaller is nearer, and a pixel is only drawn if it is strictly nearer than the stored depth
+#define RASTER_DEPTH_FAR 1.0f
+
+typedef enum RasterDepthFormat {
+	RASTER_DEPTH_NONE = 0,
+	RASTER_DEPTH_16,   // Unsigned normalized, depths are clamped to [0, 1]
+	RASTER_DEPTH_32F,  // Not clamped
+} RasterDepthFormat;
+
+// Per pixel depths, laid out like the target's pixels, with a conservative depth range per RASTER_BLOCK_SIZE squared
+// block (aligned on the buffer's origin) so whole triangles and blocks can be rejected without testing their pixels
+typedef struct RasterDepthBuffer {
+	RasterDepthFormat format;
+	void* values;  // uint16_t or float per pixel
+	uint32_t width;
+	uint32_t height;
+
+	float* blocksMin;  // Never above the nearest depth stored in the block
+	float* blocksMax;  // Never below the farthest depth stored in the block
+	uint32_t blocksX;
+	uint32_t blocksY;
+
+	uint32_t maxWidth;	// Size the buffer was created with
+	uint32_t maxHeight;
+} RasterDepthBuffer;
+
+RasterDepthBuffer* RasterDepthBufferCreate(uint32_t width, uint32_t height, RasterDepthFormat format);
+void RasterDepthBufferFree(RasterDepthBuffer* depth);
+
+// Lays the buffer out for a size up to the one it was created with, reusing its storage, and clears it
+bool RasterDepthBufferSetSize(RasterDepthBuffer* depth, uint32_t width, uint32_t height);
+
+void RasterDepthBufferClear(RasterDepthBuffer* depth);
+// rect must be aligned on the blocks (or end on the buffer's edges), as the blocks it overlaps are reset too
+void RasterDepthBufferClearRect(RasterDepthBuffer* depth, RasterRect rect);
+
+// True if the triangle is behind everything already stored under its bounds
+bool RasterDepthBufferIsOccluded(const RasterDepthBuffer* depth, const RasterTriangle* tri);
+
+// Tests the center of a single pixel against the plane, storing its depth if it is nearer and store is set
+// Only the nearest depth of the pixel's block is updated, RasterDepthBufferUpdateFarthest then updates the farthest
+// depths of the blocks overlapping rect, once all of their pixels are written
+bool RasterDepthBufferTestPixel(RasterDepthBuffer* depth, const RasterDepthPlane* plane, int32_t x, int32_t y, bool store);
+void RasterDepthBufferUpdateFarthest(RasterDepthBuffer* depth, RasterRect rect);
+
+// Kernels filling the pixels of a triangle nearer than the stored depths, and storing their depth
+// RASTER_DEPTH_NONE gets the kernels without depth test
+RasterFillFunc RasterDepthBufferSelectFill(RasterDepthFormat format, RasterShadeKernel kernel);
+
+#endif	// RASTER_DEPTH_H
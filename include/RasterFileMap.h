@@ -0,0 +1,20 @@
+#ifndef RASTER_FILE_MAP_H
+#define RASTER_FILE_MAP_H
+
+#include "RasterCommon.h"
+
+// Read-only view of a whole file, mmap'ed where available and read into memory otherwise
+typedef struct RasterFileMap {
+	const char* data;
+	size_t size;
+	bool mapped;
+} RasterFileMap;
+
+// modificationTime is in nanoseconds since the epoch (as precise as the file system), returns false if the file doesn't
+// exist or if the platform has no way to stat it
+bool RasterFileStat(const char* path, uint64_t* size, int64_t* modificationTime);
+
+bool RasterFileMapOpen(RasterFileMap* map, const char* path);
+void RasterFileMapClose(RasterFileMap* map);
+
+#endif	// RASTER_FILE_MAP_H
@@ -0,0 +1,12 @@
+#ifndef RASTER_FILL_H
+#define RASTER_FILL_H
+
+#include "RasterTriangle.h"
+
+// Sets count 32 bits values, with a memset when all of value's bytes are equal, wide stores otherwise
+void RasterFill32(uint32_t* data, size_t count, uint32_t value);
+
+// Same over a rect of a buffer stride values wide, rect must be within the buffer
+void RasterFillRect32(uint32_t* data, uint32_t stride, RasterRect rect, uint32_t value);
+
+#endif	// RASTER_FILL_H
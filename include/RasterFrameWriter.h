@@ -0,0 +1,68 @@
+#ifndef RASTER_FRAME_WRITER_H
+#define RASTER_FRAME_WRITER_H
+
+#include "RasterCommon.h"
+
+#include <pthread.h>
+
+// 3 bytes per pixel, in RGB order or BGR if bgr is set
+void RasterPackPixels24(const Color* pixels, size_t count, bool bgr, uint8_t* out);
+
+// Size of a 24 bits BMP of width by height pixels, headers included
+size_t RasterBMPSize(uint32_t width, uint32_t height);
+
+// Encodes the headers then the bottom-up BGR rows (padded to 4 bytes) into RasterBMPSize(width, height) bytes of data
+void RasterEncodeBMP(const Color* pixels, uint32_t width, uint32_t height, uint8_t* data);
+
+// Encodes the whole frame into a buffer first, and writes it in a single call
+bool RasterWriteBMP(const char* path, const Color* pixels, uint32_t width, uint32_t height);
+
+typedef struct RasterFrameSlot {
+	char* path;  // NULL for writers with their own write function
+	Color* pixels;
+	size_t pixelsCapacity;
+	uint32_t width;
+	uint32_t height;
+} RasterFrameSlot;
+
+// Called on the writer thread, in queue order
+typedef bool (*RasterFrameWriteFunc)(void* userData, const RasterFrameSlot* slot);
+
+// Bounded ring of frames copied by RasterFrameWriterQueue, encoded and written by a background thread
+typedef struct RasterFrameWriter {
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t queuedCond;	// A frame was queued, or the writer is stopping
+	pthread_cond_t writtenCond;	// A frame was written (or failed to)
+
+	RasterFrameSlot* slots;
+	uint32_t slotsSize;
+	uint32_t nextSlot;	// Oldest queued frame, the next one written
+	uint32_t queued;
+	bool stopping;
+	uint32_t failedCount;  // Frames that couldn't be written since the last flush
+
+	RasterFrameWriteFunc func;  // NULL saves the frames as BMPs to their path
+	void* userData;
+
+	// Only used by the writer thread
+	uint8_t* encoded;
+	size_t encodedCapacity;
+} RasterFrameWriter;
+
+// queueDepth frames can wait to be written before RasterFrameWriterQueue blocks
+RasterFrameWriter* RasterFrameWriterCreate(uint32_t queueDepth);
+RasterFrameWriter* RasterFrameWriterCreateEx(uint32_t queueDepth, RasterFrameWriteFunc func, void* userData);
+// Writes every queued frame first
+void RasterFrameWriterFree(RasterFrameWriter* writer);
+
+uint32_t RasterFrameWriterQueueDepth(const RasterFrameWriter* writer);
+
+// Copies the pixels (and path, which may be NULL with a write function), and only waits if every slot is still queued
+// Frames must be queued from a single thread, write errors are reported by RasterFrameWriterFlush
+bool RasterFrameWriterQueue(RasterFrameWriter* writer, const char* path, const Color* pixels, uint32_t width, uint32_t height);
+
+// Waits until every queued frame is written, false if any of the frames written since the last flush failed
+bool RasterFrameWriterFlush(RasterFrameWriter* writer);
+
+#endif	// RASTER_FRAME_WRITER_H
@@ -0,0 +1,23 @@
+#ifndef RASTER_GOVERNOR_H
+#define RASTER_GOVERNOR_H
+
+#include "RasterTarget.h"
+
+// Dynamic resolution: scales the target's viewport down when frames take longer than the target frame time, and back
+// up once they take well under it, the gap between the two (and the frames averaged after each change) keeping it from
+// oscillating around the target
+typedef struct RasterGovernor {
+	double targetFrameNs;
+	float minScale;	 // Of the target's size, per axis
+	float scale;
+	double averageNs;  // Exponential moving average of the frame times since the last change
+	uint32_t framesSinceChange;
+} RasterGovernor;
+
+// Starts at the target's full size
+void RasterGovernorInit(RasterGovernor* governor, double targetFrameNs, float minScale);
+// Feeds the time the last frame took to draw, then sets screen's viewport at the governor's scale of the whole target,
+// returns whether the scale changed
+bool RasterGovernorUpdate(RasterGovernor* governor, RasterTarget* screen, double frameNs);
+
+#endif	// RASTER_GOVERNOR_H
@@ -0,0 +1,68 @@
+#ifndef RASTER_MESHLET_H
+#define RASTER_MESHLET_H
+
+#include "RasterArena.h"
+#include "RasterCull.h"
+
+// Small enough for a meshlet to cover a small part of the model, large enough for culling them to stay cheap
+#define RASTER_MESHLET_MAX_VERTICES 64
+#define RASTER_MESHLET_MAX_TRIANGLES 124
+
+// Cluster of neighbouring triangles, consecutive in the model's indices, which only use the meshlet's own vertices
+// (consecutive as well), so culled meshlets are never transformed nor set up
+typedef struct RasterMeshlet {
+	uint32_t firstTriangle;
+	uint32_t trianglesCount;
+	uint32_t firstVertex;
+	uint32_t verticesCount;
+
+	// Bounding sphere of the vertices
+	Vector3 center;
+	float radius;
+
+	// Every non-degenerate triangle's normal is within the cone around coneAxis, whose half angle's cosine and sine are
+	// coneCos and coneSin, which are 0 and 1 when it is 90 degrees or more (such meshlets are never facing away)
+	Vector3 coneAxis;
+	float coneCos;
+	float coneSin;
+} RasterMeshlet;
+
+// Meshlets of a triangle list, the vertices used by several meshlets being duplicated in each of them
+typedef struct RasterMeshletPartition {
+	RasterMeshlet* meshlets;
+	size_t meshletsSize;
+
+	uint32_t* vertices;	 // Source vertex of each vertex of the partition
+	size_t verticesSize;
+
+	uint32_t* indices;	// 3 per triangle, into vertices, the triangles being reordered meshlet by meshlet
+} RasterMeshletPartition;
+
+// Bytes RasterMeshletPartitionBuild takes from its arena at most, rounded like RasterArenaAlignedSize
+size_t RasterMeshletPartitionScratchSize(size_t verticesSize, size_t trianglesSize);
+// Neighbouring triangles are grouped by sorting them along a Morton curve over the model's bounds, positions being the
+// source vertices' and indices their 3 source vertices per triangle
+// Every array of the partition is allocated from arena, returns false if it is out of memory
+bool RasterMeshletPartitionBuild(RasterMeshletPartition* partition, const Vector3* positions, size_t verticesSize,
+								 const uint32_t* indices, size_t trianglesSize, RasterArena* arena);
+
+typedef enum RasterMeshletVisibility {
+	RASTER_MESHLET_VISIBLE = 0,
+	RASTER_MESHLET_OUTSIDE,		 // Entirely outside of the view
+	RASTER_MESHLET_FACING_AWAY,	 // Every triangle would be culled by the cull mode
+} RasterMeshletVisibility;
+
+// What meshlets are tested against, in the space mvp transforms from
+typedef struct RasterMeshletView {
+	RasterFrustum frustum;
+	// Homogeneous eye position (w = 0 for orthographic projections), whose dot product with a triangle's plane is
+	// positive for triangles counter-clockwise on the screen
+	Vector4 eye;
+	RasterCullMode cullMode;
+} RasterMeshletView;
+
+RasterMeshletView RasterMeshletViewFromMatrix(Matrix mvp, RasterCullMode cullMode);
+// Conservative, visible meshlets may still have every triangle culled
+RasterMeshletVisibility RasterMeshletCull(const RasterMeshletView* view, const RasterMeshlet* meshlet);
+
+#endif	// RASTER_MESHLET_H
@@ -1,30 +1,65 @@
 #ifndef RASTER_MODEL_H
 #define RASTER_MODEL_H
 
-#include "RasterCommon.h"
+#include "RasterArena.h"
+#include "RasterFileMap.h"
+#include "RasterMeshlet.h"
 
-typedef struct RasterModelFace {
-	uint16_t* vertexIndeces;
-	uint16_t* texCoordIndices;
-	uint16_t* normalIndices;
-	size_t indicesSize;
-} RasterModelFace;
+typedef enum RasterIndexType {
+	RASTER_INDEX_UINT16 = 0,
+	RASTER_INDEX_UINT32,
+} RasterIndexType;
 
 typedef struct RasterModel {
-	Vector3* vertices;
+	// One vertex per distinct position/texture coordinates/normal combination of the OBJ, one array per attribute
+	Vector3* positions;
+	Vector2* texCoords;
+	Vector3* normals;
+	Color* colors;	// White unless the OBJ's vertex lines have colors too ("v x y z r g b", channels in [0, 1])
 	size_t verticesSize;
 
-	Vector2* texCoords;
-	size_t texCoordsSize;
+	// Fan-triangulated faces, 3 indices per triangle, 16 bits wide when every vertex is addressable with them
+	void* indices;
+	RasterIndexType indexType;
+	size_t trianglesSize;
+	Color* faceColors;	// One opaque color per triangle, hashed from its index for OBJ models so they never change
 
-	Vector3* normals;
-	size_t normalsSize;
+	// Bounding sphere of the positions, in model space
+	Vector3 boundsCenter;
+	float boundsRadius;
+
+	// Cover every triangle in order, models without any are drawn triangle by triangle
+	RasterMeshlet* meshlets;
+	size_t meshletsSize;
 
-	RasterModelFace* faces;
-	size_t facesSize;
+	// Only mapped for models loaded from a binary file, every array then points into it
+	RasterFileMap binaryFile;
+
+	// Holds the model itself and every array not in binaryFile, in a single block
+	RasterArena arena;
 } RasterModel;
 
+static inline uint32_t RasterModelGetIndex(const RasterModel* model, size_t i) {
+	if (model->indexType == RASTER_INDEX_UINT16) return ((const uint16_t*)model->indices)[i];
+	return ((const uint32_t*)model->indices)[i];
+}
+
+static inline size_t RasterModelIndexSize(RasterIndexType indexType) {
+	return (indexType == RASTER_INDEX_UINT16) ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+// Allocates the model and its arrays in one block, the arrays are left uninitialized
+// 16 bits indices are used when every vertex is addressable with them
+RasterModel* RasterModelCreate(size_t verticesSize, size_t trianglesSize, size_t meshletsSize);
+// Must be called once the positions are set, or whenever they change
+void RasterModelUpdateBounds(RasterModel* model);
+
+// Loads "<path>.lrmb" instead of parsing the OBJ if it was written for the OBJ's current size and modification time,
+// otherwise parses the OBJ and (re)writes it
+// OBJ models are split in meshlets, with their vertices reordered (and duplicated between meshlets) accordingly
 RasterModel* LoadRasterModelFromFile(const char* path);
+RasterModel* LoadRasterModelFromObj(const char* path);
+// Frees the model and all of its arrays at once
 void RasterModelFree(RasterModel* model);
 
 #endif	// RASTER_MODEL_H
@@ -0,0 +1,40 @@
+#ifndef RASTER_MODEL_BINARY_H
+#define RASTER_MODEL_BINARY_H
+
+#include "RasterModel.h"
+
+#define RASTER_MODEL_BINARY_EXT ".lrmb"
+#define RASTER_MODEL_BINARY_VERSION 4
+
+// Identifies the file a binary model was converted from, so stale binaries can be detected
+typedef struct RasterModelSourceInfo {
+	uint64_t size;
+	int64_t modificationTime;  // Nanoseconds, as given by RasterFileStat
+} RasterModelSourceInfo;
+
+// Native endianness, every array is 8 bytes aligned and located by its offset from the start of the file
+typedef struct RasterModelBinaryHeader {
+	char magic[4];
+	uint32_t version;
+	RasterModelSourceInfo source;
+
+	uint64_t verticesSize;
+	uint64_t trianglesSize;
+	uint32_t indexType;	 // RasterIndexType
+	uint32_t padding;
+	uint64_t meshletsSize;
+
+	uint64_t positionsOffset;
+	uint64_t texCoordsOffset;
+	uint64_t normalsOffset;
+	uint64_t colorsOffset;
+	uint64_t indicesOffset;
+	uint64_t faceColorsOffset;
+	uint64_t meshletsOffset;
+} RasterModelBinaryHeader;
+
+// With a NULL expectedSource any valid binary model is accepted, returns NULL without logging if the file is missing
+RasterModel* LoadRasterModelFromBinary(const char* path, const RasterModelSourceInfo* expectedSource);
+bool RasterModelSaveBinary(const RasterModel* model, const char* path, RasterModelSourceInfo source);
+
+#endif	// RASTER_MODEL_BINARY_H
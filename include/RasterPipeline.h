@@ -0,0 +1,53 @@
+#ifndef RASTER_PIPELINE_H
+#define RASTER_PIPELINE_H
+
+#include "RasterTarget.h"
+
+#include <pthread.h>
+
+// Draws a whole frame into screen, clear included
+typedef void (*RasterPipelineRenderFunc)(void* userData, RasterTarget* screen);
+
+// Double buffering: the last frame rendered (the front buffer) is uploaded and presented, or output, while a render
+// thread draws the next one into the target, the two being swapped by RasterPipelineWait
+// Between RasterPipelineRender and the following RasterPipelineWait the target (and whatever the render function reads)
+// belongs to the render thread, in between the caller can change them
+typedef struct RasterPipeline {
+	RasterTarget* screen;
+	RasterPipelineRenderFunc render;
+	void* userData;
+
+	bool threaded;	// Otherwise frames are rendered by RasterPipelineWait, on the calling thread
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t startedCond;	  // A frame was started, or the pipeline is stopping
+	pthread_cond_t renderedCond;  // The started frame was rendered
+	bool stopping;
+
+	// Each frame is started, rendered then swapped to the front, in turn
+	uint64_t startedCount;
+	uint64_t renderedCount;
+	uint64_t swappedCount;
+	RasterFrameStats renderedStats;	 // Of the last frame rendered
+
+	RasterTargetBuffer* front;
+	RasterFrameStats frontStats;  // Its render stages until RasterPipelineEndPresent adds its present stages
+	uint64_t lastSwapNs;
+
+	RasterStats presentStats;  // Stages of the front frame, timed by the caller from RasterPipelineWait on
+	RasterFrameStats last;	   // The last frame presented
+} RasterPipeline;
+
+// Falls back to rendering on the calling thread if threaded is false or the render thread can't be started
+RasterPipeline* RasterPipelineCreate(RasterTarget* screen, RasterPipelineRenderFunc render, void* userData, bool threaded);
+// Waits for the frame being rendered, if any
+void RasterPipelineFree(RasterPipeline* pipeline);
+
+// Starts rendering the next frame, unless it already is
+void RasterPipelineRender(RasterPipeline* pipeline);
+// Waits for the frame started by RasterPipelineRender (starting one if there is none) and swaps it to the front
+const RasterTargetBuffer* RasterPipelineWait(RasterPipeline* pipeline);
+// Stats of the front frame, rendering and presenting stages together, once it is presented
+const RasterFrameStats* RasterPipelineEndPresent(RasterPipeline* pipeline);
+
+#endif	// RASTER_PIPELINE_H
@@ -0,0 +1,45 @@
+#ifndef RASTER_SAMPLES_H
+#define RASTER_SAMPLES_H
+
+#include "RasterDepth.h"
+
+#define RASTER_MAX_SAMPLES 8
+
+// Coverage of 4 or 8 samples per pixel (on a rotated grid), each pixel being shaded once: the pixels hold the color of
+// the samples set in their mask, and the buffer the secondary color of the others, laid out like the pixels
+// Fully covered pixels only store their color, their mask being full, and a third color in a pixel replaces whichever
+// of the two others covers fewer of the samples it left
+typedef struct RasterSampleBuffer {
+	uint32_t samplesCount;
+	uint8_t fullMask;
+	uint8_t* masks;
+	Color* secondary;  // Only meaningful where the mask isn't full
+	uint32_t width;
+	uint32_t height;
+
+	uint32_t maxWidth;	// Size the buffer was created with
+	uint32_t maxHeight;
+
+	bool unresolved;  // Some masks may not be full, set by the target whenever it draws
+} RasterSampleBuffer;
+
+// NULL unless samplesCount is 4 or 8, every pixel is fully covered by its color
+RasterSampleBuffer* RasterSampleBufferCreate(uint32_t width, uint32_t height, uint32_t samplesCount);
+void RasterSampleBufferFree(RasterSampleBuffer* samples);
+
+// Lays the buffer out for a size up to the one it was created with, reusing its storage, and clears it
+bool RasterSampleBufferSetSize(RasterSampleBuffer* samples, uint32_t width, uint32_t height);
+
+// Every pixel of rect is fully covered by its color afterwards
+void RasterSampleBufferClear(RasterSampleBuffer* samples);
+void RasterSampleBufferClearRect(RasterSampleBuffer* samples, RasterRect rect);
+
+// Blends the two colors of each pixel of rect in proportion to their samples, pixels are as wide as the buffer and rect
+// is cleared afterwards, so drawing can go on over the resolved pixels
+void RasterSampleBufferResolve(RasterSampleBuffer* samples, Color* pixels, RasterRect rect);
+
+// Kernels covering the samples of triangles set up with RasterTriangleSetupSampled (or RasterTriangleSetupDepthSampled
+// when depth tested against a buffer of format)
+RasterFillFunc RasterSampleBufferSelectFill(RasterDepthFormat format, RasterShadeKernel kernel);
+
+#endif	// RASTER_SAMPLES_H
@@ -0,0 +1,79 @@
+#ifndef RASTER_SCENE_H
+#define RASTER_SCENE_H
+
+#include "RasterTarget.h"
+
+#include <LuLib/LuArray.h>
+
+// Most objects a leaf of the hierarchy holds
+#define RASTER_SCENE_LEAF_SIZE 4
+
+#define RASTER_SCENE_INVALID_ID UINT32_MAX
+
+typedef struct RasterSceneObject {
+	const RasterModel* model;  // NULL once removed, the slot is then reused by the next object added
+	Matrix transform;
+
+	// World space box around the model's transformed bounding sphere
+	Vector3 boundsMin;
+	Vector3 boundsMax;
+} RasterSceneObject;
+
+// Bounding volume hierarchy node, the nodes are stored depth-first so an inner node's first child directly follows it
+typedef struct RasterSceneNode {
+	Vector3 boundsMin;
+	uint32_t objectsCount;	// 0 for inner nodes
+	Vector3 boundsMax;
+	uint32_t index;	 // Second child of inner nodes, first of the leaf's objects in leafObjects for leaves
+} RasterSceneNode;
+
+DeclareArrayType(RasterSceneObject, RasterSceneObjectArray);
+DeclareArrayMethods(RasterSceneObject, RasterSceneObjectArray);
+
+DeclareArrayType(uint32_t, RasterSceneIdArray);
+DeclareArrayMethods(uint32_t, RasterSceneIdArray);
+
+DeclareArrayType(Matrix, RasterSceneTransformArray);
+DeclareArrayMethods(Matrix, RasterSceneTransformArray);
+
+// Objects are models (not owned by the scene) placed by a transform, and identified by the index of their slot
+// The hierarchy is rebuilt after objects are added or removed, and only refit after they move
+typedef struct RasterScene {
+	RasterSceneObjectArray* objects;
+	RasterSceneIdArray* freeIds;  // Slots of removed objects
+	uint32_t objectsCount;		  // Not counting the removed ones
+
+	RasterSceneNode* nodes;
+	uint32_t nodesSize;
+	uint32_t* leafObjects;	// Ids of the objects, grouped by leaf
+	bool needsRebuild;
+	bool needsRefit;
+
+	RasterSceneIdArray* visibleIds;				// Of the last cull, in ascending order
+	RasterSceneTransformArray* drawTransforms;	// Scratch for the instanced draws, kept between draws
+
+	// Of the last cull
+	uint32_t nodesVisited;
+	uint32_t objectsTested;
+} RasterScene;
+
+RasterScene* RasterSceneCreate(void);
+// The models are left as is
+void RasterSceneFree(RasterScene* scene);
+
+// Returns RASTER_SCENE_INVALID_ID if out of memory, the id stays the object's until it is removed
+uint32_t RasterSceneAdd(RasterScene* scene, const RasterModel* model, Matrix transform);
+// Ids out of range or of removed objects are ignored
+void RasterSceneRemove(RasterScene* scene, uint32_t id);
+void RasterSceneSetTransform(RasterScene* scene, uint32_t id, Matrix transform);
+
+// Rebuilds or refits the hierarchy if objects changed since the last update, culling and drawing call it first
+bool RasterSceneUpdate(RasterScene* scene);
+// Fills scene->visibleIds with the objects whose bounds are at least partly inside of viewProjection's view
+bool RasterSceneCull(RasterScene* scene, Matrix viewProjection);
+// Culls the scene with the target's view projection, then draws the visible objects in ascending id order, as many
+// RasterTargetDrawModelEx calls would
+// Consecutive visible objects sharing a model made of a single meshlet (or none) are drawn instanced
+bool RasterSceneDraw(RasterScene* scene, RasterTarget* screen);
+
+#endif	// RASTER_SCENE_H
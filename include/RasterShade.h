@@ -0,0 +1,99 @@
+#ifndef RASTER_SHADE_H
+#define RASTER_SHADE_H
+
+#include "RasterTexture.h"
+
+// Colors models are drawn with, a texture (when set) replaces them for every shading but RASTER_SHADING_DEPTH_ONLY
+typedef enum RasterShading {
+	RASTER_SHADING_FLAT = 0,	// The model's face colors
+	RASTER_SHADING_VERTEX,		// The model's vertex colors, interpolated across each triangle
+	RASTER_SHADING_LAMBERT,		// Face colors lit at each vertex from its normal, interpolated across each triangle
+	RASTER_SHADING_DEPTH_ONLY,	// Only the depths are written, so nothing is drawn without a depth buffer
+} RasterShading;
+
+// What the fill kernels write per pixel, picked once per draw from the shading and the texture
+typedef enum RasterShadeKernel {
+	RASTER_KERNEL_FLAT = 0,
+	RASTER_KERNEL_GOURAUD,
+	RASTER_KERNEL_NEAREST,
+	RASTER_KERNEL_BILINEAR,
+	RASTER_KERNEL_DEPTH_ONLY,
+	RASTER_KERNEL_COUNT,
+} RasterShadeKernel;
+
+static inline bool RasterShadeKernelIsTextured(RasterShadeKernel kernel) {
+	return kernel == RASTER_KERNEL_NEAREST || kernel == RASTER_KERNEL_BILINEAR;
+}
+
+// Color channels (in [0, 255]) interpolated linearly in screen space, as in Gouraud shading
+typedef struct RasterColorPlanes {
+	RasterPlane r;
+	RasterPlane g;
+	RasterPlane b;
+	int32_t originX;  // Pixel the planes are relative to, kept when the triangle is clipped to tiles
+	int32_t originY;
+} RasterColorPlanes;
+
+// Everything a kernel reads of a triangle besides its coverage, only the members of its kernel are set
+typedef struct RasterShader {
+	Color col;						  // Flat
+	const RasterColorPlanes* colors;  // Gouraud
+	const RasterUVPlanes* uv;		  // Textured, sampling level
+	const RasterTextureLevel* level;
+} RasterShader;
+
+// Defined in RasterDepth.h and RasterSamples.h, which build on this header
+struct RasterDepthBuffer;
+struct RasterSampleBuffer;
+
+// What the fills write to, the buffers are only read by the kernels selected for them, and are then as wide as pixels
+typedef struct RasterFillTarget {
+	Color* pixels;
+	uint32_t stride;
+	struct RasterDepthBuffer* depth;
+	struct RasterSampleBuffer* samples;
+} RasterFillTarget;
+
+// Fills the pixels of tri, depth testing them for the kernels selected with a depth format, covering their samples for
+// the multisampled ones
+typedef RasterFillCounts (*RasterFillFunc)(const RasterFillTarget* target, const RasterTriangle* tri, const RasterShader* shader);
+
+// Kernels without depth test or multisampling, only the target's pixels are read
+RasterFillFunc RasterShadeSelectFill(RasterShadeKernel kernel);
+
+// tri must have just been set up from positions, colors has each vertex's channels in [0, 255]
+void RasterColorPlanesSetup(RasterColorPlanes* planes, const RasterTriangle* tri, const Vector3 positions[3], const Vector3 colors[3]);
+
+// Evaluated from the origin like RasterTextureShade, and clamped as pixels at the triangle's edges can be slightly outside
+// of it
+static inline __attribute__((always_inline)) Color RasterColorPlanesShade(const RasterColorPlanes* planes, int32_t x, int32_t y) {
+	const float dx = x - planes->originX;
+	const float dy = y - planes->originY;
+	const float r = planes->r.origin + planes->r.stepX * dx + planes->r.stepY * dy;
+	const float g = planes->g.origin + planes->g.stepX * dx + planes->g.stepY * dy;
+	const float b = planes->b.origin + planes->b.stepX * dx + planes->b.stepY * dy;
+
+	return (Color){
+		.r = fminf(fmaxf(r, 0.0f), 255.0f) + 0.5f,
+		.g = fminf(fmaxf(g, 0.0f), 255.0f) + 0.5f,
+		.b = fminf(fmaxf(b, 0.0f), 255.0f) + 0.5f,
+		.a = 0xFF,
+	};
+}
+
+// kernel is a constant in every caller, so each instantiation only keeps its own case
+static inline __attribute__((always_inline)) Color RasterShadePixel(const RasterShader* shader, RasterShadeKernel kernel, int32_t x,
+																	int32_t y) {
+	switch (kernel) {
+		case RASTER_KERNEL_GOURAUD:
+			return RasterColorPlanesShade(shader->colors, x, y);
+		case RASTER_KERNEL_NEAREST:
+			return RasterTextureShade(shader->uv, shader->level, false, x, y);
+		case RASTER_KERNEL_BILINEAR:
+			return RasterTextureShade(shader->uv, shader->level, true, x, y);
+		default:
+			return shader->col;
+	}
+}
+
+#endif	// RASTER_SHADE_H
@@ -0,0 +1,127 @@
+#ifndef RASTER_STATS_H
+#define RASTER_STATS_H
+
+#include "RasterCommon.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <x86intrin.h>
+#endif
+
+// Builds without RASTER_STATS (make STATS=1 defines it) compile the stage timers and pixel counters out, frames are then
+// still timed as a whole and the triangles still counted, but every stage and pixel count stays at 0
+#ifdef RASTER_STATS
+#define RASTER_STATS_ENABLED 1
+#else
+#define RASTER_STATS_ENABLED 0
+#endif
+
+// Time spent outside of every other stage goes to RASTER_STAGE_OTHER, so the stages add up to the frame's time
+typedef enum RasterStage {
+	RASTER_STAGE_OTHER = 0,
+	RASTER_STAGE_CLEAR,
+	RASTER_STAGE_TRANSFORM,
+	RASTER_STAGE_SETUP,	 // Culling, clipping, triangle setup and binning
+	RASTER_STAGE_RASTER,
+	RASTER_STAGE_UPLOAD,
+	RASTER_STAGE_PRESENT,
+	RASTER_STAGE_OUTPUT,
+	RASTER_STAGE_COUNT,
+} RasterStage;
+
+typedef struct RasterFrameStats {
+	uint64_t frameIndex;
+	double frameNs;
+	double stagesNs[RASTER_STAGE_COUNT];
+
+	uint64_t trianglesSubmitted;
+	uint64_t trianglesCulled;  // Outside of the view, back-faces and degenerate triangles
+	uint64_t trianglesDrawn;   // Given to setup, each clipped triangle can add several of them
+
+	uint64_t pixelsTested;	 // Covered pixels that went through the per pixel depth test, every covered pixel without depth
+	uint64_t pixelsWritten;
+	double overdraw;  // Pixels written per pixel of the target
+
+	uint32_t width;	 // Viewport the frame was drawn at, 0 outside of a target
+	uint32_t height;
+
+	// Frame pacing, only measured for frames going through a RasterPipeline
+	double waitNs;	   // Presenting thread waiting for the frame to be rendered
+	double intervalNs;  // Since the previous frame was ready to be presented
+} RasterFrameStats;
+
+typedef struct RasterStats {
+	RasterFrameStats frame;	 // Being collected since RasterStatsBeginFrame
+	RasterFrameStats last;	 // The last frame ended
+
+	uint64_t frameStartNs;
+	uint64_t frameStartTicks;
+	uint64_t stagesTicks[RASTER_STAGE_COUNT];
+	RasterStage stage;
+	uint64_t stageStartTicks;
+
+	// Added by the raster worker threads, once per tile
+	atomic_uint_fast64_t workerPixelsTested;
+	atomic_uint_fast64_t workerPixelsWritten;
+} RasterStats;
+
+const char* RasterStageName(RasterStage stage);
+
+uint64_t RasterStatsMonotonicNs(void);
+
+// The timestamp counter where there is one (converted to nanoseconds against the monotonic clock once per frame),
+// the monotonic clock's nanoseconds otherwise
+static inline uint64_t RasterStatsTicks(void) {
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+	return __rdtsc();
+#else
+	return RasterStatsMonotonicNs();
+#endif
+}
+
+// Returns the stage that was running, so it can be switched back to
+static inline RasterStage RasterStatsSwitchStage(RasterStats* stats, RasterStage stage) {
+	const uint64_t now = RasterStatsTicks();
+	const RasterStage previous = stats->stage;
+
+	stats->stagesTicks[previous] += now - stats->stageStartTicks;
+	stats->stage = stage;
+	stats->stageStartTicks = now;
+	return previous;
+}
+
+// Scoped stage timer, at most one per block, the time spent in between goes to stage instead of the enclosing stage
+// RasterStatsSwitch moves on to another stage within the same scope
+#ifdef RASTER_STATS
+#define RasterStatsEnter(stats, stage) const RasterStage previousStage = RasterStatsSwitchStage(stats, stage)
+#define RasterStatsSwitch(stats, stage) RasterStatsSwitchStage(stats, stage)
+#define RasterStatsLeave(stats) RasterStatsSwitchStage(stats, previousStage)
+#define RasterStatsAdd(stats, counter, value) ((stats)->frame.counter += (value))
+#define RasterStatsAddAtomic(stats, counter, value) atomic_fetch_add_explicit(&(stats)->counter, (value), memory_order_relaxed)
+#else
+#define RasterStatsEnter(stats, stage) ((void)0)
+#define RasterStatsSwitch(stats, stage) ((void)0)
+#define RasterStatsLeave(stats) ((void)0)
+#define RasterStatsAdd(stats, counter, value) ((void)(value))
+#define RasterStatsAddAtomic(stats, counter, value) ((void)(value))
+#endif
+
+void RasterStatsInit(RasterStats* stats);
+
+void RasterStatsBeginFrame(RasterStats* stats);
+// Stores the frame's stats into stats->last, pixelsCount is the target's size for the overdraw
+const RasterFrameStats* RasterStatsEndFrame(RasterStats* stats, uint64_t pixelsCount);
+
+bool RasterStatsWriteCSVHeader(FILE* file);
+bool RasterStatsWriteCSV(FILE* file, const RasterFrameStats* frame);
+// One JSON object per line
+bool RasterStatsWriteJSON(FILE* file, const RasterFrameStats* frame);
+
+#ifndef RASTER_HEADLESS
+// Draws the stats in the top-left corner of the window, fontSize pixels high
+void RasterStatsDrawOverlay(const RasterFrameStats* frame, int32_t fontSize);
+#endif
+
+#endif	// RASTER_STATS_H
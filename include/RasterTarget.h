@@ -1,28 +1,207 @@
 #ifndef RASTER_TARGET_H
 #define RASTER_TARGET_H
 
+#include "RasterBinner.h"
+#include "RasterCull.h"
 #include "RasterModel.h"
+#include "RasterSamples.h"
+#include "RasterStats.h"
+#include "RasterThreadPool.h"
+#include "RasterTransform.h"
+#include "RasterVideoSink.h"
+
+// Flags of the target's tiles, RASTER_TILE_SIZE squared pixels each (aligned like the binner's)
+#define RASTER_TILE_DRAWN (1 << 0)	  // Drawn to since the last clear
+#define RASTER_TILE_CLEARED (1 << 1)  // Rewritten by the last clear
+
+// Pixels and clear state of a frame, swapped with the target's own so a finished frame can be presented or output
+// while the target draws the next one
+typedef struct RasterTargetBuffer {
+	Color* pixels;
+	uint8_t* tileFlags;
+	Color background;
+	bool backgroundValid;
+	uint32_t width;	 // Of the frame, the target's viewport when it was swapped out
+	uint32_t height;
+} RasterTargetBuffer;
 
 typedef struct RasterTarget {
 	Color* pixels;
-	uint32_t width;
+	uint32_t width;	 // The viewport, drawn with its rows packed at the start of the pixels
 	uint32_t height;
+	uint32_t maxWidth;	// Size everything is allocated for, the viewport can't be larger
+	uint32_t maxHeight;
+
+	Texture tex;  // Zeroed for headless targets
+	uint32_t texWidth;	// Of the frame last uploaded, the part of tex that is rendered
+	uint32_t texHeight;
+
+	// What tex holds, uploads skip the tiles that only hold the same background in it and in the uploaded frame
+	uint8_t* texTileFlags;	// RASTER_TILE_DRAWN of the frame last uploaded
+	Color texBackground;
+	bool texBackgroundValid;  // Until the first upload, or after uploading a frame whose background wasn't valid
+
+	// Dirty rects narrower than the target are packed there before being uploaded
+	Color* uploadPixels;
+	size_t uploadPixelsCapacity;
+
+	// Clears only rewrite the tiles drawn to since the previous one, as long as the background stays the same
+	uint8_t* tileFlags;
+	uint32_t tilesX;
+	uint32_t tilesY;
+	Color background;
+	bool backgroundValid;  // Every tile without RASTER_TILE_DRAWN only has background pixels
+
+	RasterDepthBuffer* depth;     // NULL unless a depth format was set
+	RasterSampleBuffer* samples;  // NULL unless multisampled, the pixels are resolved from it before being output
+
+	Matrix viewProjection;
+	RasterCullMode cullMode;
+	RasterCullStats cullStats;  // Accumulated over every model drawn since the last reset
+
+	const RasterTexture* texture;  // Models are drawn with the shading's colors when NULL
+	RasterTextureFilter textureFilter;
+	RasterShading shading;
+	Vector3 lightDirection;	 // World space, normalized
+
+	// Of the model being drawn, the kernel being selected once per draw
+	const RasterModel* model;
+	RasterShadeKernel kernel;
+	RasterFillFunc fill;
+	Vector3 modelLight;	 // Towards the light, in the model space of the instance being drawn
+
+	// Scratch buffers of the transform stage, every vertex of the model being drawn
+	RasterScreenVertex* screenVertices;
+	uint16_t* screenOutcodes;
+	size_t screenVerticesCapacity;
+
+	// Only set when drawing with more than one thread
+	RasterThreadPool* threadPool;
+	RasterBinner* binner;
+
+	RasterFrameWriter* frameWriter;  // Only set when saving asynchronously
+	RasterVideoSink* videoSink;      // Only set while streaming
 
-	Texture tex;
+	RasterStats stats;
+	RasterCullStats frameStartCullStats;  // The triangles of the frame are counted from there
 } RasterTarget;
 
+// Headless builds (RASTER_HEADLESS) never touch raylib's window or GL, so their targets are always headless
 RasterTarget* RasterTargetCreate(uint32_t width, uint32_t height);
+RasterTarget* RasterTargetCreateHeadless(uint32_t width, uint32_t height);
 void RasterTargetFree(RasterTarget* screen);
 
-bool RasterTargetSaveToFile(const RasterTarget* screen, const char* path);
+// Draws at a lower resolution (the whole target by default) without reallocating anything, the view projection stays the
+// whole target's and RasterTargetRenderTextureEx stretches the viewport over it, so it should keep the target's aspect
+// ratio, every tile counts as drawn until the next clear
+// false (keeping the current viewport) if it doesn't fit in the target
+bool RasterTargetSetViewport(RasterTarget* screen, uint32_t width, uint32_t height);
 
+// 0 uses one thread per CPU core, 1 draws everything on the calling thread (the default)
+bool RasterTargetSetThreadCount(RasterTarget* screen, uint32_t threadCount);
+uint32_t RasterTargetGetThreadCount(const RasterTarget* screen);
+
+// RASTER_DEPTH_NONE (the default) draws models in submission order, otherwise their triangles are depth tested
+bool RasterTargetSetDepthFormat(RasterTarget* screen, RasterDepthFormat format);
+RasterDepthFormat RasterTargetGetDepthFormat(const RasterTarget* screen);
+
+// 1 (the default) covers pixels by their center, 4 and 8 anti-alias the triangles' edges by their samples' coverage,
+// each pixel still being shaded once per triangle
+// Depth is tested once per pixel too, at its center, against a single depth per pixel
+bool RasterTargetSetSampleCount(RasterTarget* screen, uint32_t samplesCount);
+uint32_t RasterTargetGetSampleCount(const RasterTarget* screen);
+// Blends the edges' colors into the pixels, uploads, saves, streams and swaps do it first, drawing can go on afterwards
+void RasterTargetResolve(RasterTarget* screen);
+
+// Defaults to RasterDefaultViewProjection, with the screen 5 world units high
+void RasterTargetSetViewProjection(RasterTarget* screen, Matrix viewProjection);
+void RasterTargetSetCamera(RasterTarget* screen, Camera3D camera);
+
+// Models are sampled from texture with their texture coordinates, NULL (the default) draws them with the shading's colors
+// The texture isn't owned by the target, it must outlive every model drawn with it
+void RasterTargetSetTexture(RasterTarget* screen, const RasterTexture* texture, RasterTextureFilter filter);
+const RasterTexture* RasterTargetGetTexture(const RasterTarget* screen);
+
+// Defaults to RASTER_SHADING_FLAT, only applies to models
+void RasterTargetSetShading(RasterTarget* screen, RasterShading shading);
+RasterShading RasterTargetGetShading(const RasterTarget* screen);
+// World space direction the light of RASTER_SHADING_LAMBERT shines in, defaults to shining into the default view from its
+// top left
+void RasterTargetSetLightDirection(RasterTarget* screen, Vector3 direction);
+
+// Defaults to RASTER_CULL_BACK, only applies to models
+void RasterTargetSetCullMode(RasterTarget* screen, RasterCullMode mode);
+RasterCullStats RasterTargetGetCullStats(const RasterTarget* screen);
+void RasterTargetResetCullStats(RasterTarget* screen);
+
+// 0 (the default) saves synchronously, otherwise up to queueDepth frames wait for a background thread to write them
+// Returns false if the previous writer had failed saves, or the new one couldn't be started
+bool RasterTargetSetSaveQueueDepth(RasterTarget* screen, uint32_t queueDepth);
+uint32_t RasterTargetGetSaveQueueDepth(const RasterTarget* screen);
+
+// Saved as a BMP, asynchronous saves copy the pixels and only wait if the queue is full
+bool RasterTargetSaveToFile(RasterTarget* screen, const char* path);
+// Waits for every queued save, false if any of them failed since the last flush
+bool RasterTargetFlushSaves(RasterTarget* screen);
+
+// Allocated for the whole target, every tile counts as drawn until the buffer is swapped in and cleared
+RasterTargetBuffer* RasterTargetBufferCreate(const RasterTarget* screen);
+void RasterTargetBufferFree(RasterTargetBuffer* buffer);
+// The target draws into the buffer's pixels from now on, and the buffer gets the frame drawn so far
+void RasterTargetSwapBuffer(RasterTarget* screen, RasterTargetBuffer* buffer);
+
+// Same as RasterTargetSaveToFile and RasterTargetStreamFrame with a swapped out frame, they don't touch anything the
+// target draws with, so they can run while it draws on another thread
+bool RasterTargetSaveBufferToFile(const RasterTarget* screen, const RasterTargetBuffer* buffer, const char* path);
+bool RasterTargetStreamBuffer(RasterTarget* screen, const RasterTargetBuffer* buffer);
+
+// Same as RasterVideoSinkOpen with the viewport's size, closing the current stream first (if any)
+bool RasterTargetOpenVideoStream(RasterTarget* screen, const char* path, RasterVideoFormat format, uint32_t framesPerSecond,
+								 uint32_t queueDepth);
+// Sends the current pixels to the stream as its next frame, false if the viewport changed since the stream was opened
+bool RasterTargetStreamFrame(RasterTarget* screen);
+// false if any frame couldn't be written
+bool RasterTargetCloseVideoStream(RasterTarget* screen);
+
+// Frames are whatever happens to the target between those, the stages outside of the target (presenting and output)
+// are timed by their callers through screen->stats
+void RasterTargetBeginFrameStats(RasterTarget* screen);
+const RasterFrameStats* RasterTargetEndFrameStats(RasterTarget* screen);
+
+bool RasterTargetHasTexture(const RasterTarget* screen);
+
+#ifndef RASTER_HEADLESS
+// No-ops on headless targets
+// Only the tiles drawn to in the frame or in the texture are uploaded, unless they add up to most of the target
 void RasterTargetUpdateTexture(RasterTarget* screen);
+// The frame last uploaded is stretched over the whole target (scaled by scale), whatever viewport it was drawn at
 void RasterTargetRenderTexture(const RasterTarget* screen);
 void RasterTargetRenderTextureEx(const RasterTarget* screen, uint32_t scale);
+// Not timed, unlike RasterTargetUpdateTexture, so it can run while the target draws on another thread
+void RasterTargetUpdateTextureFromBuffer(RasterTarget* screen, const RasterTargetBuffer* buffer);
+#endif
 
+// Also clears the depth buffer, if any, only the tiles drawn to since the last clear are rewritten unless col changed
 void RasterTargetClearBackground(RasterTarget* screen, Color col);
+
+uint32_t RasterTargetGetTileCount(const RasterTarget* screen);
+// Clamped to the target
+RasterRect RasterTargetTileRect(const RasterTarget* screen, uint32_t tileIndex);
+// Whether the tile's pixels may differ from what they were right before the last clear
+bool RasterTargetIsTileDirty(const RasterTarget* screen, uint32_t tileIndex);
+// Bounds of every dirty tile, false if there are none
+bool RasterTargetGetDirtyRect(const RasterTarget* screen, RasterRect* rect);
+// For pixels written without going through the target, so the next clear rewrites them
+void RasterTargetMarkDirty(RasterTarget* screen, RasterRect rect);
 void RasterTargetDrawPixel(RasterTarget* screen, uint32_t x, uint32_t y, Color col);
 void RasterTargetDrawTriangle(RasterTarget* screen, Vector2 a, Vector2 b, Vector2 c, Color col);
+// Triangles go through culling and clipping first, RasterTargetDrawTriangle draws its triangle as is
 void RasterTargetDrawModel(RasterTarget* screen, const RasterModel* model);
+void RasterTargetDrawModelEx(RasterTarget* screen, const RasterModel* model, Matrix transform);
+// Draws a copy of the model per transform, as if by as many RasterTargetDrawModelEx calls, but with the copies outside of
+// the view culled by their bounding sphere and every triangle of the draw binned together
+// colors (unless NULL) has one color per instance, replacing the model's face colors for all of its triangles
+void RasterTargetDrawModelInstanced(RasterTarget* screen, const RasterModel* model, const Matrix* transforms, const Color* colors,
+									uint32_t instancesCount);
 
 #endif	// RASTER_TARGET_H
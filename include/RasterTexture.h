@@ -0,0 +1,146 @@
+#ifndef RASTER_TEXTURE_H
+#define RASTER_TEXTURE_H
+
+#include "RasterTriangle.h"
+
+// Texels are stored in RASTER_TEXTURE_BLOCK_SIZE squared blocks (256 bytes, 4 cache lines), Morton ordered inside of
+// them, so the texels a triangle samples stay close in memory whichever way the texture is rotated on the screen
+#define RASTER_TEXTURE_BLOCK_SIZE 8
+#define RASTER_TEXTURE_BLOCK_TEXELS (RASTER_TEXTURE_BLOCK_SIZE * RASTER_TEXTURE_BLOCK_SIZE)
+
+// Enough for 32768 texels wide textures
+#define RASTER_TEXTURE_MAX_LEVELS 16
+
+// Texel coordinates are clamped to this before wrapping them, so they always fit in an int32_t
+#define RASTER_TEXTURE_COORD_LIMIT 1073741824.0f
+
+typedef enum RasterTextureFilter {
+	RASTER_TEXTURE_NEAREST = 0,
+	RASTER_TEXTURE_BILINEAR,
+} RasterTextureFilter;
+
+typedef struct RasterTextureLevel {
+	Color* texels;	// Whole blocks, the texels past width and height are never sampled
+	uint32_t width;
+	uint32_t height;
+	uint32_t blocksX;
+} RasterTextureLevel;
+
+// Texture coordinates wrap around, (0, 0) is the bottom-left corner as in OBJ files
+typedef struct RasterTexture {
+	Color* texels;	// Every level, in a single allocation
+	RasterTextureLevel levels[RASTER_TEXTURE_MAX_LEVELS];
+	uint32_t levelsCount;
+} RasterTexture;
+
+// Perspective correct texture coordinates of a triangle: u / w, v / w (in texels of the triangle's level) and 1 / w are
+// affine on the screen, so they are interpolated like depth and divided per pixel
+typedef struct RasterUVPlanes {
+	RasterPlane uOverW;
+	RasterPlane vOverW;
+	RasterPlane oneOverW;
+	int32_t originX;  // Pixel the planes are relative to, kept when the triangle is clipped to tiles
+	int32_t originY;
+	uint32_t level;	 // Picked once per triangle, from its texels per pixel
+} RasterUVPlanes;
+
+// pixels are width by height, row-major and top-down, a mip chain down to 1x1 is built when mipmaps is set
+RasterTexture* RasterTextureCreate(const Color* pixels, uint32_t width, uint32_t height, bool mipmaps);
+// size squared, with cells squared alternating cells
+RasterTexture* RasterTextureCreateChecker(uint32_t size, uint32_t cells, Color a, Color b, bool mipmaps);
+// 24 or 32 bits uncompressed BMPs and binary PPMs, and anything raylib can load in windowed builds
+RasterTexture* LoadRasterTextureFromFile(const char* path, bool mipmaps);
+void RasterTextureFree(RasterTexture* texture);
+
+// tri must have just been set up from positions, w is each vertex's clip space w
+void RasterUVPlanesSetup(RasterUVPlanes* uv, const RasterTriangle* tri, const RasterTexture* texture, const Vector3 positions[3],
+						 const float w[3], const Vector2 texCoords[3]);
+
+// Spreads the 3 bits of a block coordinate to every other bit
+static inline uint32_t RasterTextureMorton3(uint32_t value) {
+	static const uint8_t spread[RASTER_TEXTURE_BLOCK_SIZE] = {0, 1, 4, 5, 16, 17, 20, 21};
+	return spread[value];
+}
+
+static inline size_t RasterTexelIndex(const RasterTextureLevel* level, uint32_t x, uint32_t y) {
+	const size_t blockIndex = (size_t)(y / RASTER_TEXTURE_BLOCK_SIZE) * level->blocksX + x / RASTER_TEXTURE_BLOCK_SIZE;
+	const uint32_t inBlock = RasterTextureMorton3(x % RASTER_TEXTURE_BLOCK_SIZE) | (RasterTextureMorton3(y % RASTER_TEXTURE_BLOCK_SIZE) << 1);
+	return blockIndex * RASTER_TEXTURE_BLOCK_TEXELS + inBlock;
+}
+
+// Integer part of coord wrapped into [0, size), and its fraction
+static inline uint32_t RasterTextureWrap(float coord, uint32_t size, float* fraction) {
+	const float floored = floorf(coord);
+	*fraction = coord - floored;
+
+	// Also maps NaNs to a texel
+	const int32_t index = (int32_t)fmaxf(fminf(floored, RASTER_TEXTURE_COORD_LIMIT), -RASTER_TEXTURE_COORD_LIMIT);
+	const int32_t wrapped = index % (int32_t)size;
+	return (uint32_t)((wrapped < 0) ? wrapped + (int32_t)size : wrapped);
+}
+
+static inline uint32_t RasterColorBits(Color col) {
+	uint32_t bits;
+	memcpy(&bits, &col, sizeof(bits));
+	return bits;
+}
+
+static inline Color RasterColorFromBits(uint32_t bits) {
+	Color col;
+	memcpy(&col, &bits, sizeof(col));
+	return col;
+}
+
+// Lerps the 4 channels at once, 2 per 32 bits lane, weight in [0, 256]
+static inline uint32_t RasterLerpColorBits(uint32_t from, uint32_t to, uint32_t weight) {
+	const uint32_t fromRB = from & 0x00FF00FF;
+	const uint32_t fromGA = (from >> 8) & 0x00FF00FF;
+	const uint32_t toRB = to & 0x00FF00FF;
+	const uint32_t toGA = (to >> 8) & 0x00FF00FF;
+
+	const uint32_t rb = ((fromRB * (256 - weight) + toRB * weight) >> 8) & 0x00FF00FF;
+	const uint32_t ga = (fromGA * (256 - weight) + toGA * weight) & 0xFF00FF00;
+	return rb | ga;
+}
+
+// u and v in texels of the level, texel centers are at half texels
+static inline Color RasterTextureSampleNearest(const RasterTextureLevel* level, float u, float v) {
+	float fractionX;
+	float fractionY;
+	const uint32_t x = RasterTextureWrap(u, level->width, &fractionX);
+	const uint32_t y = RasterTextureWrap(v, level->height, &fractionY);
+	return level->texels[RasterTexelIndex(level, x, y)];
+}
+
+static inline Color RasterTextureSampleBilinear(const RasterTextureLevel* level, float u, float v) {
+	float fractionX;
+	float fractionY;
+	const uint32_t x0 = RasterTextureWrap(u - 0.5f, level->width, &fractionX);
+	const uint32_t y0 = RasterTextureWrap(v - 0.5f, level->height, &fractionY);
+	const uint32_t x1 = (x0 + 1 < level->width) ? x0 + 1 : 0;
+	const uint32_t y1 = (y0 + 1 < level->height) ? y0 + 1 : 0;
+
+	const uint32_t weightX = fmaxf(fractionX * 256.0f, 0.0f);
+	const uint32_t weightY = fmaxf(fractionY * 256.0f, 0.0f);
+
+	const uint32_t top = RasterLerpColorBits(RasterColorBits(level->texels[RasterTexelIndex(level, x0, y0)]),
+											 RasterColorBits(level->texels[RasterTexelIndex(level, x1, y0)]), weightX);
+	const uint32_t bottom = RasterLerpColorBits(RasterColorBits(level->texels[RasterTexelIndex(level, x0, y1)]),
+												RasterColorBits(level->texels[RasterTexelIndex(level, x1, y1)]), weightX);
+	return RasterColorFromBits(RasterLerpColorBits(top, bottom, weightY));
+}
+
+// Evaluates the planes at the center of pixel (x, y), always from their origin so a pixel gets the same texel whichever
+// tile or span it is drawn from
+static inline __attribute__((always_inline)) Color RasterTextureShade(const RasterUVPlanes* uv, const RasterTextureLevel* level,
+																	  bool bilinear, int32_t x, int32_t y) {
+	const float dx = x - uv->originX;
+	const float dy = y - uv->originY;
+	const float w = 1.0f / (uv->oneOverW.origin + uv->oneOverW.stepX * dx + uv->oneOverW.stepY * dy);
+	const float u = (uv->uOverW.origin + uv->uOverW.stepX * dx + uv->uOverW.stepY * dy) * w;
+	const float v = (uv->vOverW.origin + uv->vOverW.stepX * dx + uv->vOverW.stepY * dy) * w;
+
+	return bilinear ? RasterTextureSampleBilinear(level, u, v) : RasterTextureSampleNearest(level, u, v);
+}
+
+#endif	// RASTER_TEXTURE_H
@@ -0,0 +1,39 @@
+#ifndef RASTER_THREAD_POOL_H
+#define RASTER_THREAD_POOL_H
+
+#include "RasterCommon.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+typedef void (*RasterJobFunc)(void* userData, uint32_t jobIndex);
+
+typedef struct RasterThreadPool {
+	pthread_t* workers;
+	uint32_t workersSize;
+
+	pthread_mutex_t mutex;
+	pthread_cond_t workCond;
+	pthread_cond_t doneCond;
+	uint64_t generation;
+	uint32_t busyWorkers;
+	bool stopping;
+
+	RasterJobFunc func;
+	void* userData;
+	uint32_t jobCount;
+	atomic_uint nextJob;
+} RasterThreadPool;
+
+uint32_t RasterThreadPoolDefaultThreadCount(void);
+
+// threadCount includes the thread calling RasterThreadPoolRun, so a pool of 1 thread spawns no worker
+RasterThreadPool* RasterThreadPoolCreate(uint32_t threadCount);
+void RasterThreadPoolFree(RasterThreadPool* pool);
+
+uint32_t RasterThreadPoolThreadCount(const RasterThreadPool* pool);
+
+// Calls func once for every job index in [0, jobCount) across the pool and the calling thread, returns once all are done
+void RasterThreadPoolRun(RasterThreadPool* pool, RasterJobFunc func, void* userData, uint32_t jobCount);
+
+#endif	// RASTER_THREAD_POOL_H
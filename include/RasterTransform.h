@@ -0,0 +1,66 @@
+#ifndef RASTER_TRANSFORM_H
+#define RASTER_TRANSFORM_H
+
+#include "RasterTriangle.h"
+
+// Clipping planes of the cameras' projections, same as raylib's
+#define RASTER_CAMERA_NEAR 0.01
+#define RASTER_CAMERA_FAR 1000.0
+
+// Pixels past the screen (on every side) that triangles may reach before they are clipped, well within what triangle
+// setup accepts, so only triangles crossing it (or the near and far planes) are clipped
+#define RASTER_GUARD_BAND (RASTER_COORD_LIMIT / 2)
+
+// Outcodes, a bit per plane the vertex is outside of
+#define RASTER_OUT_LEFT (1 << 0)
+#define RASTER_OUT_RIGHT (1 << 1)
+#define RASTER_OUT_TOP (1 << 2)
+#define RASTER_OUT_BOTTOM (1 << 3)
+#define RASTER_OUT_NEAR (1 << 4)
+#define RASTER_OUT_FAR (1 << 5)
+#define RASTER_OUT_GUARD_LEFT (1 << 6)
+#define RASTER_OUT_GUARD_RIGHT (1 << 7)
+#define RASTER_OUT_GUARD_TOP (1 << 8)
+#define RASTER_OUT_GUARD_BOTTOM (1 << 9)
+
+// A triangle whose vertices are all outside of one of those planes is invisible
+#define RASTER_OUT_VIEW_MASK (RASTER_OUT_LEFT | RASTER_OUT_RIGHT | RASTER_OUT_TOP | RASTER_OUT_BOTTOM | RASTER_OUT_NEAR | RASTER_OUT_FAR)
+// A triangle with a vertex outside of one of those planes has to be clipped
+#define RASTER_OUT_CLIP_MASK \
+	(RASTER_OUT_NEAR | RASTER_OUT_FAR | RASTER_OUT_GUARD_LEFT | RASTER_OUT_GUARD_RIGHT | RASTER_OUT_GUARD_TOP | RASTER_OUT_GUARD_BOTTOM)
+
+// x and y in pixels, z is the depth ([0, 1] inside of the view) and w the clip space w, <= 0 behind the camera
+// Vertices with an outcode in RASTER_OUT_CLIP_MASK aren't divided by w, the clipper needs their homogeneous coordinates
+typedef struct RasterScreenVertex {
+	float x;
+	float y;
+	float z;
+	float w;
+} RasterScreenVertex;
+
+// Planes of the view volume, facing inwards and normalized, so a point p is inside of a plane if
+// plane.x * p.x + plane.y * p.y + plane.z * p.z + plane.w >= 0
+typedef struct RasterFrustum {
+	Vector4 planes[6];
+} RasterFrustum;
+
+// Same projection as raylib's BeginMode3D, aspect is the target's width over its height
+Matrix RasterCameraViewProjection(Camera3D camera, float aspect);
+
+// Orthographic view heightInWorld units high centered on the origin, with world x going right and world y going down
+// the screen, and depth going from z = -heightInWorld (0) to z = heightInWorld (1)
+Matrix RasterDefaultViewProjection(uint32_t width, uint32_t height, float heightInWorld);
+
+// The view volume of mvp, in the space mvp transforms from
+RasterFrustum RasterFrustumFromMatrix(Matrix mvp);
+// True if the sphere is entirely outside of one of the planes, false doesn't guarantee any of it is inside
+bool RasterFrustumCullsSphere(const RasterFrustum* frustum, Vector3 center, float radius);
+
+// Bounding sphere of the transformed sphere, its radius being scaled by the transform's longest axis
+void RasterTransformSphere(Matrix transform, Vector3* center, float* radius);
+
+// mvp follows raylib's order (MatrixMultiply(model, viewProjection)) and maps to clip space, [-1, 1] on every axis
+void RasterTransformVertices(const Vector3* positions, size_t count, Matrix mvp, uint32_t width, uint32_t height,
+							 RasterScreenVertex* screenVertices, uint16_t* outcodes);
+
+#endif	// RASTER_TRANSFORM_H
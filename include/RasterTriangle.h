@@ -0,0 +1,97 @@
+#ifndef RASTER_TRIANGLE_H
+#define RASTER_TRIANGLE_H
+
+#include "RasterCommon.h"
+
+// Vertices are snapped to a 1/256th of a pixel grid, edge functions are evaluated at pixel centers
+#define RASTER_SUBPIXEL_BITS 8
+#define RASTER_SUBPIXEL_ONE (1 << RASTER_SUBPIXEL_BITS)
+#define RASTER_SUBPIXEL_HALF (RASTER_SUBPIXEL_ONE / 2)
+
+// Triangles with a vertex further than this (in pixels) are rejected so the edge functions can't overflow
+#define RASTER_COORD_LIMIT 1048576.0f
+
+// Triangles at least this large on both axes are filled block by block by the SIMD kernels
+#define RASTER_BLOCK_SIZE 8
+
+// Pixel rectangle, max bounds are exclusive
+typedef struct RasterRect {
+	int32_t minX;
+	int32_t minY;
+	int32_t maxX;
+	int32_t maxY;
+} RasterRect;
+
+typedef struct RasterEdge {
+	int64_t stepX;
+	int64_t stepY;
+	int64_t origin;	 // Value at the center of bounds' top-left pixel, fill rule bias included
+} RasterEdge;
+
+// Value interpolated linearly in screen space, relative to the center of the top-left pixel of the triangle's bounds
+// once set up, like edges
+typedef struct RasterPlane {
+	float stepX;
+	float stepY;
+	float origin;
+} RasterPlane;
+
+// Depth interpolated linearly in screen space, zeroed for triangles set up without depth
+// Clipping the triangle keeps the plane as is, so its pixels get the same depths whichever tiles it is split into
+typedef struct RasterDepthPlane {
+	float stepX;
+	float stepY;
+	float origin;  // Value at the center of the (originX, originY) pixel
+	float min;	   // Depth range of the vertices, which bounds every covered pixel's depth
+	float max;
+	int32_t originX;
+	int32_t originY;
+} RasterDepthPlane;
+
+// A pixel is covered when all three edges are >= 0
+typedef struct RasterTriangle {
+	RasterEdge edges[3];
+	RasterRect bounds;
+	RasterDepthPlane depth;
+} RasterTriangle;
+
+// Pixels covered by the triangles that went through the per pixel depth test, and pixels actually written
+typedef struct RasterFillCounts {
+	uint64_t tested;
+	uint64_t written;
+} RasterFillCounts;
+
+typedef enum RasterFillKernelType {
+	RASTER_FILL_KERNEL_AUTO = 0,  // Widest kernel supported by the running CPU
+	RASTER_FILL_KERNEL_SCALAR,
+	RASTER_FILL_KERNEL_SSE2,
+	RASTER_FILL_KERNEL_AVX2,
+} RasterFillKernelType;
+
+// Returns false (and keeps the current kernel) if the CPU or the build doesn't support the requested kernel
+bool RasterTriangleSelectFillKernel(RasterFillKernelType type);
+RasterFillKernelType RasterTriangleGetFillKernel(void);
+
+bool RasterTriangleSetup(RasterTriangle* tri, Vector2 a, Vector2 b, Vector2 c, RasterRect clip);
+// Same as RasterTriangleSetup, with the bounds grown to every pixel that has samples covered (samples being less than
+// half a pixel from its center), and triangles only covering samples kept
+bool RasterTriangleSetupSampled(RasterTriangle* tri, Vector2 a, Vector2 b, Vector2 c, RasterRect clip);
+// Same as RasterTriangleSetup, with z as each vertex's depth
+bool RasterTriangleSetupDepth(RasterTriangle* tri, Vector3 a, Vector3 b, Vector3 c, RasterRect clip);
+// Same as RasterTriangleSetupSampled, with z as each vertex's depth
+bool RasterTriangleSetupDepthSampled(RasterTriangle* tri, Vector3 a, Vector3 b, Vector3 c, RasterRect clip);
+
+// Sets up a plane per values triplet (one value per vertex), tri must have just been set up from the same a, b and c
+void RasterTriangleSetupPlanes(const RasterTriangle* tri, Vector2 a, Vector2 b, Vector2 c, const float (*values)[3], uint32_t count,
+							   RasterPlane* planes);
+
+// Restricts tri to the clip rectangle, covering exactly the same pixels inside of it, returns false if nothing is left
+bool RasterTriangleClip(const RasterTriangle* tri, RasterRect clip, RasterTriangle* clipped);
+
+// Returns false if the row has no covered pixel, otherwise [*spanMinX, *spanMaxX) is the covered span
+bool RasterTriangleRowSpan(const RasterTriangle* tri, int32_t y, int32_t* spanMinX, int32_t* spanMaxX);
+
+// Returns the number of pixels written
+uint32_t RasterTriangleFill(const RasterTriangle* tri, Color* pixels, uint32_t stride, Color col);
+
+#endif	// RASTER_TRIANGLE_H
@@ -0,0 +1,53 @@
+#ifndef RASTER_VIDEO_SINK_H
+#define RASTER_VIDEO_SINK_H
+
+#include "RasterFrameWriter.h"
+
+#include <stdatomic.h>
+
+#define RASTER_VIDEO_HEADER_SIZE 64
+
+typedef enum RasterVideoFormat {
+	RASTER_VIDEO_Y4M = 0,  // YUV4MPEG2, 4:2:0 BT.601 limited range, what most encoders read from a pipe
+	RASTER_VIDEO_PPM,	   // Binary PPMs (P6) back to back
+} RasterVideoFormat;
+
+// Streams successive frames of a fixed size to a file, named pipe or file descriptor
+typedef struct RasterVideoSink {
+	int fd;
+	bool ownsFd;
+	RasterVideoFormat format;
+	uint32_t width;
+	uint32_t height;
+	uint32_t framesPerSecond;
+
+	// The stream's header for Y4M (written before the first frame), every frame's header for PPM
+	char header[RASTER_VIDEO_HEADER_SIZE];
+	size_t headerSize;
+	bool headerWritten;
+
+	RasterFrameWriter* queue;  // NULL when frames are converted and written by RasterVideoSinkPush's caller
+
+	// Reused by every frame, only used by the thread writing the frames
+	uint8_t* converted;
+	size_t convertedSize;
+	atomic_bool failed;  // Once a write failed, every following frame is dropped
+} RasterVideoSink;
+
+// "-" streams to the standard output, opening a named pipe blocks until its reader opens it
+// queueDepth frames can wait for the writer thread before RasterVideoSinkPush blocks, 0 writes them synchronously
+RasterVideoSink* RasterVideoSinkOpen(const char* path, RasterVideoFormat format, uint32_t width, uint32_t height,
+									 uint32_t framesPerSecond, uint32_t queueDepth);
+// fd is left open by RasterVideoSinkClose
+RasterVideoSink* RasterVideoSinkOpenFd(int fd, RasterVideoFormat format, uint32_t width, uint32_t height, uint32_t framesPerSecond,
+									   uint32_t queueDepth);
+// Writes every queued frame first, false if any frame couldn't be written
+bool RasterVideoSinkClose(RasterVideoSink* sink);
+
+// pixels must be width by height, false once any frame couldn't be written
+bool RasterVideoSinkPush(RasterVideoSink* sink, const Color* pixels);
+
+// Waits until every queued frame is written, false if any of them couldn't be
+bool RasterVideoSinkFlush(RasterVideoSink* sink);
+
+#endif	// RASTER_VIDEO_SINK_H
@@ -1,6 +1,10 @@
-#ifndef MAIN_H
-#define MAIN_H
-
-#include "App.h"
-
-#endif	// MAIN_H
+#ifndef MAIN_H
+#define MAIN_H
+
+#include "BatchRender.h"
+
+#ifndef RASTER_HEADLESS
+#include "App.h"
+#endif
+
+#endif	// MAIN_H
@@ -1,6 +1,55 @@
 #include "App.h"
 
-#define RASTER_SCALE 4
+// Window pixels per target pixel, when the whole target is drawn
+#define RASTER_SCALE 2
+#define TARGET_FPS 60
+// Smallest viewport dynamic resolution goes down to, per axis
+#define MIN_RESOLUTION_SCALE 0.25f
+
+#define CUBE_TURNS_PER_SECOND 0.25f
+
+#define STATS_FONT_SIZE 20
+
+#define CUBE_TEXTURE_SIZE 64
+#define CUBE_TEXTURE_CELLS 8
+#define CUBE_SHADINGS_COUNT 4
+// Shining down from behind the camera, slightly to the left
+#define LIGHT_DIRECTION ((Vector3){0.5f, -1.0f, -0.75f})
+
+// Grid of cubes on the ground, most of it out of view
+#define SCENE_GRID_SIZE 32
+#define SCENE_GRID_SPACING 1.5f
+#define SCENE_CUBE_SCALE 0.3f
+
+#define AppInitFail()                                               \
+	{                                                               \
+		if (app->pipeline) RasterPipelineFree(app->pipeline);       \
+		if (app->scene) RasterSceneFree(app->scene);                \
+		if (app->cubeTexture) RasterTextureFree(app->cubeTexture);  \
+		if (app->cubeModel) RasterModelFree(app->cubeModel);        \
+		if (app->rasterTarget) RasterTargetFree(app->rasterTarget); \
+		CloseWindow();                                              \
+		return false;                                               \
+	}
+
+// Runs on the render thread, which owns the target and the scene until the frame is waited for
+static void AppDraw(void* userData, RasterTarget* screen) {
+	App* app = userData;
+	RasterTargetClearBackground(screen, PINK);
+
+	// The cubes only spin in place, so their bounds don't move and the hierarchy is refit to the same boxes
+	const float angle = app->time * CUBE_TURNS_PER_SECOND * 2.0f * PI;
+	const Matrix rotation = MatrixMultiply(MatrixScale(SCENE_CUBE_SCALE, SCENE_CUBE_SCALE, SCENE_CUBE_SCALE),
+										   MatrixRotateXYZ((Vector3){angle / 2.0f, angle, 0.0f}));
+	const float gridOffset = (SCENE_GRID_SIZE - 1) * SCENE_GRID_SPACING / 2.0f;
+	for (uint32_t i = 0; i < SCENE_GRID_SIZE * SCENE_GRID_SIZE; i++) {
+		const float x = (i % SCENE_GRID_SIZE) * SCENE_GRID_SPACING - gridOffset;
+		const float z = (i / SCENE_GRID_SIZE) * SCENE_GRID_SPACING - gridOffset;
+		RasterSceneSetTransform(app->scene, i, MatrixMultiply(rotation, MatrixTranslate(x, 0.0f, z)));
+	}
+
+	RasterSceneDraw(app->scene, screen);
+}
 
 bool AppInit(App* app) {
 	const uint32_t winWidth = 1920 / 2;
@@ -9,45 +58,107 @@ bool AppInit(App* app) {
 	const uint32_t rasterWidth = winWidth / RASTER_SCALE;
 	const uint32_t rasterHeight = winHeight / RASTER_SCALE;
 
+	*app = (App){0};
 	SetTraceLogLevel(LOG_WARNING);
-	SetTargetFPS(60);
+	SetTargetFPS(TARGET_FPS);
 	InitWindow(winWidth, winHeight, "LuRaster - made with Raylib in C");
 
 	app->rasterTarget = RasterTargetCreate(rasterWidth, rasterHeight);
-	if (!app->rasterTarget) {
-		CloseWindow();
-		return false;
+	if (!app->rasterTarget) AppInitFail();
+
+	if (!RasterTargetSetThreadCount(app->rasterTarget, 0)) {
+		LogString("Could not start the raster worker threads, drawing on the main thread\n");
 	}
 
+	const Camera3D camera = (Camera3D){
+		.position = (Vector3){0.0f, 3.0f, 6.0f},
+		.target = (Vector3){0.0f, 0.0f, 0.0f},
+		.up = (Vector3){0.0f, 1.0f, 0.0f},
+		.fovy = 45.0f,
+		.projection = CAMERA_PERSPECTIVE,
+	};
+	RasterTargetSetCamera(app->rasterTarget, camera);
+	RasterTargetSetLightDirection(app->rasterTarget, LIGHT_DIRECTION);
+
 	app->cubeModel = LoadRasterModelFromFile("models/cube.obj");
-	if (!app->cubeModel) {
-		RasterTargetFree(app->rasterTarget);
-		CloseWindow();
-		return false;
+	if (!app->cubeModel) AppInitFail();
+
+	app->cubeTexture = RasterTextureCreateChecker(CUBE_TEXTURE_SIZE, CUBE_TEXTURE_CELLS, RAYWHITE, DARKGRAY, true);
+	if (!app->cubeTexture) AppInitFail();
+	app->cubeShading = 0;
+
+	app->scene = RasterSceneCreate();
+	if (!app->scene) AppInitFail();
+
+	for (uint32_t i = 0; i < SCENE_GRID_SIZE * SCENE_GRID_SIZE; i++) {
+		if (RasterSceneAdd(app->scene, app->cubeModel, MatrixIdentity()) == RASTER_SCENE_INVALID_ID) AppInitFail();
 	}
 
+	app->pipeline = RasterPipelineCreate(app->rasterTarget, AppDraw, app, true);
+	if (!app->pipeline) AppInitFail();
+
+	RasterGovernorInit(&app->governor, 1e9 / TARGET_FPS, MIN_RESOLUTION_SCALE);
+	app->dynamicResolution = true;
+
+	app->showStats = RASTER_STATS_ENABLED;
 	return true;
 }
 
+// Takes the frame rendered during the previous present, then starts the next one, the changes made in between only
+// show up in that next frame
 void AppUpdate(App* app) {
-	RasterTargetClearBackground(app->rasterTarget, PINK);
+	RasterPipelineWait(app->pipeline);
+
+	if (IsKeyPressed(KEY_F3)) app->showStats = !app->showStats;
+	if (IsKeyPressed(KEY_F4)) app->cubeShading = (app->cubeShading + 1) % CUBE_SHADINGS_COUNT;
+	if (IsKeyPressed(KEY_F5)) {
+		app->dynamicResolution = !app->dynamicResolution;
+		RasterGovernorInit(&app->governor, app->governor.targetFrameNs, app->governor.minScale);
+	}
+	if (IsKeyPressed(KEY_F6)) {
+		const uint32_t samplesCount = RasterTargetGetSampleCount(app->rasterTarget);
+		RasterTargetSetSampleCount(app->rasterTarget, (samplesCount == 1) ? 4 : (samplesCount == 4) ? 8 : 1);
+	}
+
+	// Only the render thread's time scales with the viewport, presenting takes about the same time at any size
+	RasterTarget* screen = app->rasterTarget;
+	if (app->dynamicResolution) RasterGovernorUpdate(&app->governor, screen, app->pipeline->frontStats.frameNs);
+	else RasterTargetSetViewport(screen, screen->maxWidth, screen->maxHeight);
 
-	srand(1);  // So that the cube always has the same colors
-	RasterTargetDrawModel(app->rasterTarget, app->cubeModel);
+	const RasterTextureFilter filter = (app->cubeShading == 3) ? RASTER_TEXTURE_BILINEAR : RASTER_TEXTURE_NEAREST;
+	RasterTargetSetTexture(app->rasterTarget, (app->cubeShading >= 2) ? app->cubeTexture : NULL, filter);
+	RasterTargetSetShading(app->rasterTarget, (app->cubeShading == 1) ? RASTER_SHADING_LAMBERT : RASTER_SHADING_FLAT);
+	app->time = GetTime();
 
-	RasterTargetUpdateTexture(app->rasterTarget);
+	RasterPipelineRender(app->pipeline);
 }
 
+// Presents the front frame while the next one renders, the overlay shows the previous frame's stats, this one's only
+// end once it is presented
 void AppRender(const App* app) {
+	RasterPipeline* pipeline = app->pipeline;
+
+	RasterStatsEnter(&pipeline->presentStats, RASTER_STAGE_UPLOAD);
+	RasterTargetUpdateTextureFromBuffer(app->rasterTarget, pipeline->front);
+	RasterStatsSwitch(&pipeline->presentStats, RASTER_STAGE_PRESENT);
+
 	BeginDrawing();
 	ClearBackground(BLACK);
 
 	RasterTargetRenderTextureEx(app->rasterTarget, RASTER_SCALE);
+	if (app->showStats) RasterStatsDrawOverlay(&pipeline->last, STATS_FONT_SIZE);
 
 	EndDrawing();
+
+	RasterStatsLeave(&pipeline->presentStats);
+	RasterPipelineEndPresent(pipeline);
 }
 
 void AppClose(App* app) {
+	RasterPipelineFree(app->pipeline);
+	RasterSceneFree(app->scene);
 	RasterTargetFree(app->rasterTarget);
+	RasterTextureFree(app->cubeTexture);
+	RasterModelFree(app->cubeModel);
 	CloseWindow();
 }
@@ -0,0 +1,388 @@
+#include "BatchRender.h"
+
+#include <signal.h>
+#include <stdio.h>
+
+#define DEFAULT_OUTPUT_PREFIX "frame_"
+#define DEFAULT_FRAMES_COUNT 1
+#define DEFAULT_WIDTH 480
+#define DEFAULT_HEIGHT 270
+#define DEFAULT_SAVE_QUEUE_DEPTH 4
+#define DEFAULT_FRAMES_PER_SECOND 30
+#define DEFAULT_BUFFERS_COUNT 2
+
+#define CHECKER_TEXTURE_NAME "checker"
+#define CHECKER_TEXTURE_SIZE 256
+#define CHECKER_TEXTURE_CELLS 16
+
+#define MAX_TARGET_SIZE 16384
+#define MAX_SAVE_QUEUE_DEPTH 256
+#define MAX_FRAMES_PER_SECOND 1000
+#define MAX_BUFFERS_COUNT 2
+
+#define FRAME_PATH_LEN 4096
+
+void BatchRenderPrintUsage(const char* programName) {
+	LogMessage(
+		"Usage: %s [options] <model.obj>\n"
+		"\t-o <prefix>   frames are saved to <prefix>0000.bmp, <prefix>0001.bmp, ... (default: " DEFAULT_OUTPUT_PREFIX ")\n"
+		"\t-n <count>    number of frames to render (default: %d)\n"
+		"\t-w <width>    width of the frames in pixels (default: %d)\n"
+		"\t-h <height>   height of the frames in pixels (default: %d)\n"
+		"\t-t <threads>  raster threads, 0 for one per core (default: 0)\n"
+		"\t-d <bits>     depth buffer bits, 0 (none), 16 or 32 (default: 0)\n"
+		"\t-a <samples>  anti-aliasing samples per pixel, 1 (none), 4 or 8 (default: 1)\n"
+		"\t-c <faces>    faces culled, back, front or none (default: back)\n"
+		"\t-l <shading>  flat, vertex (colors), lambert (lit by a directional light) or depth (only) (default: flat)\n"
+		"\t-x <texture>  textures the model with a BMP or PPM file, or a generated " CHECKER_TEXTURE_NAME "board\n"
+		"\t-i <filter>   texture filter, nearest or bilinear (default: bilinear)\n"
+		"\t-q <frames>   frames waiting to be saved by a background thread, 0 saves on the main thread (default: %d)\n"
+		"\t-b <buffers>  2 renders the next frame on its own thread while the main thread outputs the previous one, 1\n"
+		"\t              renders and outputs each frame in turn (default: %d)\n"
+		"\t-s <path>     streams the frames to a file or named pipe (- for the standard output) instead of saving BMPs\n"
+		"\t-f <format>   format of the stream, y4m or ppm (default: y4m)\n"
+		"\t-r <fps>      frame rate written in the y4m stream's header (default: %d)\n"
+		"\t-m <path>     writes every frame's stats there, as JSON lines for .json or .jsonl files, CSV otherwise\n",
+		programName, DEFAULT_FRAMES_COUNT, DEFAULT_WIDTH, DEFAULT_HEIGHT, DEFAULT_SAVE_QUEUE_DEPTH, DEFAULT_BUFFERS_COUNT,
+		DEFAULT_FRAMES_PER_SECOND);
+}
+
+static bool ParseUInt32Arg(const char* arg, char option, uint32_t minValue, uint32_t maxValue, uint32_t* value) {
+	char* end = NULL;
+	const unsigned long long parsed = strtoull(arg, &end, 10);
+
+	if (end == arg || *end || *arg == '-' || parsed < minValue || parsed > maxValue) {
+		LogMessage("Invalid value \"%s\" for -%c (expected an integer in [%u, %u])\n", arg, option, minValue, maxValue);
+		return false;
+	}
+
+	*value = parsed;
+	return true;
+}
+
+static bool ParseDepthArg(const char* arg, RasterDepthFormat* format) {
+	if (!strcmp(arg, "0")) *format = RASTER_DEPTH_NONE;
+	else if (!strcmp(arg, "16")) *format = RASTER_DEPTH_16;
+	else if (!strcmp(arg, "32")) *format = RASTER_DEPTH_32F;
+	else {
+		LogMessage("Invalid value \"%s\" for -d (expected 0, 16 or 32)\n", arg);
+		return false;
+	}
+	return true;
+}
+
+static bool ParseSamplesArg(const char* arg, uint32_t* samplesCount) {
+	if (!strcmp(arg, "1")) *samplesCount = 1;
+	else if (!strcmp(arg, "4")) *samplesCount = 4;
+	else if (!strcmp(arg, "8")) *samplesCount = 8;
+	else {
+		LogMessage("Invalid value \"%s\" for -a (expected 1, 4 or 8)\n", arg);
+		return false;
+	}
+	return true;
+}
+
+static bool ParseCullArg(const char* arg, RasterCullMode* mode) {
+	if (!strcmp(arg, "back")) *mode = RASTER_CULL_BACK;
+	else if (!strcmp(arg, "front")) *mode = RASTER_CULL_FRONT;
+	else if (!strcmp(arg, "none")) *mode = RASTER_CULL_NONE;
+	else {
+		LogMessage("Invalid value \"%s\" for -c (expected back, front or none)\n", arg);
+		return false;
+	}
+	return true;
+}
+
+static bool ParseShadingArg(const char* arg, RasterShading* shading) {
+	if (!strcmp(arg, "flat")) *shading = RASTER_SHADING_FLAT;
+	else if (!strcmp(arg, "vertex")) *shading = RASTER_SHADING_VERTEX;
+	else if (!strcmp(arg, "lambert")) *shading = RASTER_SHADING_LAMBERT;
+	else if (!strcmp(arg, "depth")) *shading = RASTER_SHADING_DEPTH_ONLY;
+	else {
+		LogMessage("Invalid value \"%s\" for -l (expected flat, vertex, lambert or depth)\n", arg);
+		return false;
+	}
+	return true;
+}
+
+static bool ParseFilterArg(const char* arg, RasterTextureFilter* filter) {
+	if (!strcmp(arg, "nearest")) *filter = RASTER_TEXTURE_NEAREST;
+	else if (!strcmp(arg, "bilinear")) *filter = RASTER_TEXTURE_BILINEAR;
+	else {
+		LogMessage("Invalid value \"%s\" for -i (expected nearest or bilinear)\n", arg);
+		return false;
+	}
+	return true;
+}
+
+static bool ParseVideoFormatArg(const char* arg, RasterVideoFormat* format) {
+	if (!strcmp(arg, "y4m")) *format = RASTER_VIDEO_Y4M;
+	else if (!strcmp(arg, "ppm")) *format = RASTER_VIDEO_PPM;
+	else {
+		LogMessage("Invalid value \"%s\" for -f (expected y4m or ppm)\n", arg);
+		return false;
+	}
+	return true;
+}
+
+bool BatchRenderParseArgs(BatchRenderOptions* options, int argc, char** argv) {
+	*options = (BatchRenderOptions){
+		.outputPrefix = DEFAULT_OUTPUT_PREFIX,
+		.framesCount = DEFAULT_FRAMES_COUNT,
+		.width = DEFAULT_WIDTH,
+		.height = DEFAULT_HEIGHT,
+		.threadCount = 0,
+		.depthFormat = RASTER_DEPTH_NONE,
+		.samplesCount = 1,
+		.cullMode = RASTER_CULL_BACK,
+		.shading = RASTER_SHADING_FLAT,
+		.textureFilter = RASTER_TEXTURE_BILINEAR,
+		.saveQueueDepth = DEFAULT_SAVE_QUEUE_DEPTH,
+		.buffersCount = DEFAULT_BUFFERS_COUNT,
+		.streamFormat = RASTER_VIDEO_Y4M,
+		.framesPerSecond = DEFAULT_FRAMES_PER_SECOND,
+	};
+
+	for (int32_t i = 1; i < argc; i++) {
+		const char* arg = argv[i];
+
+		if (arg[0] != '-') {
+			if (options->modelPath) {
+				BatchRenderPrintUsage(argv[0]);
+				return false;
+			}
+			options->modelPath = arg;
+			continue;
+		}
+
+		if (!arg[1] || arg[2] || i + 1 >= argc) {
+			BatchRenderPrintUsage(argv[0]);
+			return false;
+		}
+
+		const char option = arg[1];
+		const char* value = argv[++i];
+		bool validArg = true;
+		switch (option) {
+			case 'o':
+				options->outputPrefix = value;
+				break;
+			case 'n':
+				validArg = ParseUInt32Arg(value, option, 1, UINT32_MAX, &options->framesCount);
+				break;
+			case 'w':
+				validArg = ParseUInt32Arg(value, option, 1, MAX_TARGET_SIZE, &options->width);
+				break;
+			case 'h':
+				validArg = ParseUInt32Arg(value, option, 1, MAX_TARGET_SIZE, &options->height);
+				break;
+			case 't':
+				validArg = ParseUInt32Arg(value, option, 0, UINT16_MAX, &options->threadCount);
+				break;
+			case 'd':
+				validArg = ParseDepthArg(value, &options->depthFormat);
+				break;
+			case 'a':
+				validArg = ParseSamplesArg(value, &options->samplesCount);
+				break;
+			case 'c':
+				validArg = ParseCullArg(value, &options->cullMode);
+				break;
+			case 'l':
+				validArg = ParseShadingArg(value, &options->shading);
+				break;
+			case 'x':
+				options->texturePath = value;
+				break;
+			case 'i':
+				validArg = ParseFilterArg(value, &options->textureFilter);
+				break;
+			case 'q':
+				validArg = ParseUInt32Arg(value, option, 0, MAX_SAVE_QUEUE_DEPTH, &options->saveQueueDepth);
+				break;
+			case 'b':
+				validArg = ParseUInt32Arg(value, option, 1, MAX_BUFFERS_COUNT, &options->buffersCount);
+				break;
+			case 's':
+				options->streamPath = value;
+				break;
+			case 'f':
+				validArg = ParseVideoFormatArg(value, &options->streamFormat);
+				break;
+			case 'r':
+				validArg = ParseUInt32Arg(value, option, 1, MAX_FRAMES_PER_SECOND, &options->framesPerSecond);
+				break;
+			case 'm':
+				options->statsPath = value;
+				break;
+			default:
+				validArg = false;
+				break;
+		}
+
+		if (!validArg) {
+			BatchRenderPrintUsage(argv[0]);
+			return false;
+		}
+	}
+
+	if (!options->modelPath) {
+		BatchRenderPrintUsage(argv[0]);
+		return false;
+	}
+
+	return true;
+}
+
+#define BatchRenderExit(success)                    \
+	{                                               \
+		if (statsFile) CloseFile(statsFile);        \
+		if (pipeline) RasterPipelineFree(pipeline); \
+		if (model) RasterModelFree(model);          \
+		if (screen) RasterTargetFree(screen);       \
+		if (texture) RasterTextureFree(texture);    \
+		return success;                             \
+	}
+
+static bool HasSuffix(const char* str, const char* suffix) {
+	const size_t strLen = strlen(str);
+	const size_t suffixLen = strlen(suffix);
+	return strLen >= suffixLen && !strcmp(str + strLen - suffixLen, suffix);
+}
+
+static bool IsJSONStatsPath(const char* path) { return HasSuffix(path, ".json") || HasSuffix(path, ".jsonl"); }
+
+static bool WriteFrameStats(FILE* statsFile, const BatchRenderOptions* options, const RasterFrameStats* frameStats) {
+	if (IsJSONStatsPath(options->statsPath)) return RasterStatsWriteJSON(statsFile, frameStats);
+	return RasterStatsWriteCSV(statsFile, frameStats);
+}
+
+static bool OutputFrame(RasterTarget* screen, const RasterTargetBuffer* buffer, const BatchRenderOptions* options, uint32_t frame) {
+	if (options->streamPath) {
+		if (RasterTargetStreamBuffer(screen, buffer)) return true;
+
+		LogMessage("Could not stream frame %u\n", frame);
+		return false;
+	}
+
+	char framePath[FRAME_PATH_LEN];
+	if (snprintf(framePath, FRAME_PATH_LEN, "%s%04u.bmp", options->outputPrefix, frame) >= FRAME_PATH_LEN) {
+		LogMessage("Output prefix \"%s\" is too long\n", options->outputPrefix);
+		return false;
+	}
+
+	if (!RasterTargetSaveBufferToFile(screen, buffer, framePath)) {
+		LogMessage("Could not save frame %u to \"%s\"\n", frame, framePath);
+		return false;
+	}
+	return true;
+}
+
+static void RenderFrame(void* userData, RasterTarget* screen) {
+	const RasterModel* model = userData;
+	RasterTargetClearBackground(screen, PINK);
+
+	RasterTargetDrawModel(screen, model);
+}
+
+bool BatchRender(const BatchRenderOptions* options) {
+	RasterModel* model = NULL;
+	RasterTexture* texture = NULL;
+	RasterTarget* screen = NULL;
+	RasterPipeline* pipeline = NULL;
+	FILE* statsFile = NULL;
+
+	model = LoadRasterModelFromFile(options->modelPath);
+	if (!model) {
+		LogMessage("Could not load the model \"%s\"\n", options->modelPath);
+		BatchRenderExit(false);
+	}
+
+	screen = RasterTargetCreateHeadless(options->width, options->height);
+	if (!screen) BatchRenderExit(false);
+
+	if (!RasterTargetSetThreadCount(screen, options->threadCount)) {
+		LogString("Could not start the raster worker threads, drawing on the main thread\n");
+	}
+
+	if (!RasterTargetSetDepthFormat(screen, options->depthFormat)) {
+		LogString("Could not allocate the depth buffer\n");
+		BatchRenderExit(false);
+	}
+	if (!RasterTargetSetSampleCount(screen, options->samplesCount)) {
+		LogString("Could not allocate the sample buffer\n");
+		BatchRenderExit(false);
+	}
+	RasterTargetSetCullMode(screen, options->cullMode);
+	RasterTargetSetShading(screen, options->shading);
+
+	if (options->texturePath) {
+		if (!strcmp(options->texturePath, CHECKER_TEXTURE_NAME)) {
+			texture = RasterTextureCreateChecker(CHECKER_TEXTURE_SIZE, CHECKER_TEXTURE_CELLS, RAYWHITE, DARKGRAY, true);
+		} else {
+			texture = LoadRasterTextureFromFile(options->texturePath, true);
+		}
+
+		if (!texture) {
+			LogMessage("Could not load the texture \"%s\"\n", options->texturePath);
+			BatchRenderExit(false);
+		}
+		RasterTargetSetTexture(screen, texture, options->textureFilter);
+	}
+
+	if (options->streamPath) {
+#ifdef SIGPIPE
+		signal(SIGPIPE, SIG_IGN);  // A reader closing the pipe fails the writes instead of killing us
+#endif
+		if (!RasterTargetOpenVideoStream(screen, options->streamPath, options->streamFormat, options->framesPerSecond,
+										 options->saveQueueDepth)) {
+			LogMessage("Could not open the video stream \"%s\"\n", options->streamPath);
+			BatchRenderExit(false);
+		}
+	} else if (!RasterTargetSetSaveQueueDepth(screen, options->saveQueueDepth)) {
+		LogString("Could not start the frame writer thread, saving on the main thread\n");
+	}
+
+	if (options->statsPath) {
+		if (!RASTER_STATS_ENABLED) LogString("Built without STATS=1, only the frame times and triangles will be measured\n");
+
+		statsFile = TryOpenFile(options->statsPath, "w");
+		if (!statsFile || (!IsJSONStatsPath(options->statsPath) && !RasterStatsWriteCSVHeader(statsFile))) {
+			LogMessage("Could not write the stats to \"%s\"\n", options->statsPath);
+			BatchRenderExit(false);
+		}
+	}
+
+	pipeline = RasterPipelineCreate(screen, RenderFrame, model, options->buffersCount > 1);
+	if (!pipeline) BatchRenderExit(false);
+
+	// Frame i is output while frame i + 1 renders
+	for (uint32_t frame = 0; frame < options->framesCount; frame++) {
+		const RasterTargetBuffer* buffer = RasterPipelineWait(pipeline);
+		if (frame + 1 < options->framesCount) RasterPipelineRender(pipeline);
+
+		RasterStatsEnter(&pipeline->presentStats, RASTER_STAGE_OUTPUT);
+		if (!OutputFrame(screen, buffer, options, frame)) BatchRenderExit(false);
+		RasterStatsLeave(&pipeline->presentStats);
+
+		const RasterFrameStats* frameStats = RasterPipelineEndPresent(pipeline);
+		if (statsFile && !WriteFrameStats(statsFile, options, frameStats)) {
+			LogMessage("Could not write the stats to \"%s\"\n", options->statsPath);
+			BatchRenderExit(false);
+		}
+	}
+
+	if (!RasterTargetFlushSaves(screen) || !RasterTargetCloseVideoStream(screen)) BatchRenderExit(false);
+	if (statsFile && fflush(statsFile) != 0) {
+		LogMessage("Could not write the stats to \"%s\"\n", options->statsPath);
+		BatchRenderExit(false);
+	}
+
+	const RasterCullStats stats = RasterTargetGetCullStats(screen);
+	LogMessage("Triangles per frame: %llu submitted, %llu outside of the view, %llu back-faces, %llu degenerate, %llu clipped, %llu rasterized\n",
+			   (unsigned long long)(stats.submitted / options->framesCount), (unsigned long long)(stats.frustumCulled / options->framesCount),
+			   (unsigned long long)(stats.backFaceCulled / options->framesCount), (unsigned long long)(stats.degenerate / options->framesCount),
+			   (unsigned long long)(stats.clipped / options->framesCount), (unsigned long long)(stats.rasterized / options->framesCount));
+
+	BatchRenderExit(true);
+}
@@ -0,0 +1,82 @@
+#include "RasterArena.h"
+
+struct RasterArenaBlock {
+	RasterArenaBlock* previous;
+	size_t size;  // Usable bytes, after the header
+	size_t used;
+};
+
+#define BLOCK_HEADER_SIZE ((sizeof(RasterArenaBlock) + RASTER_ARENA_ALIGNMENT - 1) & ~(size_t)(RASTER_ARENA_ALIGNMENT - 1))
+
+static uint8_t* BlockData(RasterArenaBlock* block) { return (uint8_t*)block + BLOCK_HEADER_SIZE; }
+
+size_t RasterArenaAlignedSize(size_t size) { return (size + RASTER_ARENA_ALIGNMENT - 1) & ~(size_t)(RASTER_ARENA_ALIGNMENT - 1); }
+
+void RasterArenaInit(RasterArena* arena, size_t blockSize) {
+	*arena = (RasterArena){
+		.blockSize = RasterArenaAlignedSize(blockSize),
+	};
+}
+
+static void FreeBlock(RasterArena* arena) {
+	RasterArenaBlock* block = arena->block;
+	arena->block = block->previous;
+	arena->blocksCount--;
+	arena->reservedSize -= BLOCK_HEADER_SIZE + block->size;
+	Free(block);
+}
+
+void RasterArenaFree(RasterArena* arena) {
+	while (arena->block) FreeBlock(arena);
+}
+
+static bool AddBlock(RasterArena* arena, size_t minSize) {
+	const size_t size = Max(arena->blockSize, minSize);
+	if (size > SIZE_MAX - BLOCK_HEADER_SIZE) return false;
+
+	RasterArenaBlock* block = NULL;
+	if (!Malloc(block, BLOCK_HEADER_SIZE + size)) return false;
+
+	*block = (RasterArenaBlock){
+		.previous = arena->block,
+		.size = size,
+	};
+	arena->block = block;
+	arena->blocksCount++;
+	arena->reservedSize += BLOCK_HEADER_SIZE + size;
+	arena->peakSize = Max(arena->peakSize, arena->reservedSize);
+	return true;
+}
+
+// The rest of a block too small for an allocation is left unused, the allocations after it go to the new block
+void* RasterArenaAlloc(RasterArena* arena, size_t size) {
+	if (size > SIZE_MAX - RASTER_ARENA_ALIGNMENT) return NULL;
+	size = RasterArenaAlignedSize(size);
+
+	RasterArenaBlock* block = arena->block;
+	if (!block || block->size - block->used < size) {
+		if (!AddBlock(arena, size)) return NULL;
+		block = arena->block;
+	}
+
+	void* ptr = BlockData(block) + block->used;
+	block->used += size;
+	return ptr;
+}
+
+void* RasterArenaAllocArray(RasterArena* arena, size_t count, size_t elementSize) {
+	if (elementSize && count > SIZE_MAX / elementSize) return NULL;
+	return RasterArenaAlloc(arena, count * elementSize);
+}
+
+RasterArenaMark RasterArenaGetMark(const RasterArena* arena) {
+	return (RasterArenaMark){
+		.block = arena->block,
+		.used = arena->block ? arena->block->used : 0,
+	};
+}
+
+void RasterArenaRewind(RasterArena* arena, RasterArenaMark mark) {
+	while (arena->block && arena->block != mark.block) FreeBlock(arena);
+	if (arena->block) arena->block->used = mark.used;
+}
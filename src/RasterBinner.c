@@ -0,0 +1,177 @@
+#include "RasterBinner.h"
+
+DefineArrayMethods(RasterTriangle, RasterTriangleArray);
+DefineArrayMethods(Color, RasterColorArray);
+DefineArrayMethods(RasterUVPlanes, RasterUVPlanesArray);
+DefineArrayMethods(RasterColorPlanes, RasterColorPlanesArray);
+DefineArrayMethods(uint32_t, RasterTileBin);
+
+// Depth tested tiles rely on not sharing any depth block with another tile
+_Static_assert(RASTER_TILE_SIZE % RASTER_BLOCK_SIZE == 0, "Tiles must be made of whole depth blocks");
+
+#define DEFAULT_TRIANGLES_CAPACITY 256
+#define DEFAULT_TILE_BIN_CAPACITY 64
+
+RasterBinner* RasterBinnerCreate(uint32_t width, uint32_t height) {
+	RasterBinner* binner = NULL;
+	if (!Malloc(binner, sizeof(RasterBinner))) return NULL;
+
+	*binner = (RasterBinner){.kernel = RASTER_KERNEL_FLAT, .fill = RasterShadeSelectFill(RASTER_KERNEL_FLAT)};
+	binner->tilesX = (width + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+	binner->tilesY = (height + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+
+	binner->triangles = RasterTriangleArrayCreate(DEFAULT_TRIANGLES_CAPACITY);
+	binner->colors = RasterColorArrayCreate(DEFAULT_TRIANGLES_CAPACITY);
+	binner->uvPlanes = RasterUVPlanesArrayCreate(DEFAULT_TRIANGLES_CAPACITY);
+	binner->colorPlanes = RasterColorPlanesArrayCreate(DEFAULT_TRIANGLES_CAPACITY);
+	if (!binner->triangles || !binner->colors || !binner->uvPlanes || !binner->colorPlanes ||
+		!Malloc(binner->tiles, binner->tilesX * binner->tilesY * sizeof(RasterTileBin*))) {
+		RasterBinnerFree(binner);
+		return NULL;
+	}
+
+	for (uint32_t i = 0; i < binner->tilesX * binner->tilesY; i++) {
+		binner->tiles[i] = RasterTileBinCreate(DEFAULT_TILE_BIN_CAPACITY);
+		if (!binner->tiles[i]) {
+			RasterBinnerFree(binner);
+			return NULL;
+		}
+		binner->tilesSize++;
+	}
+
+	return binner;
+}
+
+void RasterBinnerFree(RasterBinner* binner) {
+	if (binner->triangles) RasterTriangleArrayFree(binner->triangles);
+	if (binner->colors) RasterColorArrayFree(binner->colors);
+	if (binner->uvPlanes) RasterUVPlanesArrayFree(binner->uvPlanes);
+	if (binner->colorPlanes) RasterColorPlanesArrayFree(binner->colorPlanes);
+
+	for (uint32_t i = 0; i < binner->tilesSize; i++) {
+		RasterTileBinFree(binner->tiles[i]);
+	}
+	if (binner->tiles) Free(binner->tiles);
+
+	Free(binner);
+}
+
+bool RasterBinnerSetSize(RasterBinner* binner, uint32_t width, uint32_t height) {
+	const uint32_t tilesX = (width + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+	const uint32_t tilesY = (height + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+	if (tilesX * tilesY > binner->tilesSize) return false;
+
+	RasterBinnerReset(binner);
+	binner->tilesX = tilesX;
+	binner->tilesY = tilesY;
+	return true;
+}
+
+void RasterBinnerReset(RasterBinner* binner) {
+	binner->triangles->size = 0;
+	binner->colors->size = 0;
+	binner->uvPlanes->size = 0;
+	binner->colorPlanes->size = 0;
+
+	for (uint32_t i = 0; i < binner->tilesSize; i++) {
+		binner->tiles[i]->size = 0;
+	}
+}
+
+void RasterBinnerSetKernel(RasterBinner* binner, RasterShadeKernel kernel, RasterFillFunc fill, const RasterTexture* texture) {
+	binner->kernel = kernel;
+	binner->fill = fill;
+	binner->texture = texture;
+}
+
+// Drops the last triangle pushed
+static void RasterBinnerPop(RasterBinner* binner) {
+	binner->triangles->size--;
+	binner->colors->size--;
+	if (RasterShadeKernelIsTextured(binner->kernel)) binner->uvPlanes->size--;
+	if (binner->kernel == RASTER_KERNEL_GOURAUD) binner->colorPlanes->size--;
+}
+
+bool RasterBinnerPush(RasterBinner* binner, const RasterTriangle* tri, Color col, const RasterUVPlanes* uv,
+					  const RasterColorPlanes* colorPlanes) {
+	const uint32_t triIndex = binner->triangles->size;
+	if (!RasterTriangleArrayPush(binner->triangles, *tri)) return false;
+	if (!RasterColorArrayPush(binner->colors, col)) {
+		binner->triangles->size--;
+		return false;
+	}
+	if (RasterShadeKernelIsTextured(binner->kernel) && !RasterUVPlanesArrayPush(binner->uvPlanes, *uv)) {
+		binner->triangles->size--;
+		binner->colors->size--;
+		return false;
+	}
+	if (binner->kernel == RASTER_KERNEL_GOURAUD && !RasterColorPlanesArrayPush(binner->colorPlanes, *colorPlanes)) {
+		binner->triangles->size--;
+		binner->colors->size--;
+		return false;
+	}
+
+	const uint32_t minTileX = tri->bounds.minX / RASTER_TILE_SIZE;
+	const uint32_t minTileY = tri->bounds.minY / RASTER_TILE_SIZE;
+	const uint32_t maxTileX = (tri->bounds.maxX - 1) / RASTER_TILE_SIZE;
+	const uint32_t maxTileY = (tri->bounds.maxY - 1) / RASTER_TILE_SIZE;
+
+	for (uint32_t ty = minTileY; ty <= maxTileY; ty++) {
+		for (uint32_t tx = minTileX; tx <= maxTileX; tx++) {
+			RasterTileBin* bin = binner->tiles[Index1D(tx, ty, binner->tilesX)];
+			if (RasterTileBinPush(bin, triIndex)) continue;
+
+			// Undo the partial binning so the triangle is either in all of its tiles or in none
+			for (uint32_t undoY = minTileY; undoY <= ty; undoY++) {
+				const uint32_t undoMaxX = (undoY == ty) ? tx : maxTileX + 1;
+				for (uint32_t undoX = minTileX; undoX < undoMaxX; undoX++) {
+					binner->tiles[Index1D(undoX, undoY, binner->tilesX)]->size--;
+				}
+			}
+			RasterBinnerPop(binner);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+RasterRect RasterBinnerTileRect(const RasterBinner* binner, uint32_t tileIndex) {
+	const int32_t tileX = tileIndex % binner->tilesX;
+	const int32_t tileY = tileIndex / binner->tilesX;
+
+	return (RasterRect){
+		.minX = tileX * RASTER_TILE_SIZE,
+		.minY = tileY * RASTER_TILE_SIZE,
+		.maxX = (tileX + 1) * RASTER_TILE_SIZE,
+		.maxY = (tileY + 1) * RASTER_TILE_SIZE,
+	};
+}
+
+RasterFillCounts RasterBinnerDrawTile(const RasterBinner* binner, uint32_t tileIndex, const RasterFillTarget* target) {
+	const RasterTileBin* bin = binner->tiles[tileIndex];
+	const RasterRect tileRect = RasterBinnerTileRect(binner, tileIndex);
+	RasterFillCounts counts = (RasterFillCounts){0};
+
+	for (size_t i = 0; i < bin->size; i++) {
+		const uint32_t triIndex = bin->data[i];
+
+		RasterTriangle clipped;
+		if (!RasterTriangleClip(binner->triangles->data + triIndex, tileRect, &clipped)) continue;
+		if (target->depth && RasterDepthBufferIsOccluded(target->depth, &clipped)) continue;
+
+		RasterShader shader = (RasterShader){.col = binner->colors->data[triIndex]};
+		if (binner->kernel == RASTER_KERNEL_GOURAUD) {
+			shader.colors = binner->colorPlanes->data + triIndex;
+		} else if (RasterShadeKernelIsTextured(binner->kernel)) {
+			shader.uv = binner->uvPlanes->data + triIndex;
+			shader.level = binner->texture->levels + shader.uv->level;
+		}
+
+		const RasterFillCounts triCounts = binner->fill(target, &clipped, &shader);
+		counts.tested += triCounts.tested;
+		counts.written += triCounts.written;
+	}
+
+	return counts;
+}
@@ -0,0 +1,116 @@
+#include "RasterCull.h"
+
+// Vertices outside of the clip planes were left undivided by the transform stage, the others get their homogeneous
+// coordinates back
+static RasterScreenVertex HomogeneousVertex(const RasterScreenVertex* v, uint16_t outcode) {
+	if (outcode & RASTER_OUT_CLIP_MASK) return *v;
+	return (RasterScreenVertex){v->x * v->w, v->y * v->w, v->z * v->w, v->w};
+}
+
+// Positive inside of the plane, same planes as the transform stage's outcodes
+static float PlaneDistance(const RasterScreenVertex* v, uint16_t plane) {
+	const float guard = RASTER_GUARD_BAND * v->w;
+	switch (plane) {
+		case RASTER_OUT_NEAR:
+			return v->z;
+		case RASTER_OUT_FAR:
+			return v->w - v->z;
+		case RASTER_OUT_GUARD_LEFT:
+			return v->x + guard;
+		case RASTER_OUT_GUARD_RIGHT:
+			return guard - v->x;
+		case RASTER_OUT_GUARD_TOP:
+			return v->y + guard;
+		default:
+			return guard - v->y;
+	}
+}
+
+static RasterScreenVertex Lerp4(const RasterScreenVertex* from, const RasterScreenVertex* to, float t) {
+	return (RasterScreenVertex){
+		.x = from->x + (to->x - from->x) * t,
+		.y = from->y + (to->y - from->y) * t,
+		.z = from->z + (to->z - from->z) * t,
+		.w = from->w + (to->w - from->w) * t,
+	};
+}
+
+// Sutherland-Hodgman, intersections always go from the inside vertex to the outside one so both triangles sharing
+// an edge get the exact same vertex on it
+// Each vertex's weights are interpolated along with it, attributes being linear in clip space
+static uint32_t ClipPolygon(const RasterScreenVertex* in, const Vector3* inWeights, uint32_t inSize, uint16_t plane,
+							RasterScreenVertex* out, Vector3* outWeights) {
+	uint32_t outSize = 0;
+	for (uint32_t i = 0; i < inSize; i++) {
+		const uint32_t next = (i + 1) % inSize;
+		const RasterScreenVertex* from = in + i;
+		const RasterScreenVertex* to = in + next;
+		const float fromDistance = PlaneDistance(from, plane);
+		const float toDistance = PlaneDistance(to, plane);
+
+		if (fromDistance >= 0) {
+			outWeights[outSize] = inWeights[i];
+			out[outSize++] = *from;
+		}
+		if (fromDistance >= 0 && toDistance < 0) {
+			const float t = fromDistance / (fromDistance - toDistance);
+			outWeights[outSize] = Vector3Lerp(inWeights[i], inWeights[next], t);
+			out[outSize++] = Lerp4(from, to, t);
+		}
+		if (fromDistance < 0 && toDistance >= 0) {
+			const float t = toDistance / (toDistance - fromDistance);
+			outWeights[outSize] = Vector3Lerp(inWeights[next], inWeights[i], t);
+			out[outSize++] = Lerp4(to, from, t);
+		}
+	}
+	return outSize;
+}
+
+uint32_t RasterClipTriangle(const RasterScreenVertex* triangle[3], const uint16_t outcodes[3], RasterScreenVertex* polygon,
+							Vector3* weights) {
+	RasterScreenVertex buffers[2][RASTER_CLIP_MAX_VERTICES];
+	Vector3 weightBuffers[2][RASTER_CLIP_MAX_VERTICES];
+	RasterScreenVertex* in = buffers[0];
+	RasterScreenVertex* out = buffers[1];
+	Vector3* inWeights = weightBuffers[0];
+	Vector3* outWeights = weightBuffers[1];
+
+	uint32_t size = 3;
+	for (uint32_t i = 0; i < 3; i++) in[i] = HomogeneousVertex(triangle[i], outcodes[i]);
+	inWeights[0] = (Vector3){1, 0, 0};
+	inWeights[1] = (Vector3){0, 1, 0};
+	inWeights[2] = (Vector3){0, 0, 1};
+
+	const uint16_t planes = (outcodes[0] | outcodes[1] | outcodes[2]) & RASTER_OUT_CLIP_MASK;
+	for (uint16_t plane = RASTER_OUT_NEAR; plane <= RASTER_OUT_GUARD_BOTTOM && size; plane <<= 1) {
+		if (!(planes & plane)) continue;
+
+		size = ClipPolygon(in, inWeights, size, plane, out, outWeights);
+		RasterScreenVertex* swap = in;
+		in = out;
+		out = swap;
+		Vector3* swapWeights = inWeights;
+		inWeights = outWeights;
+		outWeights = swapWeights;
+	}
+	if (size < 3) return 0;
+
+	for (uint32_t i = 0; i < size; i++) {
+		// Only reachable with projections whose near plane doesn't keep w positive
+		if (in[i].w <= 0) return 0;
+		polygon[i] = (RasterScreenVertex){in[i].x / in[i].w, in[i].y / in[i].w, in[i].z / in[i].w, in[i].w};
+	}
+	if (weights) memcpy(weights, inWeights, size * sizeof(Vector3));
+	return size;
+}
+
+// Same sign as EdgeFunction(a, b, c) for triangles
+double RasterPolygonArea(const RasterScreenVertex* polygon, uint32_t size) {
+	double area = 0;
+	for (uint32_t i = 0; i < size; i++) {
+		const RasterScreenVertex* a = polygon + i;
+		const RasterScreenVertex* b = polygon + (i + 1) % size;
+		area += (double)b->x * a->y - (double)a->x * b->y;
+	}
+	return area;
+}
@@ -0,0 +1,285 @@
+#include "RasterDepth.h"
+
+#include "RasterFill.h"
+
+#define DEPTH_UNORM16_MAX 65535.0f
+
+static uint32_t BlocksCount(uint32_t pixelsCount) { return (pixelsCount + RASTER_BLOCK_SIZE - 1) / RASTER_BLOCK_SIZE; }
+
+static size_t DepthValueSize(RasterDepthFormat format) { return (format == RASTER_DEPTH_16) ? sizeof(uint16_t) : sizeof(float); }
+
+#define RasterDepthBufferCreateExitFail()             \
+	{                                                 \
+		if (depth->values) Free(depth->values);       \
+		if (depth->blocksMin) Free(depth->blocksMin); \
+		if (depth->blocksMax) Free(depth->blocksMax); \
+		FreeAndReturn(depth, NULL);                   \
+	}
+
+RasterDepthBuffer* RasterDepthBufferCreate(uint32_t width, uint32_t height, RasterDepthFormat format) {
+	if (format != RASTER_DEPTH_16 && format != RASTER_DEPTH_32F) return NULL;
+
+	RasterDepthBuffer* depth = NULL;
+	if (!Malloc(depth, sizeof(RasterDepthBuffer))) return NULL;
+
+	*depth = (RasterDepthBuffer){
+		.format = format,
+		.width = width,
+		.height = height,
+		.blocksX = BlocksCount(width),
+		.blocksY = BlocksCount(height),
+		.maxWidth = width,
+		.maxHeight = height,
+	};
+
+	const size_t blocksSize = (size_t)depth->blocksX * depth->blocksY;
+	if (!Malloc(depth->values, (size_t)width * height * DepthValueSize(format))) RasterDepthBufferCreateExitFail();
+	if (!Malloc(depth->blocksMin, blocksSize * sizeof(float))) RasterDepthBufferCreateExitFail();
+	if (!Malloc(depth->blocksMax, blocksSize * sizeof(float))) RasterDepthBufferCreateExitFail();
+
+	RasterDepthBufferClear(depth);
+	return depth;
+}
+
+void RasterDepthBufferFree(RasterDepthBuffer* depth) {
+	Free(depth->values);
+	Free(depth->blocksMin);
+	Free(depth->blocksMax);
+	Free(depth);
+}
+
+bool RasterDepthBufferSetSize(RasterDepthBuffer* depth, uint32_t width, uint32_t height) {
+	if (width > depth->maxWidth || height > depth->maxHeight) return false;
+
+	depth->width = width;
+	depth->height = height;
+	depth->blocksX = BlocksCount(width);
+	depth->blocksY = BlocksCount(height);
+	RasterDepthBufferClear(depth);
+	return true;
+}
+
+void RasterDepthBufferClear(RasterDepthBuffer* depth) {
+	RasterDepthBufferClearRect(depth, (RasterRect){.maxX = depth->width, .maxY = depth->height});
+}
+
+static uint32_t FloatBits(float value) {
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+void RasterDepthBufferClearRect(RasterDepthBuffer* depth, RasterRect rect) {
+	if (depth->format == RASTER_DEPTH_16) {
+		// UINT16_MAX is all ones, so each row is a single memset
+		uint16_t* values = depth->values;
+		for (int32_t y = rect.minY; y < rect.maxY; y++) {
+			memset(values + Index1D(rect.minX, y, depth->width), 0xFF, (rect.maxX - rect.minX) * sizeof(uint16_t));
+		}
+	} else {
+		RasterFillRect32(depth->values, depth->width, rect, FloatBits(RASTER_DEPTH_FAR));
+	}
+
+	const RasterRect blocks = (RasterRect){
+		.minX = rect.minX / RASTER_BLOCK_SIZE,
+		.minY = rect.minY / RASTER_BLOCK_SIZE,
+		.maxX = BlocksCount(rect.maxX),
+		.maxY = BlocksCount(rect.maxY),
+	};
+	RasterFillRect32((uint32_t*)depth->blocksMin, depth->blocksX, blocks, FloatBits(RASTER_DEPTH_FAR));
+	RasterFillRect32((uint32_t*)depth->blocksMax, depth->blocksX, blocks, FloatBits(RASTER_DEPTH_FAR));
+}
+
+static inline uint16_t ToUnorm16(float z) { return lrintf(Clamp(z, 0.0f, 1.0f) * DEPTH_UNORM16_MAX); }
+
+// The depth that would be stored for z, so block ranges compare exactly against stored depths in both formats
+static inline float StoredDepth(bool unorm16, float z) { return unorm16 ? ToUnorm16(z) / DEPTH_UNORM16_MAX : z; }
+
+bool RasterDepthBufferIsOccluded(const RasterDepthBuffer* depth, const RasterTriangle* tri) {
+	const float nearest = StoredDepth(depth->format == RASTER_DEPTH_16, tri->depth.min);
+
+	for (int32_t blockY = tri->bounds.minY / RASTER_BLOCK_SIZE; blockY <= (tri->bounds.maxY - 1) / RASTER_BLOCK_SIZE; blockY++) {
+		for (int32_t blockX = tri->bounds.minX / RASTER_BLOCK_SIZE; blockX <= (tri->bounds.maxX - 1) / RASTER_BLOCK_SIZE; blockX++) {
+			if (depth->blocksMax[Index1D(blockX, blockY, depth->blocksX)] > nearest) return false;
+		}
+	}
+	return true;
+}
+
+static RasterRect BlockRect(const RasterDepthBuffer* depth, int32_t blockX, int32_t blockY) {
+	return (RasterRect){
+		.minX = blockX * RASTER_BLOCK_SIZE,
+		.minY = blockY * RASTER_BLOCK_SIZE,
+		.maxX = Min((blockX + 1) * RASTER_BLOCK_SIZE, (int32_t)depth->width),
+		.maxY = Min((blockY + 1) * RASTER_BLOCK_SIZE, (int32_t)depth->height),
+	};
+}
+
+static float StoredDepthAt(const RasterDepthBuffer* depth, size_t index) {
+	if (depth->format == RASTER_DEPTH_16) return ((const uint16_t*)depth->values)[index] / DEPTH_UNORM16_MAX;
+	return ((const float*)depth->values)[index];
+}
+
+// Writes can only bring the farthest depth closer, and it only changes if no pixel is left at the old one
+static void UpdateBlockFarthest(RasterDepthBuffer* depth, int32_t blockX, int32_t blockY) {
+	const uint32_t blockIndex = Index1D(blockX, blockY, depth->blocksX);
+	const RasterRect rect = BlockRect(depth, blockX, blockY);
+
+	const float oldFarthest = depth->blocksMax[blockIndex];
+	float farthest = -INFINITY;
+	for (int32_t y = rect.minY; y < rect.maxY; y++) {
+		for (int32_t x = rect.minX; x < rect.maxX; x++) {
+			farthest = fmaxf(farthest, StoredDepthAt(depth, Index1D(x, y, depth->width)));
+		}
+		if (farthest >= oldFarthest) return;
+	}
+
+	depth->blocksMax[blockIndex] = farthest;
+}
+
+static void UpdateBlockRange(RasterDepthBuffer* depth, int32_t blockX, int32_t blockY, float writtenNearest) {
+	const uint32_t blockIndex = Index1D(blockX, blockY, depth->blocksX);
+	depth->blocksMin[blockIndex] = fminf(depth->blocksMin[blockIndex], writtenNearest);
+	UpdateBlockFarthest(depth, blockX, blockY);
+}
+
+bool RasterDepthBufferTestPixel(RasterDepthBuffer* depth, const RasterDepthPlane* plane, int32_t x, int32_t y, bool store) {
+	const bool unorm16 = depth->format == RASTER_DEPTH_16;
+	const size_t index = Index1D(x, y, depth->width);
+	const float rowDepth = plane->origin + plane->stepY * (y - plane->originY);
+	const float z = Clamp(rowDepth + plane->stepX * (x - plane->originX), plane->min, plane->max);
+
+	if (unorm16) {
+		uint16_t* values = depth->values;
+		const uint16_t value = ToUnorm16(z);
+		if (value >= values[index]) return false;
+		if (store) values[index] = value;
+	} else {
+		float* values = depth->values;
+		if (z >= values[index]) return false;
+		if (store) values[index] = z;
+	}
+
+	if (store) {
+		float* blockMin = depth->blocksMin + Index1D(x / RASTER_BLOCK_SIZE, y / RASTER_BLOCK_SIZE, depth->blocksX);
+		*blockMin = fminf(*blockMin, StoredDepth(unorm16, z));
+	}
+	return true;
+}
+
+void RasterDepthBufferUpdateFarthest(RasterDepthBuffer* depth, RasterRect rect) {
+	for (int32_t blockY = rect.minY / RASTER_BLOCK_SIZE; blockY <= (rect.maxY - 1) / RASTER_BLOCK_SIZE; blockY++) {
+		for (int32_t blockX = rect.minX / RASTER_BLOCK_SIZE; blockX <= (rect.maxX - 1) / RASTER_BLOCK_SIZE; blockX++) {
+			UpdateBlockFarthest(depth, blockX, blockY);
+		}
+	}
+}
+
+// Pixel depths are clamped to the block's range computed from the plane, so the float rounding of the per pixel
+// evaluation can't put them outside of the range used to reject the block
+static inline __attribute__((always_inline)) RasterFillCounts FillDepthBlocks(RasterDepthBuffer* depth, const RasterTriangle* tri,
+																			   const RasterShader* shader, Color* pixels, bool unorm16,
+																			   RasterShadeKernel kernel) {
+	const RasterRect bounds = tri->bounds;
+	const RasterDepthPlane* plane = &tri->depth;
+	RasterFillCounts counts = (RasterFillCounts){0};
+
+	for (int32_t blockY = bounds.minY / RASTER_BLOCK_SIZE; blockY <= (bounds.maxY - 1) / RASTER_BLOCK_SIZE; blockY++) {
+		for (int32_t blockX = bounds.minX / RASTER_BLOCK_SIZE; blockX <= (bounds.maxX - 1) / RASTER_BLOCK_SIZE; blockX++) {
+			const uint32_t blockIndex = Index1D(blockX, blockY, depth->blocksX);
+			const RasterRect blockRect = BlockRect(depth, blockX, blockY);
+			const RasterRect rect = (RasterRect){
+				.minX = Max(blockRect.minX, bounds.minX),
+				.minY = Max(blockRect.minY, bounds.minY),
+				.maxX = Min(blockRect.maxX, bounds.maxX),
+				.maxY = Min(blockRect.maxY, bounds.maxY),
+			};
+
+			const float cornerDepth = plane->origin + plane->stepX * (rect.minX - plane->originX) + plane->stepY * (rect.minY - plane->originY);
+			const float toLastCol = plane->stepX * (rect.maxX - rect.minX - 1);
+			const float toLastRow = plane->stepY * (rect.maxY - rect.minY - 1);
+			const float nearest = fmaxf(cornerDepth + fminf(toLastCol, 0) + fminf(toLastRow, 0), plane->min);
+			const float farthest = fmaxf(fminf(cornerDepth + fmaxf(toLastCol, 0) + fmaxf(toLastRow, 0), plane->max), nearest);
+
+			const float storedNearest = StoredDepth(unorm16, nearest);
+			if (storedNearest >= depth->blocksMax[blockIndex]) continue;
+
+			// When the whole triangle is in front of the block, every covered pixel passes the depth test
+			const bool allNearer = StoredDepth(unorm16, farthest) < depth->blocksMin[blockIndex];
+			bool written = false;
+
+			for (int32_t y = rect.minY; y < rect.maxY; y++) {
+				int32_t spanMinX;
+				int32_t spanMaxX;
+				if (!RasterTriangleRowSpan(tri, y, &spanMinX, &spanMaxX)) continue;
+				spanMinX = Max(spanMinX, rect.minX);
+				spanMaxX = Min(spanMaxX, rect.maxX);
+				counts.tested += Max(spanMaxX - spanMinX, 0);
+
+				const float rowDepth = plane->origin + plane->stepY * (y - plane->originY);
+				Color* row = pixels + Index1D(0, y, depth->width);
+
+				for (int32_t x = spanMinX; x < spanMaxX; x++) {
+					const size_t index = Index1D(x, y, depth->width);
+					const float z = Clamp(rowDepth + plane->stepX * (x - plane->originX), nearest, farthest);
+
+					if (unorm16) {
+						uint16_t* values = depth->values;
+						const uint16_t value = ToUnorm16(z);
+						if (!allNearer && value >= values[index]) continue;
+						values[index] = value;
+					} else {
+						float* values = depth->values;
+						if (!allNearer && z >= values[index]) continue;
+						values[index] = z;
+					}
+
+					if (kernel != RASTER_KERNEL_DEPTH_ONLY) row[x] = RasterShadePixel(shader, kernel, x, y);
+					counts.written++;
+					written = true;
+				}
+			}
+
+			if (written) UpdateBlockRange(depth, blockX, blockY, storedNearest);
+		}
+	}
+
+	return counts;
+}
+
+// The stride is always the depth buffer's width
+#define DefineFillDepthBlocks(name, unorm16, kernel)                                                                      \
+	static RasterFillCounts name(const RasterFillTarget* target, const RasterTriangle* tri, const RasterShader* shader) { \
+		return FillDepthBlocks(target->depth, tri, shader, target->pixels, unorm16, kernel);                              \
+	}
+
+#define DefineFillDepthKernel(name, kernel)        \
+	DefineFillDepthBlocks(name##16, true, kernel); \
+	DefineFillDepthBlocks(name##32F, false, kernel)
+
+DefineFillDepthKernel(FillDepthFlat, RASTER_KERNEL_FLAT);
+DefineFillDepthKernel(FillDepthGouraud, RASTER_KERNEL_GOURAUD);
+DefineFillDepthKernel(FillDepthNearest, RASTER_KERNEL_NEAREST);
+DefineFillDepthKernel(FillDepthBilinear, RASTER_KERNEL_BILINEAR);
+DefineFillDepthKernel(FillDepthOnly, RASTER_KERNEL_DEPTH_ONLY);
+
+RasterFillFunc RasterDepthBufferSelectFill(RasterDepthFormat format, RasterShadeKernel kernel) {
+	static const RasterFillFunc fills16[RASTER_KERNEL_COUNT] = {
+		[RASTER_KERNEL_FLAT] = FillDepthFlat16,
+		[RASTER_KERNEL_GOURAUD] = FillDepthGouraud16,
+		[RASTER_KERNEL_NEAREST] = FillDepthNearest16,
+		[RASTER_KERNEL_BILINEAR] = FillDepthBilinear16,
+		[RASTER_KERNEL_DEPTH_ONLY] = FillDepthOnly16,
+	};
+	static const RasterFillFunc fills32F[RASTER_KERNEL_COUNT] = {
+		[RASTER_KERNEL_FLAT] = FillDepthFlat32F,
+		[RASTER_KERNEL_GOURAUD] = FillDepthGouraud32F,
+		[RASTER_KERNEL_NEAREST] = FillDepthNearest32F,
+		[RASTER_KERNEL_BILINEAR] = FillDepthBilinear32F,
+		[RASTER_KERNEL_DEPTH_ONLY] = FillDepthOnly32F,
+	};
+
+	if (format == RASTER_DEPTH_16) return fills16[kernel];
+	if (format == RASTER_DEPTH_32F) return fills32F[kernel];
+	return RasterShadeSelectFill(kernel);
+}
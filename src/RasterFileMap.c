@@ -0,0 +1,125 @@
+#define _POSIX_C_SOURCE 200809L	 // mmap, fstat
+
+#include "RasterFileMap.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define RASTER_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define RASTER_HAS_MMAP 0
+#endif
+
+#if RASTER_HAS_MMAP
+
+bool RasterFileStat(const char* path, uint64_t* size, int64_t* modificationTime) {
+	struct stat fileStat;
+	if (stat(path, &fileStat) || !S_ISREG(fileStat.st_mode)) return false;
+
+	// Whole seconds would miss an edit made within the same second as the previous one
+#ifdef __APPLE__
+	const struct timespec modified = fileStat.st_mtimespec;
+#else
+	const struct timespec modified = fileStat.st_mtim;
+#endif
+	*size = fileStat.st_size;
+	*modificationTime = (int64_t)modified.tv_sec * 1000000000 + modified.tv_nsec;
+	return true;
+}
+
+bool RasterFileMapOpen(RasterFileMap* map, const char* path) {
+	*map = (RasterFileMap){0};
+
+	const int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		LogMessage("Could not open \"%s\"\n", path);
+		return false;
+	}
+
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) || !S_ISREG(fileStat.st_mode)) {
+		LogMessage("Could not stat \"%s\" (or it isn't a regular file)\n", path);
+		close(fd);
+		return false;
+	}
+
+	map->size = fileStat.st_size;
+	if (!map->size) {
+		close(fd);
+		return true;
+	}
+
+	void* data = mmap(NULL, map->size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		LogMessage("Could not map \"%s\"\n", path);
+		return false;
+	}
+	posix_madvise(data, map->size, POSIX_MADV_SEQUENTIAL);
+
+	map->data = data;
+	map->mapped = true;
+	return true;
+}
+
+void RasterFileMapClose(RasterFileMap* map) {
+	char* data = (char*)map->data;
+	if (map->mapped) munmap(data, map->size);
+	else if (data) Free(data);
+	*map = (RasterFileMap){0};
+}
+
+#else
+
+bool RasterFileStat(const char* path, uint64_t* size, int64_t* modificationTime) {
+	(void)path;
+	(void)size;
+	(void)modificationTime;
+	return false;
+}
+
+bool RasterFileMapOpen(RasterFileMap* map, const char* path) {
+	*map = (RasterFileMap){0};
+
+	FILE* file = TryOpenFile(path, "rb");
+	if (!file) return false;
+
+	long fileSize = -1;
+	if (!fseek(file, 0, SEEK_END)) fileSize = ftell(file);
+	if (fileSize < 0 || fseek(file, 0, SEEK_SET)) {
+		CloseFile(file);
+		return false;
+	}
+
+	map->size = fileSize;
+	if (!map->size) {
+		CloseFile(file);
+		return true;
+	}
+
+	char* data = NULL;
+	if (!Malloc(data, map->size)) {
+		CloseFile(file);
+		return false;
+	}
+
+	if (fread(data, 1, map->size, file) != map->size) {
+		Free(data);
+		CloseFile(file);
+		return false;
+	}
+	CloseFile(file);
+
+	map->data = data;
+	return true;
+}
+
+void RasterFileMapClose(RasterFileMap* map) {
+	char* data = (char*)map->data;
+	if (data) Free(data);
+	*map = (RasterFileMap){0};
+}
+
+#endif	// RASTER_HAS_MMAP
@@ -0,0 +1,78 @@
+#include "RasterFill.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define RASTER_X86_KERNELS 1
+#include <immintrin.h>
+#else
+#define RASTER_X86_KERNELS 0
+#endif
+
+typedef void (*FillFunc)(uint32_t* data, size_t count, uint32_t value);
+
+static bool HasUniformBytes(uint32_t value) { return value == (value & 0xFF) * 0x01010101u; }
+
+static void FillMemset(uint32_t* data, size_t count, uint32_t value) { memset(data, value & 0xFF, count * sizeof(uint32_t)); }
+
+static void FillScalar(uint32_t* data, size_t count, uint32_t value) {
+	for (size_t i = 0; i < count; i++) data[i] = value;
+}
+
+#if RASTER_X86_KERNELS
+__attribute__((target("sse2"))) static void FillSSE2(uint32_t* data, size_t count, uint32_t value) {
+	const __m128i values = _mm_set1_epi32(value);
+
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16) {
+		_mm_storeu_si128((__m128i*)(data + i), values);
+		_mm_storeu_si128((__m128i*)(data + i + 4), values);
+		_mm_storeu_si128((__m128i*)(data + i + 8), values);
+		_mm_storeu_si128((__m128i*)(data + i + 12), values);
+	}
+	for (; i + 4 <= count; i += 4) _mm_storeu_si128((__m128i*)(data + i), values);
+	FillScalar(data + i, count - i, value);
+}
+
+__attribute__((target("avx"))) static void FillAVX(uint32_t* data, size_t count, uint32_t value) {
+	const __m256i values = _mm256_set1_epi32(value);
+
+	size_t i = 0;
+	for (; i + 32 <= count; i += 32) {
+		_mm256_storeu_si256((__m256i*)(data + i), values);
+		_mm256_storeu_si256((__m256i*)(data + i + 8), values);
+		_mm256_storeu_si256((__m256i*)(data + i + 16), values);
+		_mm256_storeu_si256((__m256i*)(data + i + 24), values);
+	}
+	for (; i + 8 <= count; i += 8) _mm256_storeu_si256((__m256i*)(data + i), values);
+	FillScalar(data + i, count - i, value);
+}
+#endif
+
+static FillFunc GetFill(uint32_t value) {
+	if (HasUniformBytes(value)) return FillMemset;
+
+#if RASTER_X86_KERNELS
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx")) return FillAVX;
+	if (__builtin_cpu_supports("sse2")) return FillSSE2;
+#endif
+	return FillScalar;
+}
+
+void RasterFill32(uint32_t* data, size_t count, uint32_t value) { GetFill(value)(data, count, value); }
+
+void RasterFillRect32(uint32_t* data, uint32_t stride, RasterRect rect, uint32_t value) {
+	if (rect.minX >= rect.maxX) return;
+
+	const FillFunc fill = GetFill(value);
+	const size_t width = rect.maxX - rect.minX;
+
+	// Rects spanning whole rows are a single contiguous fill
+	if (width == stride) {
+		fill(data + (size_t)rect.minY * stride, width * (rect.maxY - rect.minY), value);
+		return;
+	}
+
+	for (int32_t y = rect.minY; y < rect.maxY; y++) {
+		fill(data + Index1D(rect.minX, y, stride), width, value);
+	}
+}
@@ -0,0 +1,280 @@
+#include "RasterFrameWriter.h"
+
+#include <stdio.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define RASTER_X86_KERNELS 1
+#include <immintrin.h>
+#else
+#define RASTER_X86_KERNELS 0
+#endif
+
+#define BMP_FILE_HEADER_SIZE 14
+#define BMP_INFO_HEADER_SIZE 40
+#define BMP_HEADERS_SIZE (BMP_FILE_HEADER_SIZE + BMP_INFO_HEADER_SIZE)
+#define BMP_PLANES 1
+#define BMP_BPP 24
+
+// ============= Encoding =============
+
+static uint32_t BMPRowPixelSize(uint32_t width) { return width * 3; }
+
+static uint32_t BMPRowSize(uint32_t width) { return (BMPRowPixelSize(width) + 3) & -4; }
+
+size_t RasterBMPSize(uint32_t width, uint32_t height) { return BMP_HEADERS_SIZE + (size_t)BMPRowSize(width) * height; }
+
+// Little endian, whatever the host's endianness
+static uint8_t* PutUInt16(uint8_t* data, uint16_t value) {
+	data[0] = value & 0xFF;
+	data[1] = value >> 8;
+	return data + 2;
+}
+
+static uint8_t* PutUInt32(uint8_t* data, uint32_t value) {
+	data = PutUInt16(data, value & 0xFFFF);
+	return PutUInt16(data, value >> 16);
+}
+
+static void EncodeBMPHeaders(uint8_t* data, uint32_t width, uint32_t height) {
+	*data++ = 'B';
+	*data++ = 'M';
+	data = PutUInt32(data, RasterBMPSize(width, height));
+	data = PutUInt32(data, 0);
+	data = PutUInt32(data, BMP_HEADERS_SIZE);
+
+	data = PutUInt32(data, BMP_INFO_HEADER_SIZE);
+	data = PutUInt32(data, width);
+	data = PutUInt32(data, height);
+	data = PutUInt16(data, BMP_PLANES);
+	data = PutUInt16(data, BMP_BPP);
+	for (uint32_t i = 0; i < 6; i++) data = PutUInt32(data, 0);
+}
+
+typedef void (*PackPixelsFunc)(const Color* pixels, size_t count, bool bgr, uint8_t* out);
+
+static void PackPixelsScalar(const Color* pixels, size_t count, bool bgr, uint8_t* out) {
+	for (size_t i = 0; i < count; i++) {
+		out[i * 3 + 0] = bgr ? pixels[i].b : pixels[i].r;
+		out[i * 3 + 1] = pixels[i].g;
+		out[i * 3 + 2] = bgr ? pixels[i].r : pixels[i].b;
+	}
+}
+
+#if RASTER_X86_KERNELS
+// 4 pixels per shuffle, each 16 bytes store spills 4 bytes over the next pixels, so the loop stops 2 pixels early to
+// never write past the output
+__attribute__((target("ssse3"))) static void PackPixelsSSSE3(const Color* pixels, size_t count, bool bgr, uint8_t* out) {
+	const __m128i toBGR = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+	const __m128i toRGB = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+	const __m128i order = bgr ? toBGR : toRGB;
+
+	size_t i = 0;
+	for (; i + 6 <= count; i += 4) {
+		const __m128i rgba = _mm_loadu_si128((const __m128i*)(pixels + i));
+		_mm_storeu_si128((__m128i*)(out + i * 3), _mm_shuffle_epi8(rgba, order));
+	}
+	PackPixelsScalar(pixels + i, count - i, bgr, out + i * 3);
+}
+#endif
+
+static PackPixelsFunc GetPackPixels(void) {
+#if RASTER_X86_KERNELS
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("ssse3")) return PackPixelsSSSE3;
+#endif
+	return PackPixelsScalar;
+}
+
+void RasterPackPixels24(const Color* pixels, size_t count, bool bgr, uint8_t* out) { GetPackPixels()(pixels, count, bgr, out); }
+
+void RasterEncodeBMP(const Color* pixels, uint32_t width, uint32_t height, uint8_t* data) {
+	const PackPixelsFunc packPixels = GetPackPixels();
+	const uint32_t rowPixelSize = BMPRowPixelSize(width);
+	const uint32_t rowSize = BMPRowSize(width);
+
+	EncodeBMPHeaders(data, width, height);
+
+	uint8_t* row = data + BMP_HEADERS_SIZE;
+	for (int32_t y = height - 1; y >= 0; y--) {
+		packPixels(pixels + (size_t)y * width, width, true, row);
+		memset(row + rowPixelSize, 0, rowSize - rowPixelSize);
+		row += rowSize;
+	}
+}
+
+static bool WriteFile(const char* path, const uint8_t* data, size_t size) {
+	FILE* file = TryOpenFile(path, "wb");
+	if (!file) return false;
+
+	bool success = fwrite(data, 1, size, file) == size;
+	success = (fflush(file) == 0) && success;
+	CloseFile(file);
+	return success;
+}
+
+bool RasterWriteBMP(const char* path, const Color* pixels, uint32_t width, uint32_t height) {
+	const size_t size = RasterBMPSize(width, height);
+
+	uint8_t* data = NULL;
+	if (!Malloc(data, size)) return false;
+
+	RasterEncodeBMP(pixels, width, height, data);
+	const bool success = WriteFile(path, data, size);
+	FreeAndReturn(data, success);
+}
+
+// ============= Asynchronous writer =============
+
+// The encoded frame buffer is kept between frames, and only grows
+static bool WriteSlotBMP(RasterFrameWriter* writer, const RasterFrameSlot* slot) {
+	const size_t size = RasterBMPSize(slot->width, slot->height);
+	if (size > writer->encodedCapacity) {
+		if (writer->encoded) Free(writer->encoded);
+		writer->encodedCapacity = 0;
+
+		if (!Malloc(writer->encoded, size)) return false;
+		writer->encodedCapacity = size;
+	}
+
+	RasterEncodeBMP(slot->pixels, slot->width, slot->height, writer->encoded);
+	if (WriteFile(slot->path, writer->encoded, size)) return true;
+
+	LogMessage("Could not write the frame \"%s\"\n", slot->path);
+	return false;
+}
+
+static bool WriteSlot(RasterFrameWriter* writer, const RasterFrameSlot* slot) {
+	if (writer->func) return writer->func(writer->userData, slot);
+	return WriteSlotBMP(writer, slot);
+}
+
+static void* WriterMain(void* userData) {
+	RasterFrameWriter* writer = userData;
+
+	pthread_mutex_lock(&writer->mutex);
+	while (true) {
+		while (!writer->queued && !writer->stopping) {
+			pthread_cond_wait(&writer->queuedCond, &writer->mutex);
+		}
+		if (!writer->queued) break;
+
+		// The slot stays queued while it is written, so RasterFrameWriterQueue can't reuse it
+		RasterFrameSlot* slot = writer->slots + writer->nextSlot;
+		pthread_mutex_unlock(&writer->mutex);
+
+		const bool success = WriteSlot(writer, slot);
+		if (slot->path) Free(slot->path);
+
+		pthread_mutex_lock(&writer->mutex);
+		if (!success) writer->failedCount++;
+		writer->nextSlot = (writer->nextSlot + 1) % writer->slotsSize;
+		writer->queued--;
+		pthread_cond_broadcast(&writer->writtenCond);
+	}
+	pthread_mutex_unlock(&writer->mutex);
+
+	return NULL;
+}
+
+static void FreeSlots(RasterFrameWriter* writer) {
+	for (uint32_t i = 0; i < writer->slotsSize; i++) {
+		if (writer->slots[i].pixels) Free(writer->slots[i].pixels);
+	}
+	Free(writer->slots);
+}
+
+RasterFrameWriter* RasterFrameWriterCreate(uint32_t queueDepth) { return RasterFrameWriterCreateEx(queueDepth, NULL, NULL); }
+
+RasterFrameWriter* RasterFrameWriterCreateEx(uint32_t queueDepth, RasterFrameWriteFunc func, void* userData) {
+	if (!queueDepth) return NULL;
+
+	RasterFrameWriter* writer = NULL;
+	if (!Malloc(writer, sizeof(RasterFrameWriter))) return NULL;
+	*writer = (RasterFrameWriter){.slotsSize = queueDepth, .func = func, .userData = userData};
+
+	if (!Malloc(writer->slots, queueDepth * sizeof(RasterFrameSlot))) FreeAndReturn(writer, NULL);
+	for (uint32_t i = 0; i < queueDepth; i++) writer->slots[i] = (RasterFrameSlot){0};
+
+	pthread_mutex_init(&writer->mutex, NULL);
+	pthread_cond_init(&writer->queuedCond, NULL);
+	pthread_cond_init(&writer->writtenCond, NULL);
+
+	if (pthread_create(&writer->thread, NULL, WriterMain, writer)) {
+		pthread_cond_destroy(&writer->writtenCond);
+		pthread_cond_destroy(&writer->queuedCond);
+		pthread_mutex_destroy(&writer->mutex);
+		FreeSlots(writer);
+		FreeAndReturn(writer, NULL);
+	}
+
+	return writer;
+}
+
+void RasterFrameWriterFree(RasterFrameWriter* writer) {
+	pthread_mutex_lock(&writer->mutex);
+	writer->stopping = true;
+	pthread_cond_signal(&writer->queuedCond);
+	pthread_mutex_unlock(&writer->mutex);
+	pthread_join(writer->thread, NULL);
+
+	pthread_cond_destroy(&writer->writtenCond);
+	pthread_cond_destroy(&writer->queuedCond);
+	pthread_mutex_destroy(&writer->mutex);
+
+	FreeSlots(writer);
+	if (writer->encoded) Free(writer->encoded);
+	Free(writer);
+}
+
+uint32_t RasterFrameWriterQueueDepth(const RasterFrameWriter* writer) { return writer->slotsSize; }
+
+// Only touched by the queuing thread until it is queued, the slot's pixels buffer only grows
+static bool FillSlot(RasterFrameSlot* slot, const char* path, const Color* pixels, uint32_t width, uint32_t height) {
+	const size_t pixelsCount = (size_t)width * height;
+	if (pixelsCount > slot->pixelsCapacity) {
+		if (slot->pixels) Free(slot->pixels);
+		slot->pixelsCapacity = 0;
+
+		if (!Malloc(slot->pixels, pixelsCount * sizeof(Color))) return false;
+		slot->pixelsCapacity = pixelsCount;
+	}
+
+	if (path) {
+		if (!Malloc(slot->path, strlen(path) + 1)) return false;
+		strcpy(slot->path, path);
+	}
+
+	memcpy(slot->pixels, pixels, pixelsCount * sizeof(Color));
+	slot->width = width;
+	slot->height = height;
+	return true;
+}
+
+bool RasterFrameWriterQueue(RasterFrameWriter* writer, const char* path, const Color* pixels, uint32_t width, uint32_t height) {
+	pthread_mutex_lock(&writer->mutex);
+	while (writer->queued == writer->slotsSize) {
+		pthread_cond_wait(&writer->writtenCond, &writer->mutex);
+	}
+	RasterFrameSlot* slot = writer->slots + (writer->nextSlot + writer->queued) % writer->slotsSize;
+	pthread_mutex_unlock(&writer->mutex);
+
+	if (!FillSlot(slot, path, pixels, width, height)) return false;
+
+	pthread_mutex_lock(&writer->mutex);
+	writer->queued++;
+	pthread_cond_signal(&writer->queuedCond);
+	pthread_mutex_unlock(&writer->mutex);
+	return true;
+}
+
+bool RasterFrameWriterFlush(RasterFrameWriter* writer) {
+	pthread_mutex_lock(&writer->mutex);
+	while (writer->queued) {
+		pthread_cond_wait(&writer->writtenCond, &writer->mutex);
+	}
+	const bool success = !writer->failedCount;
+	writer->failedCount = 0;
+	pthread_mutex_unlock(&writer->mutex);
+
+	return success;
+}
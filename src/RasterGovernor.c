@@ -0,0 +1,51 @@
+#include "RasterGovernor.h"
+
+// Of each new frame time in the average
+#define AVERAGE_WEIGHT 0.2
+// Averaged after each change before the next one, so the average only holds frames drawn at the current scale
+#define SETTLE_FRAMES 8
+// Scaling down aims that far under the target frame time
+#define DOWNSCALE_HEADROOM 0.9
+// Scaling up takes frames under that share of the target frame time, and grows the pixels by UPSCALE_FACTOR squared
+// (1.21), so the next frames stay under the target and aren't scaled right back down
+#define UPSCALE_THRESHOLD 0.75
+#define UPSCALE_FACTOR 1.1f
+
+void RasterGovernorInit(RasterGovernor* governor, double targetFrameNs, float minScale) {
+	*governor = (RasterGovernor){
+		.targetFrameNs = targetFrameNs,
+		.minScale = Clamp(minScale, 0.0f, 1.0f),
+		.scale = 1.0f,
+	};
+}
+
+// Drawing time mostly grows with the pixels, so with the square of the scale
+static float NextScale(const RasterGovernor* governor) {
+	float scale = governor->scale;
+	if (governor->averageNs > governor->targetFrameNs) {
+		scale *= sqrt(governor->targetFrameNs * DOWNSCALE_HEADROOM / governor->averageNs);
+	} else if (governor->averageNs < governor->targetFrameNs * UPSCALE_THRESHOLD) {
+		scale *= UPSCALE_FACTOR;
+	}
+	return Clamp(scale, governor->minScale, 1.0f);
+}
+
+bool RasterGovernorUpdate(RasterGovernor* governor, RasterTarget* screen, double frameNs) {
+	governor->averageNs = governor->framesSinceChange ? governor->averageNs + (frameNs - governor->averageNs) * AVERAGE_WEIGHT : frameNs;
+	governor->framesSinceChange++;
+
+	bool changed = false;
+	if (governor->framesSinceChange >= SETTLE_FRAMES) {
+		const float scale = NextScale(governor);
+		changed = scale != governor->scale;
+		if (changed) {
+			governor->scale = scale;
+			governor->framesSinceChange = 0;
+		}
+	}
+
+	const uint32_t width = Max(lrintf(screen->maxWidth * governor->scale), 1L);
+	const uint32_t height = Max(lrintf(screen->maxHeight * governor->scale), 1L);
+	RasterTargetSetViewport(screen, width, height);
+	return changed;
+}
@@ -0,0 +1,246 @@
+#include "RasterMeshlet.h"
+
+// Every meshlet but the last one is closed either full of triangles, or once it has more than
+// RASTER_MESHLET_MAX_VERTICES - 3 vertices, so at least a third of that many triangles
+#define MIN_FULL_MESHLET_TRIANGLES ((RASTER_MESHLET_MAX_VERTICES - 3) / 3)
+
+#define MORTON_BITS 10
+
+static size_t MaxMeshlets(size_t trianglesSize) { return trianglesSize / MIN_FULL_MESHLET_TRIANGLES + 1; }
+
+static size_t MaxPartitionVertices(size_t trianglesSize) {
+	return Min(trianglesSize * 3, MaxMeshlets(trianglesSize) * RASTER_MESHLET_MAX_VERTICES);
+}
+
+size_t RasterMeshletPartitionScratchSize(size_t verticesSize, size_t trianglesSize) {
+	return RasterArenaAlignedSize(MaxMeshlets(trianglesSize) * sizeof(RasterMeshlet)) +
+		   RasterArenaAlignedSize(MaxPartitionVertices(trianglesSize) * sizeof(uint32_t)) +
+		   RasterArenaAlignedSize(trianglesSize * 3 * sizeof(uint32_t)) + RasterArenaAlignedSize(trianglesSize * sizeof(uint64_t)) +
+		   2 * RasterArenaAlignedSize(verticesSize * sizeof(uint32_t));
+}
+
+// Spreads the low MORTON_BITS bits of x two bits apart
+static uint32_t SpreadBits(uint32_t x) {
+	x &= 0x3FF;
+	x = (x | (x << 16)) & 0x030000FF;
+	x = (x | (x << 8)) & 0x0300F00F;
+	x = (x | (x << 4)) & 0x030C30C3;
+	x = (x | (x << 2)) & 0x09249249;
+	return x;
+}
+
+static uint32_t QuantizeAxis(float value, float min, float scale) {
+	const float quantized = (value - min) * scale;
+	if (!(quantized > 0)) return 0;
+	return Min((uint32_t)quantized, (uint32_t)(1 << MORTON_BITS) - 1);
+}
+
+static int CompareSortKeys(const void* a, const void* b) {
+	const uint64_t keyA = *(const uint64_t*)a;
+	const uint64_t keyB = *(const uint64_t*)b;
+	return (keyA > keyB) - (keyA < keyB);
+}
+
+// Morton code of each triangle's centroid in the high bits, its index in the low ones
+static void SortTriangles(const Vector3* positions, size_t verticesSize, const uint32_t* indices, size_t trianglesSize,
+						  uint64_t* sortKeys) {
+	Vector3 min = verticesSize ? positions[0] : (Vector3){0};
+	Vector3 max = min;
+	for (size_t i = 1; i < verticesSize; i++) {
+		min = Vector3Min(min, positions[i]);
+		max = Vector3Max(max, positions[i]);
+	}
+
+	const Vector3 extent = Vector3Subtract(max, min);
+	const float maxQuantized = (1 << MORTON_BITS) - 1;
+	const Vector3 scale = (Vector3){
+		(extent.x > 0) ? maxQuantized / extent.x : 0,
+		(extent.y > 0) ? maxQuantized / extent.y : 0,
+		(extent.z > 0) ? maxQuantized / extent.z : 0,
+	};
+
+	for (size_t i = 0; i < trianglesSize; i++) {
+		const uint32_t* triangle = indices + i * 3;
+		const Vector3 centroid =
+			Vector3Scale(Vector3Add(Vector3Add(positions[triangle[0]], positions[triangle[1]]), positions[triangle[2]]), 1.0f / 3.0f);
+		const uint32_t code = SpreadBits(QuantizeAxis(centroid.x, min.x, scale.x)) |
+							  (SpreadBits(QuantizeAxis(centroid.y, min.y, scale.y)) << 1) |
+							  (SpreadBits(QuantizeAxis(centroid.z, min.z, scale.z)) << 2);
+		sortKeys[i] = ((uint64_t)code << 32) | i;
+	}
+
+	qsort(sortKeys, trianglesSize, sizeof(uint64_t), CompareSortKeys);
+}
+
+// Vertices of the triangle not in the meshlet yet, a vertex used twice by the triangle only counting once
+static uint32_t CountNewVertices(const uint32_t triangle[3], const uint32_t* vertexMeshlets, uint32_t meshletIndex) {
+	uint32_t count = 0;
+	for (uint32_t i = 0; i < 3; i++) {
+		const bool repeated = (i > 0 && triangle[i] == triangle[0]) || (i > 1 && triangle[i] == triangle[1]);
+		if (!repeated && vertexMeshlets[triangle[i]] != meshletIndex) count++;
+	}
+	return count;
+}
+
+static void ComputeBounds(RasterMeshlet* meshlet, const Vector3* positions, const uint32_t* vertices) {
+	Vector3 min = positions[vertices[meshlet->firstVertex]];
+	Vector3 max = min;
+	for (uint32_t i = 1; i < meshlet->verticesCount; i++) {
+		min = Vector3Min(min, positions[vertices[meshlet->firstVertex + i]]);
+		max = Vector3Max(max, positions[vertices[meshlet->firstVertex + i]]);
+	}
+
+	meshlet->center = Vector3Scale(Vector3Add(min, max), 0.5f);
+	float radiusSquared = 0;
+	for (uint32_t i = 0; i < meshlet->verticesCount; i++) {
+		const Vector3 offset = Vector3Subtract(positions[vertices[meshlet->firstVertex + i]], meshlet->center);
+		radiusSquared = fmaxf(radiusSquared, Vector3DotProduct(offset, offset));
+	}
+	meshlet->radius = sqrtf(radiusSquared);
+}
+
+static Vector3 TriangleNormal(const Vector3* positions, const uint32_t* vertices, const uint32_t* triangle) {
+	const Vector3 a = positions[vertices[triangle[0]]];
+	const Vector3 b = positions[vertices[triangle[1]]];
+	const Vector3 c = positions[vertices[triangle[2]]];
+	return Vector3CrossProduct(Vector3Subtract(b, a), Vector3Subtract(c, a));
+}
+
+// The axis is the average of the triangles' unit normals, degenerate triangles have none and are left out
+static void ComputeCone(RasterMeshlet* meshlet, const Vector3* positions, const uint32_t* vertices, const uint32_t* indices) {
+	const uint32_t* triangles = indices + (size_t)meshlet->firstTriangle * 3;
+
+	Vector3 axis = (Vector3){0};
+	for (uint32_t i = 0; i < meshlet->trianglesCount; i++) {
+		const Vector3 normal = TriangleNormal(positions, vertices, triangles + i * 3);
+		const float length = Vector3Length(normal);
+		if (length > 0) axis = Vector3Add(axis, Vector3Scale(normal, 1.0f / length));
+	}
+
+	meshlet->coneAxis = (Vector3){0};
+	meshlet->coneCos = 0;
+	meshlet->coneSin = 1;
+
+	const float axisLength = Vector3Length(axis);
+	if (!(axisLength > 0)) return;
+	axis = Vector3Scale(axis, 1.0f / axisLength);
+
+	float minCos = 1;
+	for (uint32_t i = 0; i < meshlet->trianglesCount; i++) {
+		const Vector3 normal = TriangleNormal(positions, vertices, triangles + i * 3);
+		const float length = Vector3Length(normal);
+		if (length > 0) minCos = fminf(minCos, Vector3DotProduct(normal, axis) / length);
+	}
+
+	meshlet->coneAxis = axis;
+	if (minCos <= 0) return;
+	meshlet->coneCos = fminf(minCos, 1.0f);
+	meshlet->coneSin = sqrtf(1.0f - meshlet->coneCos * meshlet->coneCos);
+}
+
+#define RasterMeshletPartitionBuildExitFail() \
+	{                                         \
+		RasterArenaRewind(arena, outputMark); \
+		return false;                         \
+	}
+
+// Greedy, triangles are added in the sorted order to the last meshlet until it can't hold the next one
+bool RasterMeshletPartitionBuild(RasterMeshletPartition* partition, const Vector3* positions, size_t verticesSize,
+								 const uint32_t* indices, size_t trianglesSize, RasterArena* arena) {
+	const RasterArenaMark outputMark = RasterArenaGetMark(arena);
+	*partition = (RasterMeshletPartition){
+		.meshlets = RasterArenaAllocArray(arena, MaxMeshlets(trianglesSize), sizeof(RasterMeshlet)),
+		.vertices = RasterArenaAllocArray(arena, MaxPartitionVertices(trianglesSize), sizeof(uint32_t)),
+		.indices = RasterArenaAllocArray(arena, trianglesSize * 3, sizeof(uint32_t)),
+	};
+	if (!partition->meshlets || !partition->vertices || !partition->indices) RasterMeshletPartitionBuildExitFail();
+
+	const RasterArenaMark tempMark = RasterArenaGetMark(arena);
+	uint64_t* sortKeys = RasterArenaAllocArray(arena, trianglesSize, sizeof(uint64_t));
+	uint32_t* vertexMeshlets = RasterArenaAllocArray(arena, verticesSize, sizeof(uint32_t));  // Last meshlet using the vertex
+	uint32_t* vertexLocations = RasterArenaAllocArray(arena, verticesSize, sizeof(uint32_t));  // Its partition vertex there
+	if (!sortKeys || !vertexMeshlets || !vertexLocations) RasterMeshletPartitionBuildExitFail();
+
+	memset(vertexMeshlets, 0xFF, verticesSize * sizeof(uint32_t));
+	SortTriangles(positions, verticesSize, indices, trianglesSize, sortKeys);
+
+	RasterMeshlet* meshlet = NULL;
+	for (size_t i = 0; i < trianglesSize; i++) {
+		const uint32_t* triangle = indices + (sortKeys[i] & UINT32_MAX) * 3;
+
+		const uint32_t meshletIndex = partition->meshletsSize - 1;
+		if (!meshlet || meshlet->trianglesCount == RASTER_MESHLET_MAX_TRIANGLES ||
+			meshlet->verticesCount + CountNewVertices(triangle, vertexMeshlets, meshletIndex) > RASTER_MESHLET_MAX_VERTICES) {
+			meshlet = partition->meshlets + partition->meshletsSize++;
+			*meshlet = (RasterMeshlet){.firstTriangle = i, .firstVertex = partition->verticesSize};
+		}
+
+		for (uint32_t j = 0; j < 3; j++) {
+			const uint32_t vertex = triangle[j];
+			if (vertexMeshlets[vertex] != partition->meshletsSize - 1) {
+				vertexMeshlets[vertex] = partition->meshletsSize - 1;
+				vertexLocations[vertex] = partition->verticesSize;
+				partition->vertices[partition->verticesSize++] = vertex;
+				meshlet->verticesCount++;
+			}
+			partition->indices[i * 3 + j] = vertexLocations[vertex];
+		}
+		meshlet->trianglesCount++;
+	}
+
+	RasterArenaRewind(arena, tempMark);
+
+	for (size_t i = 0; i < partition->meshletsSize; i++) {
+		ComputeBounds(partition->meshlets + i, positions, partition->vertices);
+		ComputeCone(partition->meshlets + i, positions, partition->vertices, partition->indices);
+	}
+	return true;
+}
+
+// ============= Culling =============
+
+// Determinant of the 3x3 matrix of a, b and c's components other than the skipped one
+static float Minor(const float a[4], const float b[4], const float c[4], uint32_t skipped) {
+	uint32_t columns[3];
+	for (uint32_t i = 0, j = 0; i < 4; i++) {
+		if (i != skipped) columns[j++] = i;
+	}
+
+	return a[columns[0]] * (b[columns[1]] * c[columns[2]] - b[columns[2]] * c[columns[1]]) -
+		   a[columns[1]] * (b[columns[0]] * c[columns[2]] - b[columns[2]] * c[columns[0]]) +
+		   a[columns[2]] * (b[columns[0]] * c[columns[1]] - b[columns[1]] * c[columns[0]]);
+}
+
+// The point every clip space x, y and w row is 0 for, the generalized cross product of those rows
+// A triangle's winding on the screen is then the sign of its plane's dot product with it, whatever the projection
+RasterMeshletView RasterMeshletViewFromMatrix(Matrix mvp, RasterCullMode cullMode) {
+	const float rowX[4] = {mvp.m0, mvp.m4, mvp.m8, mvp.m12};
+	const float rowY[4] = {mvp.m1, mvp.m5, mvp.m9, mvp.m13};
+	const float rowW[4] = {mvp.m3, mvp.m7, mvp.m11, mvp.m15};
+
+	return (RasterMeshletView){
+		.frustum = RasterFrustumFromMatrix(mvp),
+		.eye =
+			(Vector4){
+				Minor(rowX, rowY, rowW, 0),
+				-Minor(rowX, rowY, rowW, 1),
+				Minor(rowX, rowY, rowW, 2),
+				-Minor(rowX, rowY, rowW, 3),
+			},
+		.cullMode = cullMode,
+	};
+}
+
+// The plane of a triangle with normal n through p is (n, -n.p), its dot product with the eye is n.(eye.xyz - p * eye.w),
+// which is bounded over the meshlet's sphere and normal cone
+RasterMeshletVisibility RasterMeshletCull(const RasterMeshletView* view, const RasterMeshlet* meshlet) {
+	if (RasterFrustumCullsSphere(&view->frustum, meshlet->center, meshlet->radius)) return RASTER_MESHLET_OUTSIDE;
+	if (view->cullMode == RASTER_CULL_NONE) return RASTER_MESHLET_VISIBLE;
+
+	const Vector3 toEye = Vector3Subtract((Vector3){view->eye.x, view->eye.y, view->eye.z}, Vector3Scale(meshlet->center, view->eye.w));
+	const float alongAxis = Vector3DotProduct(toEye, meshlet->coneAxis) * meshlet->coneCos;
+	const float margin = Vector3Length(toEye) * meshlet->coneSin + fabsf(view->eye.w) * meshlet->radius;
+
+	const float facing = (view->cullMode == RASTER_CULL_BACK) ? -alongAxis : alongAxis;
+	return (facing > margin) ? RASTER_MESHLET_FACING_AWAY : RASTER_MESHLET_VISIBLE;
+}
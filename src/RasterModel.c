@@ -1,7 +1,10 @@
 #include "RasterModel.h"
 
 #include <LuLib/LuArray.h>
-#include <regex.h>
+
+#include "RasterFileMap.h"
+#include "RasterModelBinary.h"
+#include "RasterThreadPool.h"
 
 DeclareArrayType(Vector2, Vec2Array);
 DeclareArrayMethods(Vector2, Vec2Array);
@@ -11,353 +14,779 @@ DeclareArrayType(Vector3, Vec3Array);
 DeclareArrayMethods(Vector3, Vec3Array);
 DefineArrayMethods(Vector3, Vec3Array);
 
-DeclareArrayType(uint16_t, IndexArray);
-DeclareArrayMethods(uint16_t, IndexArray);
-DefineArrayMethods(uint16_t, IndexArray);
+DeclareArrayType(Color, ColorArray);
+DeclareArrayMethods(Color, ColorArray);
+DefineArrayMethods(Color, ColorArray);
+
+// Indices of a face corner, relative to the start of the chunk it was parsed in if its bit is set in relativeMask
+typedef struct ObjCorner {
+	int64_t indices[3];
+	uint8_t relativeMask;
+} ObjCorner;
+
+DeclareArrayType(ObjCorner, CornerArray);
+DeclareArrayMethods(ObjCorner, CornerArray);
+DefineArrayMethods(ObjCorner, CornerArray);
 
-DeclareArrayType(RasterModelFace, FaceArray);
-DeclareArrayMethods(RasterModelFace, FaceArray);
-DefineArrayMethods(RasterModelFace, FaceArray);
+DeclareArrayType(uint32_t, FaceSizeArray);
+DeclareArrayMethods(uint32_t, FaceSizeArray);
+DefineArrayMethods(uint32_t, FaceSizeArray);
 
 #define DEFAULT_ARRAY_CAPACITY 8
 
-#define OBJ_VERTEX_PREFIX "v "
-#define OBJ_VERTEX_PREFIX_LEN strlen(OBJ_VERTEX_PREFIX)
+#define OBJ_VERTEX_PREFIX "v"
+#define OBJ_TEXCOORDS_PREFIX "vt"
+#define OBJ_NORMAL_PREFIX "vn"
+#define OBJ_FACE_PREFIX "f"
 
-#define OBJ_TEXCOORDS_PREFIX "vt "
-#define OBJ_TEXCOORDS_PREFIX_LEN strlen(OBJ_TEXCOORDS_PREFIX)
+#define CORNER_VERTEX 0
+#define CORNER_TEXCOORDS 1
+#define CORNER_NORMAL 2
 
-#define OBJ_NORMAL_PREFIX "vn "
-#define OBJ_NORMAL_PREFIX_LEN strlen(OBJ_NORMAL_PREFIX)
+// Files are split in about that many bytes per chunk, each parsed independently
+#define OBJ_MIN_CHUNK_SIZE (1 << 20)
+#define OBJ_CHUNKS_PER_THREAD 4
 
-#define OBJ_FACE_PREFIX "f "
-#define OBJ_FACE_PREFIX_LEN strlen(OBJ_FACE_PREFIX)
+// Past this many warnings per chunk, the others are only counted
+#define OBJ_MAX_CHUNK_WARNINGS 8
 
-#define FLOAT_PATTERN "(\\-?[0-9]+\\.[0-9]+)"
+typedef struct ObjSource {
+	const char* path;
+	const char* data;
+	size_t size;
+} ObjSource;
 
-#define VEC2REG_PATTERN (FLOAT_PATTERN " " FLOAT_PATTERN)
-#define VEC3REG_PATTERN (FLOAT_PATTERN " " FLOAT_PATTERN " " FLOAT_PATTERN)
+typedef struct ObjChunk {
+	const ObjSource* source;
+	const char* start;
+	const char* end;
 
-#define REG_ERROR_BUFFER_LEN 2048
+	Vec3Array* vertices;
+	ColorArray* colors;	 // One per vertex
+	Vec2Array* texCoords;
+	Vec3Array* normals;
+	CornerArray* corners;
+	FaceSizeArray* faceSizes;
 
-typedef struct LineInfo {
-	char* data;
-	int64_t size;
-	size_t capacity;
+	uint32_t warningsCount;
+	bool outOfMemory;
+} ObjChunk;
 
-	const char* filePath;
-	size_t lineNumber;
-} LineInfo;
+typedef struct ObjParse {
+	ObjSource source;
+	ObjChunk* chunks;
+	uint32_t chunksSize;
+} ObjParse;
 
-typedef struct IndicesLimit {
-	uint16_t vertices;
-	uint16_t texCoords;
-	uint16_t normals;
-} IndicesLimit;
+// ============= Scanning =============
 
-static Vector3 ParseVertexLine(const LineInfo* line, regex_t* vec3reg) {
-	char* data = line->data + OBJ_VERTEX_PREFIX_LEN;
+static bool IsObjSpace(char c) { return (c == ' ') || (c == '\t') || (c == '\r'); }
 
-	regmatch_t matches[4] = {0};
-	int32_t execErr = regexec(vec3reg, data, 4, matches, 0);
-	if (execErr == REG_NOMATCH) {
-		LogMessage("Ill-formed vertex info at %s:%zu (defaulting to {0, 0, 0})\n", line->filePath, line->lineNumber);
-		return (Vector3){0};
-	}
+static bool IsDigit(char c) { return (c >= '0') && (c <= '9'); }
 
-	if (execErr) {
-		char regErrBuffer[REG_ERROR_BUFFER_LEN] = {0};
+static void SkipSpaces(const char** cursor, const char* end) {
+	while (*cursor < end && IsObjSpace(**cursor)) (*cursor)++;
+}
 
-		size_t bufEnd = regerror(execErr, vec3reg, regErrBuffer, REG_ERROR_BUFFER_LEN);
-		regErrBuffer[bufEnd - 1] = '\0';
-		LogMessage("Vertex regex error at %s:%zu (defaulting to {0, 0, 0})\n\t%s", line->filePath, line->lineNumber, regErrBuffer);
-		return (Vector3){0};
-	}
+static bool IsTokenEnd(const char* cursor, const char* end) { return (cursor == end) || IsObjSpace(*cursor); }
 
-	return (Vector3){
-		.x = strtof(data + matches[1].rm_so, NULL),
-		.y = strtof(data + matches[2].rm_so, NULL),
-		.z = strtof(data + matches[3].rm_so, NULL),
+static double PowerOf10(int32_t exponent) {
+	static const double exactPowers[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
 	};
+	const int32_t exactPowersSize = sizeof(exactPowers) / sizeof(exactPowers[0]);
+
+	if (exponent >= 0 && exponent < exactPowersSize) return exactPowers[exponent];
+	return pow(10.0, exponent);
 }
 
-static Vector2 ParseTexCoordsLine(const LineInfo* line, regex_t* vec2reg) {
-	char* data = line->data + OBJ_TEXCOORDS_PREFIX_LEN;
+// [+-]digits[.digits][(e|E)[+-]digits], "1", "-.5" and "1e-3" are all valid
+static bool ScanFloat(const char** cursor, const char* end, float* value) {
+	const char* ptr = *cursor;
+
+	bool negative = false;
+	if (ptr < end && (*ptr == '-' || *ptr == '+')) negative = (*ptr++ == '-');
+
+	uint64_t mantissa = 0;
+	int32_t exponent = 0;
+	uint32_t digitsCount = 0;
 
-	regmatch_t matches[4] = {0};
-	int32_t execErr = regexec(vec2reg, data, 4, matches, 0);
-	if (execErr == REG_NOMATCH) {
-		LogMessage("Ill-formed texture coordinates info at %s:%zu (defaulting to {0, 0})\n", line->filePath, line->lineNumber);
-		return (Vector2){0};
+	for (; ptr < end && IsDigit(*ptr); ptr++, digitsCount++) {
+		if (mantissa < UINT64_MAX / 10 - 9) mantissa = mantissa * 10 + (*ptr - '0');
+		else exponent++;
 	}
 
-	if (execErr) {
-		char regErrBuffer[REG_ERROR_BUFFER_LEN] = {0};
+	if (ptr < end && *ptr == '.') {
+		for (ptr++; ptr < end && IsDigit(*ptr); ptr++, digitsCount++) {
+			if (mantissa < UINT64_MAX / 10 - 9) {
+				mantissa = mantissa * 10 + (*ptr - '0');
+				exponent--;
+			}
+		}
+	}
+	if (!digitsCount) return false;
 
-		size_t bufEnd = regerror(execErr, vec2reg, regErrBuffer, REG_ERROR_BUFFER_LEN);
-		regErrBuffer[bufEnd - 1] = '\0';
-		LogMessage("Texture coordinates regex error at %s:%zu (defaulting to {0, 0})\n\t%s", line->filePath, line->lineNumber, regErrBuffer);
-		return (Vector2){
-			.x = 0,
-			.y = 0,
-		};
+	if (ptr < end && (*ptr == 'e' || *ptr == 'E')) {
+		ptr++;
+
+		bool negativeExponent = false;
+		if (ptr < end && (*ptr == '-' || *ptr == '+')) negativeExponent = (*ptr++ == '-');
+		if (ptr == end || !IsDigit(*ptr)) return false;
+
+		int32_t explicitExponent = 0;
+		for (; ptr < end && IsDigit(*ptr); ptr++) {
+			if (explicitExponent < 100000) explicitExponent = explicitExponent * 10 + (*ptr - '0');
+		}
+		exponent += negativeExponent ? -explicitExponent : explicitExponent;
 	}
+	if (!IsTokenEnd(ptr, end)) return false;
 
-	return (Vector2){
-		.x = strtof(data + matches[1].rm_so, NULL),
-		.y = strtof(data + matches[2].rm_so, NULL),
-	};
+	double result = mantissa;
+	if (exponent < 0) result /= PowerOf10(-exponent);
+	else result *= PowerOf10(exponent);
+
+	*value = negative ? -result : result;
+	*cursor = ptr;
+	return true;
 }
 
-static Vector3 ParseNormalLine(const LineInfo* line, regex_t* vec3reg) {
-	char* data = line->data + OBJ_NORMAL_PREFIX_LEN;
+static bool ScanInt(const char** cursor, const char* end, int64_t* value) {
+	const char* ptr = *cursor;
 
-	regmatch_t matches[4] = {0};
-	int32_t execErr = regexec(vec3reg, data, 4, matches, 0);
-	if (execErr == REG_NOMATCH) {
-		LogMessage("Ill-formed normal info at %s:%zu (defaulting to {0, 0, 0})\n", line->filePath, line->lineNumber);
-		return (Vector3){0};
+	bool negative = false;
+	if (ptr < end && (*ptr == '-' || *ptr == '+')) negative = (*ptr++ == '-');
+	if (ptr == end || !IsDigit(*ptr)) return false;
+
+	int64_t result = 0;
+	for (; ptr < end && IsDigit(*ptr); ptr++) {
+		if (result > (INT64_MAX - 9) / 10) return false;
+		result = result * 10 + (*ptr - '0');
 	}
 
-	if (execErr) {
-		char regErrBuffer[REG_ERROR_BUFFER_LEN] = {0};
+	*value = negative ? -result : result;
+	*cursor = ptr;
+	return true;
+}
 
-		size_t bufEnd = regerror(execErr, vec3reg, regErrBuffer, REG_ERROR_BUFFER_LEN);
-		regErrBuffer[bufEnd - 1] = '\0';
-		LogMessage("Normal regex error at %s:%zu (defaulting to {0, -1, 0})\n\t%s", line->filePath, line->lineNumber, regErrBuffer);
-		return (Vector3){
-			.x = 0,
-			.y = -1,
-			.z = 0,
-		};
+static bool ScanFloats(const char** cursor, const char* end, float* values, uint32_t count) {
+	for (uint32_t i = 0; i < count; i++) {
+		SkipSpaces(cursor, end);
+		if (!ScanFloat(cursor, end, values + i)) return false;
 	}
+	return true;
+}
+
+// ============= Parsing =============
 
-	return Vector3Normalize((Vector3){
-		.x = strtof(data + matches[1].rm_so, NULL),
-		.y = strtof(data + matches[2].rm_so, NULL),
-		.z = strtof(data + matches[3].rm_so, NULL),
-	});
+static size_t LineNumberAt(const ObjSource* source, const char* position) {
+	size_t lineNumber = 1;
+	for (const char* ptr = source->data; (ptr = memchr(ptr, '\n', position - ptr)); ptr++) lineNumber++;
+	return lineNumber;
 }
 
-#define ParseFaceLineExitFail()                             \
-	{                                                       \
-		if (vertexArray) IndexArrayFree(vertexArray);       \
-		if (texCoordsArray) IndexArrayFree(texCoordsArray); \
-		if (normalArray) IndexArrayFree(normalArray);       \
-		return (RasterModelFace){0};                        \
+static void ChunkWarning(ObjChunk* chunk, const char* line, const char* message) {
+	chunk->warningsCount++;
+	if (chunk->warningsCount > OBJ_MAX_CHUNK_WARNINGS) return;
+
+	LogMessage("%s at %s:%zu\n", message, chunk->source->path, LineNumberAt(chunk->source, line));
+}
+
+static uint8_t ColorChannel(float value) { return lrintf(Clamp(value, 0.0f, 1.0f) * 255.0f); }
+
+// Vertices without colors are white
+static void ParseVertexLine(ObjChunk* chunk, const char* line, const char* cursor, const char* end) {
+	float coords[3] = {0};
+	float channels[3] = {1.0f, 1.0f, 1.0f};
+	if (!ScanFloats(&cursor, end, coords, 3)) {
+		ChunkWarning(chunk, line, "Ill-formed vertex info (defaulting to {0, 0, 0})");
+		coords[0] = coords[1] = coords[2] = 0;
+	} else {
+		SkipSpaces(&cursor, end);
+		if (cursor < end && !ScanFloats(&cursor, end, channels, 3)) {
+			ChunkWarning(chunk, line, "Ill-formed vertex color (defaulting to white)");
+			channels[0] = channels[1] = channels[2] = 1.0f;
+		}
 	}
 
-static RasterModelFace ParseFaceLine(const LineInfo* line, const IndicesLimit* maxIndices) {
-	char* ptr = line->data + OBJ_FACE_PREFIX_LEN;
-	char* next = ptr;
+	const Vector3 vertex = (Vector3){.x = coords[0], .y = coords[1], .z = coords[2]};
+	const Color col = (Color){ColorChannel(channels[0]), ColorChannel(channels[1]), ColorChannel(channels[2]), 0xFF};
+	if (!Vec3ArrayPush(chunk->vertices, vertex) || !ColorArrayPush(chunk->colors, col)) chunk->outOfMemory = true;
+}
+
+// Models with only U coordinates get V = 0
+static void ParseTexCoordsLine(ObjChunk* chunk, const char* line, const char* cursor, const char* end) {
+	float coords[2] = {0};
+	if (!ScanFloats(&cursor, end, coords, 1)) {
+		ChunkWarning(chunk, line, "Ill-formed texture coordinates info (defaulting to {0, 0})");
+		coords[0] = 0;
+	} else {
+		SkipSpaces(&cursor, end);
+		if (cursor < end && !ScanFloat(&cursor, end, coords + 1)) {
+			ChunkWarning(chunk, line, "Ill-formed texture coordinates info (defaulting V to 0)");
+			coords[1] = 0;
+		}
+	}
 
-	IndexArray* vertexArray = IndexArrayCreate(DEFAULT_ARRAY_CAPACITY);
-	IndexArray* texCoordsArray = IndexArrayCreate(DEFAULT_ARRAY_CAPACITY);
-	IndexArray* normalArray = IndexArrayCreate(DEFAULT_ARRAY_CAPACITY);
+	const Vector2 texCoords = (Vector2){.x = coords[0], .y = coords[1]};
+	if (!Vec2ArrayPush(chunk->texCoords, texCoords)) chunk->outOfMemory = true;
+}
 
-	if (!vertexArray || !texCoordsArray || !normalArray) ParseFaceLineExitFail();
+static void ParseNormalLine(ObjChunk* chunk, const char* line, const char* cursor, const char* end) {
+	float coords[3] = {0};
+	Vector3 normal = (Vector3){.x = 0, .y = -1, .z = 0};
 
-	while (*next) {
-#define CheckIndexError(msg)     \
-	{                            \
-		LogString(msg);          \
-		ParseFaceLineExitFail(); \
+	if (ScanFloats(&cursor, end, coords, 3)) {
+		normal = Vector3Normalize((Vector3){.x = coords[0], .y = coords[1], .z = coords[2]});
+	} else {
+		ChunkWarning(chunk, line, "Ill-formed normal info (defaulting to {0, -1, 0})");
 	}
 
-#define CheckIndex(idx, maxIdx)                                                                          \
-	{                                                                                                    \
-		int64_t chkIdxTemp1_ = strtoll(ptr, &next, 10);                                                  \
-		if (next == ptr) CheckIndexError("TODO: Add error message for invalid model \"face\" line\n");   \
-                                                                                                         \
-		if (chkIdxTemp1_ < 0) chkIdxTemp1_ = maxIdx + chkIdxTemp1_ + 1;                                  \
-		idx = chkIdxTemp1_ - 1;                                                                          \
-                                                                                                         \
-		if (idx >= maxIdx) CheckIndexError("TODO: Add error message for invalid model \"face\" line\n"); \
+	if (!Vec3ArrayPush(chunk->normals, normal)) chunk->outOfMemory = true;
+}
+
+// OBJ indices are 1-based, negative ones count back from the last element parsed so far, which may be in an earlier
+// chunk, so those are kept relative to the chunk's first element until all the chunks are merged
+static bool ScanCornerIndex(const char** cursor, const char* end, size_t parsedCount, ObjCorner* corner, uint32_t component) {
+	int64_t index;
+	if (!ScanInt(cursor, end, &index) || !index) return false;
+
+	if (index > 0) {
+		corner->indices[component] = index - 1;
+	} else {
+		corner->indices[component] = (int64_t)parsedCount + index;
+		corner->relativeMask |= 1 << component;
 	}
+	return true;
+}
 
-		uint16_t currVertexIdx = 0;
-		uint16_t currTexCoordsIdx = 0;
-		uint16_t currNormalIdx = 0;
+static void ParseFaceLine(ObjChunk* chunk, const char* line, const char* cursor, const char* end) {
+	const size_t firstCorner = chunk->corners->size;
 
-		CheckIndex(currVertexIdx, maxIndices->vertices);
-		next++;
-		ptr = next;
+	SkipSpaces(&cursor, end);
+	while (cursor < end) {
+		ObjCorner corner = {0};
 
-		CheckIndex(currTexCoordsIdx, maxIndices->texCoords);
-		next++;
-		ptr = next;
+		bool validCorner = ScanCornerIndex(&cursor, end, chunk->vertices->size, &corner, CORNER_VERTEX);
+		validCorner = validCorner && (cursor < end) && (*cursor++ == '/');
+		validCorner = validCorner && ScanCornerIndex(&cursor, end, chunk->texCoords->size, &corner, CORNER_TEXCOORDS);
+		validCorner = validCorner && (cursor < end) && (*cursor++ == '/');
+		validCorner = validCorner && ScanCornerIndex(&cursor, end, chunk->normals->size, &corner, CORNER_NORMAL);
+		validCorner = validCorner && IsTokenEnd(cursor, end);
 
-		CheckIndex(currNormalIdx, maxIndices->normals);
-		next++;
-		ptr = next;
+		if (!validCorner) {
+			ChunkWarning(chunk, line, "Ill-formed face info, expected \"v/t/n\" corners (skipping the face)");
+			chunk->corners->size = firstCorner;
+			return;
+		}
 
-		bool failedPush = false;
-		if (!IndexArrayPush(vertexArray, currVertexIdx)) failedPush = true;
-		if (!IndexArrayPush(texCoordsArray, currTexCoordsIdx)) failedPush = true;
-		if (!IndexArrayPush(normalArray, currNormalIdx)) failedPush = true;
-		if (failedPush) ParseFaceLineExitFail();
+		if (!CornerArrayPush(chunk->corners, corner)) {
+			chunk->outOfMemory = true;
+			return;
+		}
+		SkipSpaces(&cursor, end);
 	}
 
-	bool failedShrink = false;
-	if (!IndexArrayShrinkToFit(vertexArray)) failedShrink = true;
-	if (!IndexArrayShrinkToFit(texCoordsArray)) failedShrink = true;
-	if (!IndexArrayShrinkToFit(normalArray)) failedShrink = true;
-	if (failedShrink) ParseFaceLineExitFail();
+	const size_t faceSize = chunk->corners->size - firstCorner;
+	if (faceSize < 3) {
+		ChunkWarning(chunk, line, "Face with less than 3 corners (skipping the face)");
+		chunk->corners->size = firstCorner;
+		return;
+	}
 
-	RasterModelFace face = (RasterModelFace){
-		.vertexIndeces = vertexArray->data,
-		.texCoordIndices = texCoordsArray->data,
-		.normalIndices = normalArray->data,
-		.indicesSize = vertexArray->size,
-	};
+	if (!FaceSizeArrayPush(chunk->faceSizes, faceSize)) chunk->outOfMemory = true;
+}
 
-	Free(vertexArray);
-	Free(texCoordsArray);
-	Free(normalArray);
+// Returns true if the line starts with the keyword followed by a space, and moves the cursor past it
+static bool MatchKeyword(const char** cursor, const char* end, const char* keyword) {
+	const size_t keywordLen = strlen(keyword);
+	if ((size_t)(end - *cursor) <= keywordLen) return false;
+	if (strncmp(*cursor, keyword, keywordLen) || !IsObjSpace((*cursor)[keywordLen])) return false;
 
-	return face;
+	*cursor += keywordLen;
+	return true;
 }
 
-#define LoadRasterModelFromFileExitFail()                    \
-	{                                                        \
-		regfree(&vec3reg);                                   \
-		regfree(&vec2reg);                                   \
-		if (parsedVertices) Vec3ArrayFree(parsedVertices);   \
-		if (parsedTexCoords) Vec2ArrayFree(parsedTexCoords); \
-		if (parsedNormals) Vec3ArrayFree(parsedNormals);     \
-		if (parsedFaces) FaceArrayFree(parsedFaces);         \
-		CloseFile(objFile);                                  \
-		FreeAndReturn(model, NULL);                          \
+static void ParseChunkJob(void* userData, uint32_t chunkIndex) {
+	ObjChunk* chunk = ((ObjParse*)userData)->chunks + chunkIndex;
+
+	const char* line = chunk->start;
+	while (line < chunk->end && !chunk->outOfMemory) {
+		const char* lineEnd = memchr(line, '\n', chunk->end - line);
+		if (!lineEnd) lineEnd = chunk->end;
+
+		const char* cursor = line;
+		SkipSpaces(&cursor, lineEnd);
+
+		if (MatchKeyword(&cursor, lineEnd, OBJ_VERTEX_PREFIX)) ParseVertexLine(chunk, line, cursor, lineEnd);
+		else if (MatchKeyword(&cursor, lineEnd, OBJ_TEXCOORDS_PREFIX)) ParseTexCoordsLine(chunk, line, cursor, lineEnd);
+		else if (MatchKeyword(&cursor, lineEnd, OBJ_NORMAL_PREFIX)) ParseNormalLine(chunk, line, cursor, lineEnd);
+		else if (MatchKeyword(&cursor, lineEnd, OBJ_FACE_PREFIX)) ParseFaceLine(chunk, line, cursor, lineEnd);
+
+		line = lineEnd + 1;
 	}
 
-RasterModel* LoadRasterModelFromFile(const char* path) {
-	RasterModel* model = NULL;
-	if (!Malloc(model, sizeof(RasterModel))) return NULL;
-
-	FILE* objFile = TryOpenFile(path, "r+");
-	if (!objFile) FreeAndReturn(model, NULL);
-
-	regex_t vec3reg;
-	regex_t vec2reg;
-	{
-		char regErrBuffer[REG_ERROR_BUFFER_LEN] = {0};
-		int32_t regErr1;
-		int32_t regErr2;
-		bool failedRegcomp = false;
-
-		if ((regErr1 = regcomp(&vec3reg, VEC3REG_PATTERN, REG_EXTENDED))) {
-			failedRegcomp = true;
-			size_t bufEnd = regerror(regErr1, &vec3reg, regErrBuffer, REG_ERROR_BUFFER_LEN);
-			regErrBuffer[bufEnd - 1] = '\0';
-			LogString(regErrBuffer);
-		}
+	if (chunk->warningsCount > OBJ_MAX_CHUNK_WARNINGS) {
+		LogMessage("%u more warnings in %s\n", chunk->warningsCount - OBJ_MAX_CHUNK_WARNINGS, chunk->source->path);
+	}
+}
 
-		if ((regErr2 = regcomp(&vec2reg, VEC2REG_PATTERN, REG_EXTENDED))) {
-			failedRegcomp = true;
-			size_t bufEnd = regerror(regErr2, &vec2reg, regErrBuffer, REG_ERROR_BUFFER_LEN);
-			regErrBuffer[bufEnd - 1] = '\0';
-			LogString(regErrBuffer);
+// ============= Chunks =============
+
+static void FreeChunks(ObjParse* parse) {
+	for (uint32_t i = 0; i < parse->chunksSize; i++) {
+		ObjChunk* chunk = parse->chunks + i;
+		if (chunk->vertices) Vec3ArrayFree(chunk->vertices);
+		if (chunk->colors) ColorArrayFree(chunk->colors);
+		if (chunk->texCoords) Vec2ArrayFree(chunk->texCoords);
+		if (chunk->normals) Vec3ArrayFree(chunk->normals);
+		if (chunk->corners) CornerArrayFree(chunk->corners);
+		if (chunk->faceSizes) FaceSizeArrayFree(chunk->faceSizes);
+	}
+	Free(parse->chunks);
+}
+
+// Splits the source in chunksSize newline-aligned chunks (fewer if lines are too long)
+static bool CreateChunks(ObjParse* parse, uint32_t chunksSize) {
+	if (!Malloc(parse->chunks, chunksSize * sizeof(ObjChunk))) return false;
+	parse->chunksSize = 0;
+
+	const char* sourceEnd = parse->source.data + parse->source.size;
+	const char* chunkStart = parse->source.data;
+
+	for (uint32_t i = 0; i < chunksSize && chunkStart < sourceEnd; i++) {
+		const char* chunkEnd = sourceEnd;
+		if (i + 1 < chunksSize) {
+			const char* splitPoint = chunkStart + Max(parse->source.size / chunksSize, 1);
+			if (splitPoint < sourceEnd) {
+				const char* newline = memchr(splitPoint, '\n', sourceEnd - splitPoint);
+				if (newline) chunkEnd = newline + 1;
+			}
 		}
 
-		if (failedRegcomp) {
-			if (!regErr1) regfree(&vec3reg);
-			if (!regErr2) regfree(&vec2reg);
-			CloseFile(objFile);
-			FreeAndReturn(model, NULL);
+		ObjChunk* chunk = parse->chunks + parse->chunksSize++;
+		*chunk = (ObjChunk){
+			.source = &parse->source,
+			.start = chunkStart,
+			.end = chunkEnd,
+			.vertices = Vec3ArrayCreate(DEFAULT_ARRAY_CAPACITY),
+			.colors = ColorArrayCreate(DEFAULT_ARRAY_CAPACITY),
+			.texCoords = Vec2ArrayCreate(DEFAULT_ARRAY_CAPACITY),
+			.normals = Vec3ArrayCreate(DEFAULT_ARRAY_CAPACITY),
+			.corners = CornerArrayCreate(DEFAULT_ARRAY_CAPACITY),
+			.faceSizes = FaceSizeArrayCreate(DEFAULT_ARRAY_CAPACITY),
+		};
+		if (!chunk->vertices || !chunk->colors || !chunk->texCoords || !chunk->normals || !chunk->corners || !chunk->faceSizes) return false;
+
+		chunkStart = chunkEnd;
+	}
+
+	return true;
+}
+
+static bool ParseChunks(ObjParse* parse) {
+	const uint32_t threadCount = RasterThreadPoolDefaultThreadCount();
+	const size_t maxChunks = Max(parse->source.size / OBJ_MIN_CHUNK_SIZE, 1);
+	const uint32_t chunksSize = Min(maxChunks, (size_t)threadCount * OBJ_CHUNKS_PER_THREAD);
+
+	if (!CreateChunks(parse, chunksSize)) return false;
+
+	RasterThreadPool* pool = RasterThreadPoolCreate(Min(threadCount, parse->chunksSize));
+	if (pool) {
+		RasterThreadPoolRun(pool, ParseChunkJob, parse, parse->chunksSize);
+		RasterThreadPoolFree(pool);
+	} else {
+		for (uint32_t i = 0; i < parse->chunksSize; i++) {
+			ParseChunkJob(parse, i);
 		}
 	}
 
-	Vec3Array* parsedVertices = Vec3ArrayCreate(DEFAULT_ARRAY_CAPACITY);
-	Vec2Array* parsedTexCoords = Vec2ArrayCreate(DEFAULT_ARRAY_CAPACITY);
-	Vec3Array* parsedNormals = Vec3ArrayCreate(DEFAULT_ARRAY_CAPACITY);
-	FaceArray* parsedFaces = FaceArrayCreate(DEFAULT_ARRAY_CAPACITY);
+	for (uint32_t i = 0; i < parse->chunksSize; i++) {
+		if (parse->chunks[i].outOfMemory) return false;
+	}
+	return true;
+}
 
-	if (!parsedVertices || !parsedTexCoords || !parsedNormals || !parsedFaces) {
-		LoadRasterModelFromFileExitFail();
+// ============= Merging =============
+
+typedef struct ObjTotals {
+	size_t vertices;
+	size_t texCoords;
+	size_t normals;
+	size_t faces;
+	size_t corners;
+} ObjTotals;
+
+static ObjTotals SumChunks(const ObjParse* parse) {
+	ObjTotals totals = {0};
+	for (uint32_t i = 0; i < parse->chunksSize; i++) {
+		totals.vertices += parse->chunks[i].vertices->size;
+		totals.texCoords += parse->chunks[i].texCoords->size;
+		totals.normals += parse->chunks[i].normals->size;
+		totals.faces += parse->chunks[i].faceSizes->size;
+		totals.corners += parse->chunks[i].corners->size;
 	}
+	return totals;
+}
 
-	LineInfo line = {0};
-	line.filePath = path;
-	IndicesLimit maxIndices = {0};
+// Indices of a corner into the merged OBJ arrays, identifying a single model vertex
+typedef struct ObjVertexKey {
+	uint32_t indices[3];
+} ObjVertexKey;
 
-	while ((line.size = LuFileGetLine(&line.data, &line.capacity, objFile)) != LU_FILE_ERROR) {
-		line.lineNumber++;
-#define CheckForPrefix(prefix) if (strncmp(line.data, prefix, prefix##_LEN) == 0)
+// Open addressing hash set of the vertex keys, which get their vertex index in insertion order
+typedef struct ObjVertexMap {
+	ObjVertexKey* keys;	 // Allocated by the caller's arena
+	size_t keysSize;
 
-		CheckForPrefix(OBJ_VERTEX_PREFIX) {
-			if (!Vec3ArrayPush(parsedVertices, ParseVertexLine(&line, &vec3reg))) {
-				Free(line.data);
-				LoadRasterModelFromFileExitFail();
-			}
-			maxIndices.vertices++;
-		}
+	uint32_t* slots;  // Index + 1 of the key in keys, 0 for empty slots
+	size_t slotsMask;
+} ObjVertexMap;
 
-		CheckForPrefix(OBJ_TEXCOORDS_PREFIX) {
-			if (!Vec2ArrayPush(parsedTexCoords, ParseTexCoordsLine(&line, &vec2reg))) {
-				Free(line.data);
-				LoadRasterModelFromFileExitFail();
-			}
-			maxIndices.texCoords++;
+// The keys outlive the slots, they go to keysArena
+static bool ObjVertexMapCreate(ObjVertexMap* map, size_t maxKeys, RasterArena* keysArena) {
+	size_t slotsSize = 1;
+	while (slotsSize < maxKeys * 2) slotsSize <<= 1;
+
+	*map = (ObjVertexMap){.slotsMask = slotsSize - 1};
+	map->keys = RasterArenaAllocArray(keysArena, maxKeys, sizeof(ObjVertexKey));
+	if (!map->keys || !Malloc(map->slots, slotsSize * sizeof(uint32_t))) return false;
+
+	memset(map->slots, 0, slotsSize * sizeof(uint32_t));
+	return true;
+}
+
+// Only frees the slots, the keys stay usable
+static void ObjVertexMapFree(ObjVertexMap* map) {
+	if (map->slots) Free(map->slots);
+	map->slots = NULL;
+}
+
+static size_t HashVertexKey(const ObjVertexKey* key) {
+	return (key->indices[0] * 0x9E3779B1u) ^ (key->indices[1] * 0x85EBCA77u) ^ (key->indices[2] * 0xC2B2AE3Du);
+}
+
+// Returns the vertex index of the key, inserting it if it's new (the map is sized for every corner, so it can't fill up)
+static uint32_t ObjVertexMapInsert(ObjVertexMap* map, const ObjVertexKey* key) {
+	for (size_t slot = HashVertexKey(key) & map->slotsMask;; slot = (slot + 1) & map->slotsMask) {
+		const uint32_t slotValue = map->slots[slot];
+		if (!slotValue) {
+			const uint32_t vertexIndex = map->keysSize++;
+			map->keys[vertexIndex] = *key;
+			map->slots[slot] = vertexIndex + 1;
+			return vertexIndex;
 		}
 
-		CheckForPrefix(OBJ_NORMAL_PREFIX) {
-			if (!Vec3ArrayPush(parsedNormals, ParseNormalLine(&line, &vec3reg))) {
-				Free(line.data);
-				LoadRasterModelFromFileExitFail();
+		if (!memcmp(map->keys + slotValue - 1, key, sizeof(ObjVertexKey))) return slotValue - 1;
+	}
+}
+
+static bool ResolveCorner(const ObjCorner* corner, const size_t chunkOffsets[3], const size_t counts[3], ObjVertexKey* key) {
+	for (uint32_t component = 0; component < 3; component++) {
+		int64_t index = corner->indices[component];
+		if (corner->relativeMask & (1 << component)) index += chunkOffsets[component];
+
+		if (index < 0 || (size_t)index >= counts[component]) return false;
+		key->indices[component] = index;
+	}
+	return true;
+}
+
+// Fills cornerVertices with the model vertex index of every corner, in file order
+static bool IndexCorners(const ObjParse* parse, const ObjTotals* totals, ObjVertexMap* map, uint32_t* cornerVertices) {
+	const size_t counts[3] = {totals->vertices, totals->texCoords, totals->normals};
+	size_t chunkOffsets[3] = {0};
+
+	for (uint32_t i = 0; i < parse->chunksSize; i++) {
+		const ObjChunk* chunk = parse->chunks + i;
+
+		for (size_t j = 0; j < chunk->corners->size; j++) {
+			ObjVertexKey key;
+			if (!ResolveCorner(chunk->corners->data + j, chunkOffsets, counts, &key)) {
+				LogMessage("Face index out of bounds in %s\n", parse->source.path);
+				return false;
 			}
-			maxIndices.normals++;
+			*cornerVertices++ = ObjVertexMapInsert(map, &key);
 		}
 
-		CheckForPrefix(OBJ_FACE_PREFIX) {
-			if (!FaceArrayPush(parsedFaces, ParseFaceLine(&line, &maxIndices))) {
-				Free(line.data);
-				LoadRasterModelFromFileExitFail();
+		chunkOffsets[CORNER_VERTEX] += chunk->vertices->size;
+		chunkOffsets[CORNER_TEXCOORDS] += chunk->texCoords->size;
+		chunkOffsets[CORNER_NORMAL] += chunk->normals->size;
+	}
+
+	return true;
+}
+
+static void TriangulateFaces(const ObjParse* parse, const uint32_t* cornerVertices, uint32_t* indices) {
+	const uint32_t* faceCorners = cornerVertices;
+	for (uint32_t i = 0; i < parse->chunksSize; i++) {
+		const FaceSizeArray* faceSizes = parse->chunks[i].faceSizes;
+		for (size_t j = 0; j < faceSizes->size; j++) {
+			const uint32_t faceSize = faceSizes->data[j];
+			for (uint32_t k = 1; k + 1 < faceSize; k++) {
+				*indices++ = faceCorners[0];
+				*indices++ = faceCorners[k];
+				*indices++ = faceCorners[k + 1];
 			}
+			faceCorners += faceSize;
 		}
 	}
-	Free(line.data);
+}
 
-	bool failedShrink = false;
-	if (!Vec3ArrayShrinkToFit(parsedVertices)) failedShrink = true;
-	if (!Vec2ArrayShrinkToFit(parsedTexCoords)) failedShrink = true;
-	if (!Vec3ArrayShrinkToFit(parsedNormals)) failedShrink = true;
-	if (!FaceArrayShrinkToFit(parsedFaces)) failedShrink = true;
-	if (failedShrink) LoadRasterModelFromFileExitFail();
+#define CopyIndices(indexType)                                                                   \
+	{                                                                                            \
+		indexType* indices = model->indices;                                                     \
+		for (size_t i = 0; i < model->trianglesSize * 3; i++) indices[i] = partition.indices[i]; \
+	}
+
+#define MergeChunkArray(dst, member, type)                                                                \
+	{                                                                                                     \
+		size_t offset = 0;                                                                                \
+		for (uint32_t i = 0; i < parse->chunksSize; i++) {                                                \
+			const size_t chunkSize = parse->chunks[i].member->size;                                       \
+			if (chunkSize) memcpy(dst + offset, parse->chunks[i].member->data, chunkSize * sizeof(type)); \
+			offset += chunkSize;                                                                          \
+		}                                                                                                 \
+	}
+
+// The OBJ's attributes, merged from every chunk
+typedef struct ObjAttributes {
+	Vector3* positions;
+	Color* colors;
+	Vector2* texCoords;
+	Vector3* normals;
+} ObjAttributes;
+
+static void MergeAttributes(const ObjParse* parse, const ObjTotals* totals, RasterArena* scratch, ObjAttributes* attributes) {
+	*attributes = (ObjAttributes){
+		.positions = RasterArenaAllocArray(scratch, totals->vertices, sizeof(Vector3)),
+		.colors = RasterArenaAllocArray(scratch, totals->vertices, sizeof(Color)),
+		.texCoords = RasterArenaAllocArray(scratch, totals->texCoords, sizeof(Vector2)),
+		.normals = RasterArenaAllocArray(scratch, totals->normals, sizeof(Vector3)),
+	};
+
+	MergeChunkArray(attributes->positions, vertices, Vector3);
+	MergeChunkArray(attributes->colors, colors, Color);
+	MergeChunkArray(attributes->texCoords, texCoords, Vector2);
+	MergeChunkArray(attributes->normals, normals, Vector3);
+}
+
+// Once merged, only the face sizes of the chunks are left to triangulate the faces
+static void FreeChunksAttributes(ObjParse* parse) {
+	for (uint32_t i = 0; i < parse->chunksSize; i++) {
+		ObjChunk* chunk = parse->chunks + i;
+		Vec3ArrayFree(chunk->vertices);
+		ColorArrayFree(chunk->colors);
+		Vec2ArrayFree(chunk->texCoords);
+		Vec3ArrayFree(chunk->normals);
+		CornerArrayFree(chunk->corners);
+		chunk->vertices = NULL;
+		chunk->colors = NULL;
+		chunk->texCoords = NULL;
+		chunk->normals = NULL;
+		chunk->corners = NULL;
+	}
+}
+
+static void GatherPositions(const ObjVertexMap* map, const ObjAttributes* attributes, Vector3* positions) {
+	for (size_t i = 0; i < map->keysSize; i++) positions[i] = attributes->positions[map->keys[i].indices[CORNER_VERTEX]];
+}
+
+// The model's vertices are the partition's, each one being a copy of one of the map's
+static void GatherVertices(const ObjVertexMap* map, const ObjAttributes* attributes, const RasterMeshletPartition* partition,
+						   RasterModel* model) {
+	for (size_t i = 0; i < partition->verticesSize; i++) {
+		const ObjVertexKey* key = map->keys + partition->vertices[i];
+		model->positions[i] = attributes->positions[key->indices[CORNER_VERTEX]];
+		model->colors[i] = attributes->colors[key->indices[CORNER_VERTEX]];
+		model->texCoords[i] = attributes->texCoords[key->indices[CORNER_TEXCOORDS]];
+		model->normals[i] = attributes->normals[key->indices[CORNER_NORMAL]];
+	}
+}
+
+// Hashed from the triangle index alone, so a triangle keeps its color whatever else is drawn before it
+static void HashFaceColors(RasterModel* model) {
+	for (size_t i = 0; i < model->trianglesSize; i++) {
+		uint32_t hash = (uint32_t)i * 0x9E3779B1u + 0x7F4A7C15u;
+		hash = (hash ^ (hash >> 16)) * 0x85EBCA6Bu;
+		hash = (hash ^ (hash >> 13)) * 0xC2B2AE35u;
+		hash ^= hash >> 16;
+		model->faceColors[i] = (Color){hash & 0xFF, (hash >> 8) & 0xFF, (hash >> 16) & 0xFF, 0xFF};
+	}
+}
+
+// Every temporary array of the merge is known in advance (the map's vertices being bounded by the corners), so they
+// all fit in a single block
+static size_t ScratchSize(const ObjTotals* totals, size_t trianglesSize) {
+	return RasterArenaAlignedSize(totals->vertices * sizeof(Vector3)) + RasterArenaAlignedSize(totals->vertices * sizeof(Color)) +
+		   RasterArenaAlignedSize(totals->texCoords * sizeof(Vector2)) + RasterArenaAlignedSize(totals->normals * sizeof(Vector3)) +
+		   RasterArenaAlignedSize(totals->corners * sizeof(ObjVertexKey)) + RasterArenaAlignedSize(totals->corners * sizeof(uint32_t)) +
+		   RasterArenaAlignedSize(trianglesSize * 3 * sizeof(uint32_t)) + RasterArenaAlignedSize(totals->corners * sizeof(Vector3)) +
+		   RasterMeshletPartitionScratchSize(totals->corners, trianglesSize);
+}
+
+#define MergeChunksExitFail()         \
+	{                                 \
+		ObjVertexMapFree(&vertexMap); \
+		RasterArenaFree(&scratch);    \
+		return NULL;                  \
+	}
+
+// The corners are indexed and the triangles split in meshlets first, so the chunks' arrays are freed before the model
+// is allocated
+static RasterModel* MergeChunks(ObjParse* parse) {
+	const ObjTotals totals = SumChunks(parse);
+	if (totals.vertices > UINT32_MAX || totals.texCoords > UINT32_MAX || totals.normals > UINT32_MAX || totals.corners >= UINT32_MAX) {
+		LogMessage("%s has more elements than 32 bits indices can address\n", parse->source.path);
+		return NULL;
+	}
+
+	// Every face has at least 3 corners, and adds one triangle per corner past the first two
+	const size_t trianglesSize = totals.corners - 2 * totals.faces;
+
+	RasterArena scratch;
+	RasterArenaInit(&scratch, ScratchSize(&totals, trianglesSize));
+	ObjVertexMap vertexMap = {0};
+
+	uint32_t* cornerVertices = RasterArenaAllocArray(&scratch, totals.corners, sizeof(uint32_t));
+	if (!cornerVertices || !ObjVertexMapCreate(&vertexMap, totals.corners, &scratch)) MergeChunksExitFail();
+	if (!IndexCorners(parse, &totals, &vertexMap, cornerVertices)) MergeChunksExitFail();
+	ObjVertexMapFree(&vertexMap);
+
+	ObjAttributes attributes;
+	MergeAttributes(parse, &totals, &scratch, &attributes);
+	if (!attributes.positions || !attributes.colors || !attributes.texCoords || !attributes.normals) MergeChunksExitFail();
+	FreeChunksAttributes(parse);
+
+	uint32_t* indices = RasterArenaAllocArray(&scratch, trianglesSize * 3, sizeof(uint32_t));
+	Vector3* positions = RasterArenaAllocArray(&scratch, vertexMap.keysSize, sizeof(Vector3));
+	if (!indices || !positions) MergeChunksExitFail();
+	TriangulateFaces(parse, cornerVertices, indices);
+	GatherPositions(&vertexMap, &attributes, positions);
+
+	RasterMeshletPartition partition;
+	if (!RasterMeshletPartitionBuild(&partition, positions, vertexMap.keysSize, indices, trianglesSize, &scratch)) MergeChunksExitFail();
+	if (partition.verticesSize > UINT32_MAX) {
+		LogMessage("%s has more elements than 32 bits indices can address\n", parse->source.path);
+		MergeChunksExitFail();
+	}
+
+	RasterModel* model = RasterModelCreate(partition.verticesSize, trianglesSize, partition.meshletsSize);
+	if (!model) MergeChunksExitFail();
+
+	GatherVertices(&vertexMap, &attributes, &partition, model);
+	HashFaceColors(model);
+	RasterModelUpdateBounds(model);
+	if (model->indexType == RASTER_INDEX_UINT16) CopyIndices(uint16_t) else CopyIndices(uint32_t);
+	if (partition.meshletsSize) memcpy(model->meshlets, partition.meshlets, partition.meshletsSize * sizeof(RasterMeshlet));
+
+	RasterArenaFree(&scratch);
+	return model;
+}
+
+// ============= Loading =============
+
+RasterModel* RasterModelCreate(size_t verticesSize, size_t trianglesSize, size_t meshletsSize) {
+	const RasterIndexType indexType = (verticesSize <= UINT16_MAX + 1) ? RASTER_INDEX_UINT16 : RASTER_INDEX_UINT32;
+	if (verticesSize > SIZE_MAX / sizeof(Vector3) || trianglesSize > SIZE_MAX / 3 / sizeof(uint32_t)) return NULL;
+	if (meshletsSize > SIZE_MAX / sizeof(RasterMeshlet)) return NULL;
+
+	const size_t indicesSize = trianglesSize * 3 * RasterModelIndexSize(indexType);
+	RasterArena arena;
+	RasterArenaInit(&arena, RasterArenaAlignedSize(sizeof(RasterModel)) + 2 * RasterArenaAlignedSize(verticesSize * sizeof(Vector3)) +
+								RasterArenaAlignedSize(verticesSize * sizeof(Color)) + RasterArenaAlignedSize(verticesSize * sizeof(Vector2)) +
+								RasterArenaAlignedSize(indicesSize) + RasterArenaAlignedSize(trianglesSize * sizeof(Color)) +
+								RasterArenaAlignedSize(meshletsSize * sizeof(RasterMeshlet)));
+
+	RasterModel* model = RasterArenaAlloc(&arena, sizeof(RasterModel));
+	if (!model) return NULL;
 
 	*model = (RasterModel){
-		.vertices = parsedVertices->data,
-		.verticesSize = parsedVertices->size,
+		.positions = RasterArenaAllocArray(&arena, verticesSize, sizeof(Vector3)),
+		.texCoords = RasterArenaAllocArray(&arena, verticesSize, sizeof(Vector2)),
+		.normals = RasterArenaAllocArray(&arena, verticesSize, sizeof(Vector3)),
+		.colors = RasterArenaAllocArray(&arena, verticesSize, sizeof(Color)),
+		.verticesSize = verticesSize,
+		.indices = RasterArenaAlloc(&arena, indicesSize),
+		.indexType = indexType,
+		.trianglesSize = trianglesSize,
+		.faceColors = RasterArenaAllocArray(&arena, trianglesSize, sizeof(Color)),
+		.meshlets = RasterArenaAllocArray(&arena, meshletsSize, sizeof(RasterMeshlet)),
+		.meshletsSize = meshletsSize,
+	};
+	model->arena = arena;
+	return model;
+}
 
-		.texCoords = parsedTexCoords->data,
-		.texCoordsSize = parsedTexCoords->size,
+// Centered on the positions' bounding box, which is close enough to the smallest sphere for culling
+void RasterModelUpdateBounds(RasterModel* model) {
+	if (!model->verticesSize) {
+		model->boundsCenter = (Vector3){0};
+		model->boundsRadius = 0;
+		return;
+	}
 
-		.normals = parsedNormals->data,
-		.normalsSize = parsedNormals->size,
+	Vector3 min = model->positions[0];
+	Vector3 max = model->positions[0];
+	for (size_t i = 1; i < model->verticesSize; i++) {
+		min = Vector3Min(min, model->positions[i]);
+		max = Vector3Max(max, model->positions[i]);
+	}
+
+	const Vector3 center = Vector3Scale(Vector3Add(min, max), 0.5f);
+	float radiusSquared = 0;
+	for (size_t i = 0; i < model->verticesSize; i++) {
+		const Vector3 offset = Vector3Subtract(model->positions[i], center);
+		radiusSquared = fmaxf(radiusSquared, Vector3DotProduct(offset, offset));
+	}
 
-		.faces = parsedFaces->data,
-		.facesSize = parsedFaces->size,
+	model->boundsCenter = center;
+	model->boundsRadius = sqrtf(radiusSquared);
+}
+
+RasterModel* LoadRasterModelFromObj(const char* path) {
+	RasterFileMap file;
+	if (!RasterFileMapOpen(&file, path)) return NULL;
+
+	ObjParse parse = (ObjParse){
+		.source =
+			(ObjSource){
+				.path = path,
+				.data = file.data,
+				.size = file.size,
+			},
 	};
 
-	regfree(&vec3reg);
-	regfree(&vec2reg);
-	Free(parsedVertices);
-	Free(parsedTexCoords);
-	Free(parsedNormals);
-	Free(parsedFaces);
-	CloseFile(objFile);
+	RasterModel* model = ParseChunks(&parse) ? MergeChunks(&parse) : NULL;
 
+	FreeChunks(&parse);
+	RasterFileMapClose(&file);
 	return model;
 }
 
-void RasterModelFree(RasterModel* model) {
-	Free(model->vertices);
-	Free(model->texCoords);
-	Free(model->normals);
+RasterModel* LoadRasterModelFromFile(const char* path) {
+	RasterModelSourceInfo source;
+	if (!RasterFileStat(path, &source.size, &source.modificationTime)) return LoadRasterModelFromObj(path);
+
+	char* binaryPath = NULL;
+	if (!Malloc(binaryPath, strlen(path) + strlen(RASTER_MODEL_BINARY_EXT) + 1)) return LoadRasterModelFromObj(path);
+	strcpy(binaryPath, path);
+	strcat(binaryPath, RASTER_MODEL_BINARY_EXT);
+
+	RasterModel* model = LoadRasterModelFromBinary(binaryPath, &source);
+	if (!model) {
+		model = LoadRasterModelFromObj(path);
+		if (model && !RasterModelSaveBinary(model, binaryPath, source)) {
+			LogMessage("Could not write the binary model \"%s\"\n", binaryPath);
+		}
+	}
+
+	FreeAndReturn(binaryPath, model);
+}
 
-	Free(model->faces->vertexIndeces);
-	Free(model->faces->texCoordIndices);
-	Free(model->faces->normalIndices);
-	Free(model->faces);
+// The model itself is in its arena
+void RasterModelFree(RasterModel* model) {
+	if (model->binaryFile.data) RasterFileMapClose(&model->binaryFile);
 
-	Free(model);
+	RasterArena arena = model->arena;
+	RasterArenaFree(&arena);
 }
@@ -0,0 +1,196 @@
+#include "RasterModelBinary.h"
+
+#include <stdio.h>
+
+#define BINARY_MAGIC "LRMB"
+#define BINARY_MAGIC_LEN 4
+#define BINARY_ALIGNMENT 8
+
+#define BINARY_TEMP_EXT ".tmp"
+
+static uint64_t AlignOffset(uint64_t offset) { return (offset + BINARY_ALIGNMENT - 1) & ~(uint64_t)(BINARY_ALIGNMENT - 1); }
+
+static uint64_t IndicesByteSize(const RasterModel* model) { return model->trianglesSize * 3 * RasterModelIndexSize(model->indexType); }
+
+static RasterModelBinaryHeader BuildHeader(const RasterModel* model, RasterModelSourceInfo source) {
+	RasterModelBinaryHeader header = (RasterModelBinaryHeader){
+		.version = RASTER_MODEL_BINARY_VERSION,
+		.source = source,
+		.verticesSize = model->verticesSize,
+		.trianglesSize = model->trianglesSize,
+		.indexType = model->indexType,
+		.meshletsSize = model->meshletsSize,
+	};
+	memcpy(header.magic, BINARY_MAGIC, BINARY_MAGIC_LEN);
+
+	uint64_t offset = AlignOffset(sizeof(RasterModelBinaryHeader));
+#define PlaceSection(sectionOffset, sectionSize)           \
+	{                                                      \
+		sectionOffset = offset;                            \
+		offset = AlignOffset(sectionOffset + sectionSize); \
+	}
+
+	PlaceSection(header.positionsOffset, header.verticesSize * sizeof(Vector3));
+	PlaceSection(header.texCoordsOffset, header.verticesSize * sizeof(Vector2));
+	PlaceSection(header.normalsOffset, header.verticesSize * sizeof(Vector3));
+	PlaceSection(header.colorsOffset, header.verticesSize * sizeof(Color));
+	PlaceSection(header.indicesOffset, IndicesByteSize(model));
+	PlaceSection(header.faceColorsOffset, header.trianglesSize * sizeof(Color));
+	PlaceSection(header.meshletsOffset, header.meshletsSize * sizeof(RasterMeshlet));
+
+	return header;
+}
+
+// ============= Saving =============
+
+typedef struct BinaryWriter {
+	FILE* file;
+	uint64_t position;
+} BinaryWriter;
+
+static bool WriteAt(BinaryWriter* writer, uint64_t offset, const void* data, size_t size) {
+	static const char zeros[BINARY_ALIGNMENT] = {0};
+
+	const uint64_t paddingSize = offset - writer->position;
+	if (paddingSize && fwrite(zeros, 1, paddingSize, writer->file) != paddingSize) return false;
+	if (size && fwrite(data, 1, size, writer->file) != size) return false;
+
+	writer->position = offset + size;
+	return true;
+}
+
+static bool WriteBinary(FILE* file, const RasterModel* model, RasterModelSourceInfo source) {
+	const RasterModelBinaryHeader header = BuildHeader(model, source);
+	BinaryWriter writer = (BinaryWriter){.file = file};
+
+	if (!WriteAt(&writer, 0, &header, sizeof(header))) return false;
+	if (!WriteAt(&writer, header.positionsOffset, model->positions, header.verticesSize * sizeof(Vector3))) return false;
+	if (!WriteAt(&writer, header.texCoordsOffset, model->texCoords, header.verticesSize * sizeof(Vector2))) return false;
+	if (!WriteAt(&writer, header.normalsOffset, model->normals, header.verticesSize * sizeof(Vector3))) return false;
+	if (!WriteAt(&writer, header.colorsOffset, model->colors, header.verticesSize * sizeof(Color))) return false;
+	if (!WriteAt(&writer, header.indicesOffset, model->indices, IndicesByteSize(model))) return false;
+	if (!WriteAt(&writer, header.faceColorsOffset, model->faceColors, header.trianglesSize * sizeof(Color))) return false;
+	if (!WriteAt(&writer, header.meshletsOffset, model->meshlets, header.meshletsSize * sizeof(RasterMeshlet))) return false;
+
+	return true;
+}
+
+// Written to a temporary file renamed at the end, so readers never map a half-written binary
+bool RasterModelSaveBinary(const RasterModel* model, const char* path, RasterModelSourceInfo source) {
+	char* tempPath = NULL;
+	if (!Malloc(tempPath, strlen(path) + strlen(BINARY_TEMP_EXT) + 1)) return false;
+	strcpy(tempPath, path);
+	strcat(tempPath, BINARY_TEMP_EXT);
+
+	FILE* file = TryOpenFile(tempPath, "wb");
+	if (!file) FreeAndReturn(tempPath, false);
+
+	bool success = WriteBinary(file, model, source);
+	success = (fflush(file) == 0) && success;
+	CloseFile(file);
+
+	success = success && (rename(tempPath, path) == 0);
+	if (!success) remove(tempPath);
+
+	FreeAndReturn(tempPath, success);
+}
+
+// ============= Loading =============
+
+static bool IsSectionValid(uint64_t offset, uint64_t count, uint64_t elementSize, uint64_t fileSize) {
+	if (offset % BINARY_ALIGNMENT || offset > fileSize) return false;
+	return count <= (fileSize - offset) / elementSize;
+}
+
+static bool IsHeaderValid(const RasterModelBinaryHeader* header, uint64_t fileSize) {
+	if (fileSize < sizeof(RasterModelBinaryHeader)) return false;
+	if (memcmp(header->magic, BINARY_MAGIC, BINARY_MAGIC_LEN) || header->version != RASTER_MODEL_BINARY_VERSION) return false;
+	if (header->indexType != RASTER_INDEX_UINT16 && header->indexType != RASTER_INDEX_UINT32) return false;
+	if (header->trianglesSize > UINT64_MAX / 3) return false;
+
+	const uint64_t indexSize = RasterModelIndexSize(header->indexType);
+	return IsSectionValid(header->positionsOffset, header->verticesSize, sizeof(Vector3), fileSize) &&
+		   IsSectionValid(header->texCoordsOffset, header->verticesSize, sizeof(Vector2), fileSize) &&
+		   IsSectionValid(header->normalsOffset, header->verticesSize, sizeof(Vector3), fileSize) &&
+		   IsSectionValid(header->colorsOffset, header->verticesSize, sizeof(Color), fileSize) &&
+		   IsSectionValid(header->indicesOffset, header->trianglesSize * 3, indexSize, fileSize) &&
+		   IsSectionValid(header->faceColorsOffset, header->trianglesSize, sizeof(Color), fileSize) &&
+		   IsSectionValid(header->meshletsOffset, header->meshletsSize, sizeof(RasterMeshlet), fileSize);
+}
+
+static bool AreIndicesValid(const RasterModel* model, size_t firstTriangle, size_t trianglesCount, size_t firstVertex,
+							size_t verticesCount) {
+	const size_t indicesEnd = (firstTriangle + trianglesCount) * 3;
+	for (size_t i = firstTriangle * 3; i < indicesEnd; i++) {
+		const uint32_t index = RasterModelGetIndex(model, i);
+		if (index < firstVertex || index - firstVertex >= verticesCount) return false;
+	}
+	return true;
+}
+
+// Meshlets must cover every triangle in order, and their triangles only use the meshlet's vertices, as only those
+// are transformed
+static bool AreMeshletsValid(const RasterModel* model) {
+	if (!model->meshletsSize) return AreIndicesValid(model, 0, model->trianglesSize, 0, model->verticesSize);
+
+	size_t nextTriangle = 0;
+	for (size_t i = 0; i < model->meshletsSize; i++) {
+		const RasterMeshlet* meshlet = model->meshlets + i;
+		if (meshlet->firstTriangle != nextTriangle || meshlet->trianglesCount > model->trianglesSize - nextTriangle) return false;
+		if (meshlet->firstVertex > model->verticesSize || meshlet->verticesCount > model->verticesSize - meshlet->firstVertex) return false;
+		if (!AreIndicesValid(model, meshlet->firstTriangle, meshlet->trianglesCount, meshlet->firstVertex, meshlet->verticesCount)) {
+			return false;
+		}
+		nextTriangle += meshlet->trianglesCount;
+	}
+	return nextTriangle == model->trianglesSize;
+}
+
+#define LoadRasterModelFromBinaryExitFail() \
+	{                                       \
+		RasterModelFree(model);             \
+		return NULL;                        \
+	}
+
+// Nothing is allocated but the model itself (with empty arrays), every array is used in place from the mapping
+RasterModel* LoadRasterModelFromBinary(const char* path, const RasterModelSourceInfo* expectedSource) {
+	uint64_t fileSize;
+	int64_t modificationTime;
+	if (!RasterFileStat(path, &fileSize, &modificationTime)) return NULL;
+
+	RasterModel* model = RasterModelCreate(0, 0, 0);
+	if (!model) return NULL;
+
+	if (!RasterFileMapOpen(&model->binaryFile, path)) LoadRasterModelFromBinaryExitFail();
+
+	const char* data = model->binaryFile.data;
+	const RasterModelBinaryHeader* header = (const RasterModelBinaryHeader*)data;
+	if (!IsHeaderValid(header, model->binaryFile.size)) {
+		LogMessage("Invalid or outdated binary model \"%s\"\n", path);
+		LoadRasterModelFromBinaryExitFail();
+	}
+
+	if (expectedSource && (header->source.size != expectedSource->size || header->source.modificationTime != expectedSource->modificationTime)) {
+		LoadRasterModelFromBinaryExitFail();
+	}
+
+	model->positions = (Vector3*)(data + header->positionsOffset);
+	model->texCoords = (Vector2*)(data + header->texCoordsOffset);
+	model->normals = (Vector3*)(data + header->normalsOffset);
+	model->colors = (Color*)(data + header->colorsOffset);
+	model->verticesSize = header->verticesSize;
+	model->indices = (void*)(data + header->indicesOffset);
+	model->indexType = header->indexType;
+	model->trianglesSize = header->trianglesSize;
+	model->faceColors = (Color*)(data + header->faceColorsOffset);
+	model->meshlets = (RasterMeshlet*)(data + header->meshletsOffset);
+	model->meshletsSize = header->meshletsSize;
+
+	if (!AreMeshletsValid(model)) {
+		LogMessage("Corrupted binary model \"%s\"\n", path);
+		LoadRasterModelFromBinaryExitFail();
+	}
+
+	RasterModelUpdateBounds(model);
+	return model;
+}
@@ -0,0 +1,118 @@
+#include "RasterPipeline.h"
+
+static void RenderFrame(RasterPipeline* pipeline) {
+	RasterTargetBeginFrameStats(pipeline->screen);
+	pipeline->render(pipeline->userData, pipeline->screen);
+	// Resolved on the render thread, before the frame is swapped out
+	RasterTargetResolve(pipeline->screen);
+	pipeline->renderedStats = *RasterTargetEndFrameStats(pipeline->screen);
+}
+
+static void* RenderMain(void* userData) {
+	RasterPipeline* pipeline = userData;
+
+	pthread_mutex_lock(&pipeline->mutex);
+	while (true) {
+		while (pipeline->renderedCount == pipeline->startedCount && !pipeline->stopping) {
+			pthread_cond_wait(&pipeline->startedCond, &pipeline->mutex);
+		}
+		if (pipeline->renderedCount == pipeline->startedCount) break;
+		pthread_mutex_unlock(&pipeline->mutex);
+
+		RenderFrame(pipeline);
+
+		pthread_mutex_lock(&pipeline->mutex);
+		pipeline->renderedCount++;
+		pthread_cond_signal(&pipeline->renderedCond);
+	}
+	pthread_mutex_unlock(&pipeline->mutex);
+
+	return NULL;
+}
+
+RasterPipeline* RasterPipelineCreate(RasterTarget* screen, RasterPipelineRenderFunc render, void* userData, bool threaded) {
+	RasterPipeline* pipeline = NULL;
+	if (!Malloc(pipeline, sizeof(RasterPipeline))) return NULL;
+	*pipeline = (RasterPipeline){.screen = screen, .render = render, .userData = userData};
+
+	pipeline->front = RasterTargetBufferCreate(screen);
+	if (!pipeline->front) FreeAndReturn(pipeline, NULL);
+	RasterStatsInit(&pipeline->presentStats);
+
+	pthread_mutex_init(&pipeline->mutex, NULL);
+	pthread_cond_init(&pipeline->startedCond, NULL);
+	pthread_cond_init(&pipeline->renderedCond, NULL);
+
+	if (threaded) {
+		pipeline->threaded = !pthread_create(&pipeline->thread, NULL, RenderMain, pipeline);
+		if (!pipeline->threaded) LogString("Could not start the render thread, rendering on the presenting thread\n");
+	}
+
+	return pipeline;
+}
+
+void RasterPipelineFree(RasterPipeline* pipeline) {
+	if (pipeline->threaded) {
+		pthread_mutex_lock(&pipeline->mutex);
+		pipeline->stopping = true;
+		pthread_cond_signal(&pipeline->startedCond);
+		pthread_mutex_unlock(&pipeline->mutex);
+		pthread_join(pipeline->thread, NULL);
+	}
+
+	pthread_cond_destroy(&pipeline->renderedCond);
+	pthread_cond_destroy(&pipeline->startedCond);
+	pthread_mutex_destroy(&pipeline->mutex);
+
+	RasterTargetBufferFree(pipeline->front);
+	Free(pipeline);
+}
+
+void RasterPipelineRender(RasterPipeline* pipeline) {
+	pthread_mutex_lock(&pipeline->mutex);
+	if (pipeline->startedCount == pipeline->swappedCount) {
+		pipeline->startedCount++;
+		pthread_cond_signal(&pipeline->startedCond);
+	}
+	pthread_mutex_unlock(&pipeline->mutex);
+}
+
+const RasterTargetBuffer* RasterPipelineWait(RasterPipeline* pipeline) {
+	const uint64_t waitStartNs = RasterStatsMonotonicNs();
+	RasterPipelineRender(pipeline);
+
+	if (pipeline->threaded) {
+		pthread_mutex_lock(&pipeline->mutex);
+		while (pipeline->renderedCount != pipeline->startedCount) {
+			pthread_cond_wait(&pipeline->renderedCond, &pipeline->mutex);
+		}
+		pthread_mutex_unlock(&pipeline->mutex);
+	} else {
+		RenderFrame(pipeline);
+		pipeline->renderedCount++;
+	}
+
+	// The render thread is idle until the next frame is started
+	RasterTargetSwapBuffer(pipeline->screen, pipeline->front);
+	pipeline->swappedCount = pipeline->renderedCount;
+
+	const uint64_t nowNs = RasterStatsMonotonicNs();
+	pipeline->frontStats = pipeline->renderedStats;
+	pipeline->frontStats.waitNs = nowNs - waitStartNs;
+	pipeline->frontStats.intervalNs = pipeline->lastSwapNs ? nowNs - pipeline->lastSwapNs : 0.0;
+	pipeline->lastSwapNs = nowNs;
+
+	RasterStatsBeginFrame(&pipeline->presentStats);
+	return pipeline->front;
+}
+
+const RasterFrameStats* RasterPipelineEndPresent(RasterPipeline* pipeline) {
+	const RasterFrameStats* present = RasterStatsEndFrame(&pipeline->presentStats, 0);
+
+	RasterFrameStats* frame = &pipeline->frontStats;
+	frame->frameNs += present->frameNs;
+	for (uint32_t i = 0; i < RASTER_STAGE_COUNT; i++) frame->stagesNs[i] += present->stagesNs[i];
+
+	pipeline->last = *frame;
+	return &pipeline->last;
+}
@@ -0,0 +1,248 @@
+#include "RasterSamples.h"
+
+// Sample positions relative to the pixel's center, in sixteenths of a pixel, both patterns put each sample on its own
+// row and column so near horizontal and near vertical edges get as many coverage levels as there are samples
+#define SAMPLE_GRID 16
+
+static const int8_t samplePositions4[4][2] = {{-2, -6}, {6, -2}, {-6, 2}, {2, 6}};
+static const int8_t samplePositions8[8][2] = {{1, -3}, {-1, 3}, {5, 1}, {-3, -5}, {-5, 5}, {-7, -1}, {3, 7}, {7, -7}};
+
+#define RasterSampleBufferCreateExitFail()                \
+	{                                                     \
+		if (samples->masks) Free(samples->masks);         \
+		if (samples->secondary) Free(samples->secondary); \
+		FreeAndReturn(samples, NULL);                     \
+	}
+
+RasterSampleBuffer* RasterSampleBufferCreate(uint32_t width, uint32_t height, uint32_t samplesCount) {
+	if (samplesCount != 4 && samplesCount != 8) return NULL;
+
+	RasterSampleBuffer* samples = NULL;
+	if (!Malloc(samples, sizeof(RasterSampleBuffer))) return NULL;
+
+	*samples = (RasterSampleBuffer){
+		.samplesCount = samplesCount,
+		.fullMask = (1u << samplesCount) - 1,
+		.width = width,
+		.height = height,
+		.maxWidth = width,
+		.maxHeight = height,
+	};
+
+	if (!Malloc(samples->masks, (size_t)width * height)) RasterSampleBufferCreateExitFail();
+	if (!Malloc(samples->secondary, (size_t)width * height * sizeof(Color))) RasterSampleBufferCreateExitFail();
+
+	RasterSampleBufferClear(samples);
+	return samples;
+}
+
+void RasterSampleBufferFree(RasterSampleBuffer* samples) {
+	Free(samples->masks);
+	Free(samples->secondary);
+	Free(samples);
+}
+
+bool RasterSampleBufferSetSize(RasterSampleBuffer* samples, uint32_t width, uint32_t height) {
+	if (width > samples->maxWidth || height > samples->maxHeight) return false;
+
+	samples->width = width;
+	samples->height = height;
+	RasterSampleBufferClear(samples);
+	return true;
+}
+
+void RasterSampleBufferClear(RasterSampleBuffer* samples) {
+	memset(samples->masks, samples->fullMask, (size_t)samples->width * samples->height);
+	samples->unresolved = false;
+}
+
+// The secondary colors of full masks are never read, so they are left as they are
+void RasterSampleBufferClearRect(RasterSampleBuffer* samples, RasterRect rect) {
+	for (int32_t y = rect.minY; y < rect.maxY; y++) {
+		memset(samples->masks + Index1D(rect.minX, y, samples->width), samples->fullMask, rect.maxX - rect.minX);
+	}
+}
+
+static uint8_t BlendChannel(uint32_t primary, uint32_t secondary, uint32_t primaryCount, uint32_t samplesCount) {
+	return (primary * primaryCount + secondary * (samplesCount - primaryCount) + samplesCount / 2) / samplesCount;
+}
+
+void RasterSampleBufferResolve(RasterSampleBuffer* samples, Color* pixels, RasterRect rect) {
+	const uint32_t count = samples->samplesCount;
+
+	for (int32_t y = rect.minY; y < rect.maxY; y++) {
+		for (int32_t x = rect.minX; x < rect.maxX; x++) {
+			const size_t index = Index1D(x, y, samples->width);
+			const uint32_t mask = samples->masks[index];
+			if (mask == samples->fullMask) continue;
+
+			const uint32_t covered = __builtin_popcount(mask);
+			const Color primary = pixels[index];
+			const Color secondary = samples->secondary[index];
+			pixels[index] = (Color){
+				.r = BlendChannel(primary.r, secondary.r, covered, count),
+				.g = BlendChannel(primary.g, secondary.g, covered, count),
+				.b = BlendChannel(primary.b, secondary.b, covered, count),
+				.a = BlendChannel(primary.a, secondary.a, covered, count),
+			};
+			samples->masks[index] = samples->fullMask;
+		}
+	}
+}
+
+// The covered samples get col, and the pixel keeps at most two colors
+static inline void CoverSamples(RasterSampleBuffer* samples, Color* pixels, size_t index, uint32_t covered, Color col) {
+	const uint32_t full = samples->fullMask;
+	const uint32_t mask = samples->masks[index];
+	Color* secondary = samples->secondary + index;
+
+	if (covered == full) {
+		pixels[index] = col;
+		samples->masks[index] = full;
+		return;
+	}
+
+	if (RasterColorBits(col) == RasterColorBits(pixels[index])) {
+		samples->masks[index] = mask | covered;
+		return;
+	}
+
+	if (mask != full && RasterColorBits(col) == RasterColorBits(*secondary)) {
+		const uint32_t left = mask & ~covered;
+		samples->masks[index] = left ? left : full;
+		if (!left) pixels[index] = col;
+		return;
+	}
+
+	// Of the pixel's two colors, the one left with more samples becomes the secondary color, and takes the other's samples
+	const uint32_t primaryLeft = __builtin_popcount(mask & ~covered);
+	const uint32_t secondaryLeft = __builtin_popcount(~mask & ~covered & full);
+	if (primaryLeft >= secondaryLeft) *secondary = pixels[index];
+	pixels[index] = col;
+	samples->masks[index] = covered;
+}
+
+// A triangle behind the pixel's depth can still be in front of what its secondary color holds (often the background,
+// or the other side of a silhouette), so it becomes the secondary color if it covers any of its samples
+static inline bool CoversSecondary(const RasterSampleBuffer* samples, size_t index, uint32_t covered) {
+	return covered & ~samples->masks[index] & samples->fullMask;
+}
+
+// Each pixel with a covered sample is shaded once, at its center, pixels with every sample inside of the triangle are
+// found from the row spans of the triangle shrunk by the samples' offsets, and the others (along the edges) from the
+// spans of the grown triangle, their samples being tested one by one
+// Depth is tested once per pixel too, at its center, and only stored by the triangle covering that center, so the
+// triangles sharing an edge both get their samples in the pixels along it
+static inline __attribute__((always_inline)) RasterFillCounts FillSamples(const RasterFillTarget* target, const RasterTriangle* tri,
+																		   const RasterShader* shader, bool depthTested,
+																		   RasterShadeKernel kernel) {
+	RasterSampleBuffer* samples = target->samples;
+	const uint32_t samplesCount = samples->samplesCount;
+	const int8_t(*positions)[2] = (samplesCount == 8) ? samplePositions8 : samplePositions4;
+
+	// Steps are whole multiples of RASTER_SUBPIXEL_ONE, so the offsets are exact
+	int64_t offsets[3][RASTER_MAX_SAMPLES];
+	RasterTriangle grown = *tri;
+	RasterTriangle shrunk = *tri;
+	for (uint32_t i = 0; i < 3; i++) {
+		const RasterEdge* edge = tri->edges + i;
+		int64_t minOffset = INT64_MAX;
+		int64_t maxOffset = INT64_MIN;
+		for (uint32_t s = 0; s < samplesCount; s++) {
+			offsets[i][s] = (edge->stepX * positions[s][0] + edge->stepY * positions[s][1]) / SAMPLE_GRID;
+			minOffset = Min(minOffset, offsets[i][s]);
+			maxOffset = Max(maxOffset, offsets[i][s]);
+		}
+		grown.edges[i].origin += maxOffset;
+		shrunk.edges[i].origin += minOffset;
+	}
+
+	RasterFillCounts counts = (RasterFillCounts){0};
+	bool stored = false;
+	for (int32_t y = tri->bounds.minY; y < tri->bounds.maxY; y++) {
+		int32_t spanMinX;
+		int32_t spanMaxX;
+		if (!RasterTriangleRowSpan(&grown, y, &spanMinX, &spanMaxX)) continue;
+
+		int32_t fullMinX;
+		int32_t fullMaxX;
+		if (!RasterTriangleRowSpan(&shrunk, y, &fullMinX, &fullMaxX)) fullMinX = fullMaxX = spanMaxX;
+
+		const int64_t rowOffset = y - tri->bounds.minY;
+		const int64_t rowValues[3] = {
+			tri->edges[0].origin + tri->edges[0].stepY * rowOffset,
+			tri->edges[1].origin + tri->edges[1].stepY * rowOffset,
+			tri->edges[2].origin + tri->edges[2].stepY * rowOffset,
+		};
+
+		for (int32_t x = spanMinX; x < spanMaxX; x++) {
+			uint32_t covered = samples->fullMask;
+			bool centerCovered = true;
+			if (x < fullMinX || x >= fullMaxX) {
+				const int64_t colOffset = x - tri->bounds.minX;
+				const int64_t values[3] = {
+					rowValues[0] + tri->edges[0].stepX * colOffset,
+					rowValues[1] + tri->edges[1].stepX * colOffset,
+					rowValues[2] + tri->edges[2].stepX * colOffset,
+				};
+
+				centerCovered = (values[0] >= 0) && (values[1] >= 0) && (values[2] >= 0);
+				covered = 0;
+				for (uint32_t s = 0; s < samplesCount; s++) {
+					const bool inside = (values[0] + offsets[0][s] >= 0) && (values[1] + offsets[1][s] >= 0) && (values[2] + offsets[2][s] >= 0);
+					covered |= (uint32_t)inside << s;
+				}
+				if (!covered) continue;
+			}
+
+			const size_t index = Index1D(x, y, samples->width);
+			counts.tested++;
+			if (depthTested && !RasterDepthBufferTestPixel(target->depth, &tri->depth, x, y, centerCovered)) {
+				if (!CoversSecondary(samples, index, covered)) continue;
+				samples->secondary[index] = RasterShadePixel(shader, kernel, x, y);
+				counts.written++;
+				continue;
+			}
+			stored |= depthTested && centerCovered;
+
+			CoverSamples(samples, target->pixels, index, covered, RasterShadePixel(shader, kernel, x, y));
+			counts.written++;
+		}
+	}
+
+	if (stored) RasterDepthBufferUpdateFarthest(target->depth, tri->bounds);
+	return counts;
+}
+
+#define DefineFillSamples(name, depthTested, kernel)                                                                      \
+	static RasterFillCounts name(const RasterFillTarget* target, const RasterTriangle* tri, const RasterShader* shader) { \
+		return FillSamples(target, tri, shader, depthTested, kernel);                                                     \
+	}
+
+#define DefineFillSamplesKernel(name, kernel) \
+	DefineFillSamples(name, false, kernel);   \
+	DefineFillSamples(name##Depth, true, kernel)
+
+DefineFillSamplesKernel(FillSamplesFlat, RASTER_KERNEL_FLAT);
+DefineFillSamplesKernel(FillSamplesGouraud, RASTER_KERNEL_GOURAUD);
+DefineFillSamplesKernel(FillSamplesNearest, RASTER_KERNEL_NEAREST);
+DefineFillSamplesKernel(FillSamplesBilinear, RASTER_KERNEL_BILINEAR);
+
+RasterFillFunc RasterSampleBufferSelectFill(RasterDepthFormat format, RasterShadeKernel kernel) {
+	static const RasterFillFunc fills[RASTER_KERNEL_COUNT] = {
+		[RASTER_KERNEL_FLAT] = FillSamplesFlat,
+		[RASTER_KERNEL_GOURAUD] = FillSamplesGouraud,
+		[RASTER_KERNEL_NEAREST] = FillSamplesNearest,
+		[RASTER_KERNEL_BILINEAR] = FillSamplesBilinear,
+	};
+	static const RasterFillFunc fillsDepth[RASTER_KERNEL_COUNT] = {
+		[RASTER_KERNEL_FLAT] = FillSamplesFlatDepth,
+		[RASTER_KERNEL_GOURAUD] = FillSamplesGouraudDepth,
+		[RASTER_KERNEL_NEAREST] = FillSamplesNearestDepth,
+		[RASTER_KERNEL_BILINEAR] = FillSamplesBilinearDepth,
+	};
+
+	// Depth only draws have no samples to cover, only the depths of the pixels' centers to store
+	if (kernel == RASTER_KERNEL_DEPTH_ONLY) return RasterDepthBufferSelectFill(format, kernel);
+	return (format == RASTER_DEPTH_NONE) ? fills[kernel] : fillsDepth[kernel];
+}
@@ -0,0 +1,332 @@
+#include "RasterScene.h"
+
+#include <string.h>
+
+DefineArrayMethods(RasterSceneObject, RasterSceneObjectArray);
+DefineArrayMethods(uint32_t, RasterSceneIdArray);
+DefineArrayMethods(Matrix, RasterSceneTransformArray);
+
+#define DEFAULT_OBJECTS_CAPACITY 64
+
+// Deep enough for any hierarchy, as halving the objects at every level keeps it balanced
+#define CULL_STACK_SIZE 64
+#define ALL_PLANES_MASK ((1 << 6) - 1)
+
+RasterScene* RasterSceneCreate(void) {
+	RasterScene* scene = NULL;
+	if (!Malloc(scene, sizeof(RasterScene))) return NULL;
+
+	*scene = (RasterScene){0};
+	scene->objects = RasterSceneObjectArrayCreate(DEFAULT_OBJECTS_CAPACITY);
+	scene->freeIds = RasterSceneIdArrayCreate(DEFAULT_OBJECTS_CAPACITY);
+	scene->visibleIds = RasterSceneIdArrayCreate(DEFAULT_OBJECTS_CAPACITY);
+	scene->drawTransforms = RasterSceneTransformArrayCreate(DEFAULT_OBJECTS_CAPACITY);
+	if (!scene->objects || !scene->freeIds || !scene->visibleIds || !scene->drawTransforms) {
+		RasterSceneFree(scene);
+		return NULL;
+	}
+
+	return scene;
+}
+
+static void FreeHierarchy(RasterScene* scene) {
+	if (scene->nodes) Free(scene->nodes);
+	if (scene->leafObjects) Free(scene->leafObjects);
+	scene->nodes = NULL;
+	scene->leafObjects = NULL;
+	scene->nodesSize = 0;
+}
+
+void RasterSceneFree(RasterScene* scene) {
+	if (scene->objects) RasterSceneObjectArrayFree(scene->objects);
+	if (scene->freeIds) RasterSceneIdArrayFree(scene->freeIds);
+	if (scene->visibleIds) RasterSceneIdArrayFree(scene->visibleIds);
+	if (scene->drawTransforms) RasterSceneTransformArrayFree(scene->drawTransforms);
+	FreeHierarchy(scene);
+
+	Free(scene);
+}
+
+// ============= Objects =============
+
+static void UpdateObjectBounds(RasterSceneObject* object) {
+	Vector3 center = object->model->boundsCenter;
+	float radius = object->model->boundsRadius;
+	RasterTransformSphere(object->transform, &center, &radius);
+
+	object->boundsMin = Vector3SubtractValue(center, radius);
+	object->boundsMax = Vector3AddValue(center, radius);
+}
+
+uint32_t RasterSceneAdd(RasterScene* scene, const RasterModel* model, Matrix transform) {
+	const RasterSceneObject object = (RasterSceneObject){.model = model, .transform = transform};
+
+	uint32_t id;
+	if (scene->freeIds->size) {
+		id = scene->freeIds->data[--scene->freeIds->size];
+		scene->objects->data[id] = object;
+	} else {
+		if (scene->objects->size >= RASTER_SCENE_INVALID_ID || !RasterSceneObjectArrayPush(scene->objects, object)) {
+			return RASTER_SCENE_INVALID_ID;
+		}
+		id = scene->objects->size - 1;
+	}
+
+	UpdateObjectBounds(scene->objects->data + id);
+	scene->objectsCount++;
+	scene->needsRebuild = true;
+	return id;
+}
+
+static bool IsObjectId(const RasterScene* scene, uint32_t id) { return id < scene->objects->size && scene->objects->data[id].model; }
+
+// The slot is only reused if it can be remembered
+void RasterSceneRemove(RasterScene* scene, uint32_t id) {
+	if (!IsObjectId(scene, id)) return;
+
+	scene->objects->data[id].model = NULL;
+	RasterSceneIdArrayPush(scene->freeIds, id);
+	scene->objectsCount--;
+	scene->needsRebuild = true;
+}
+
+void RasterSceneSetTransform(RasterScene* scene, uint32_t id, Matrix transform) {
+	if (!IsObjectId(scene, id)) return;
+
+	RasterSceneObject* object = scene->objects->data + id;
+	object->transform = transform;
+	UpdateObjectBounds(object);
+	scene->needsRefit = true;
+}
+
+// ============= Hierarchy =============
+
+// Sorting by the key sorts by value, then by id
+static uint64_t AxisSortKey(float value, uint32_t id) {
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	bits = (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+	return ((uint64_t)bits << 32) | id;
+}
+
+static int CompareSortKeys(const void* a, const void* b) {
+	const uint64_t keyA = *(const uint64_t*)a;
+	const uint64_t keyB = *(const uint64_t*)b;
+	return (keyA > keyB) - (keyA < keyB);
+}
+
+static float AxisValue(Vector3 v, uint32_t axis) { return (axis == 0) ? v.x : ((axis == 1) ? v.y : v.z); }
+
+static void LeafBounds(const RasterScene* scene, RasterSceneNode* node) {
+	const RasterSceneObject* objects = scene->objects->data;
+	const uint32_t* ids = scene->leafObjects + node->index;
+
+	node->boundsMin = objects[ids[0]].boundsMin;
+	node->boundsMax = objects[ids[0]].boundsMax;
+	for (uint32_t i = 1; i < node->objectsCount; i++) {
+		node->boundsMin = Vector3Min(node->boundsMin, objects[ids[i]].boundsMin);
+		node->boundsMax = Vector3Max(node->boundsMax, objects[ids[i]].boundsMax);
+	}
+}
+
+static void InnerBounds(const RasterScene* scene, RasterSceneNode* node) {
+	const RasterSceneNode* first = node + 1;
+	const RasterSceneNode* second = scene->nodes + node->index;
+	node->boundsMin = Vector3Min(first->boundsMin, second->boundsMin);
+	node->boundsMax = Vector3Max(first->boundsMax, second->boundsMax);
+}
+
+// Splits the objects in two halves along the longest axis of their centers' bounds, returns the node after the subtree
+static uint32_t BuildNode(RasterScene* scene, uint32_t nodeIndex, uint32_t first, uint32_t count, uint64_t* sortKeys) {
+	const RasterSceneObject* objects = scene->objects->data;
+	uint32_t* ids = scene->leafObjects + first;
+
+	RasterSceneNode* node = scene->nodes + nodeIndex;
+	if (count <= RASTER_SCENE_LEAF_SIZE) {
+		*node = (RasterSceneNode){.objectsCount = count, .index = first};
+		LeafBounds(scene, node);
+		return nodeIndex + 1;
+	}
+
+	Vector3 centersMin = Vector3Scale(Vector3Add(objects[ids[0]].boundsMin, objects[ids[0]].boundsMax), 0.5f);
+	Vector3 centersMax = centersMin;
+	for (uint32_t i = 1; i < count; i++) {
+		const Vector3 center = Vector3Scale(Vector3Add(objects[ids[i]].boundsMin, objects[ids[i]].boundsMax), 0.5f);
+		centersMin = Vector3Min(centersMin, center);
+		centersMax = Vector3Max(centersMax, center);
+	}
+
+	const Vector3 extent = Vector3Subtract(centersMax, centersMin);
+	const uint32_t axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : ((extent.y >= extent.z) ? 1 : 2);
+	for (uint32_t i = 0; i < count; i++) {
+		const RasterSceneObject* object = objects + ids[i];
+		sortKeys[i] = AxisSortKey(AxisValue(object->boundsMin, axis) + AxisValue(object->boundsMax, axis), ids[i]);
+	}
+
+	qsort(sortKeys, count, sizeof(uint64_t), CompareSortKeys);
+	for (uint32_t i = 0; i < count; i++) ids[i] = sortKeys[i] & UINT32_MAX;
+
+	const uint32_t firstHalf = count / 2;
+	const uint32_t secondNode = BuildNode(scene, nodeIndex + 1, first, firstHalf, sortKeys);
+	const uint32_t nextNode = BuildNode(scene, secondNode, first + firstHalf, count - firstHalf, sortKeys);
+
+	*node = (RasterSceneNode){.index = secondNode};
+	InnerBounds(scene, node);
+	return nextNode;
+}
+
+static bool Rebuild(RasterScene* scene) {
+	FreeHierarchy(scene);
+	if (!scene->objectsCount) return true;
+
+	// A leaf per object at worst, and one fewer inner nodes
+	const uint32_t count = scene->objectsCount;
+	uint64_t* sortKeys = NULL;
+	if (!Malloc(scene->nodes, (2 * (size_t)count - 1) * sizeof(RasterSceneNode))) return false;
+	if (!Malloc(scene->leafObjects, count * sizeof(uint32_t))) return false;
+	if (!Malloc(sortKeys, count * sizeof(uint64_t))) return false;
+
+	uint32_t leafObjectsSize = 0;
+	for (uint32_t id = 0; id < scene->objects->size; id++) {
+		if (scene->objects->data[id].model) scene->leafObjects[leafObjectsSize++] = id;
+	}
+
+	scene->nodesSize = BuildNode(scene, 0, 0, count, sortKeys);
+	FreeAndReturn(sortKeys, true);
+}
+
+// Children are always after their parent, so going backwards refits every child before its parent
+static void Refit(RasterScene* scene) {
+	for (uint32_t i = scene->nodesSize; i-- > 0;) {
+		RasterSceneNode* node = scene->nodes + i;
+		if (node->objectsCount) LeafBounds(scene, node);
+		else InnerBounds(scene, node);
+	}
+}
+
+bool RasterSceneUpdate(RasterScene* scene) {
+	if (scene->needsRebuild) {
+		if (!Rebuild(scene)) {
+			FreeHierarchy(scene);
+			LogString("Could not allocate the scene's hierarchy\n");
+			return false;
+		}
+	} else if (scene->needsRefit) {
+		Refit(scene);
+	}
+
+	scene->needsRebuild = false;
+	scene->needsRefit = false;
+	return true;
+}
+
+// ============= Culling =============
+
+// False if the box is outside of one of the planes in planesMask, the planes the box is entirely inside of are removed
+// from the mask, so the box's children skip them
+static bool BoxInFrustum(const RasterFrustum* frustum, Vector3 boundsMin, Vector3 boundsMax, uint32_t* planesMask) {
+	for (uint32_t i = 0; i < 6; i++) {
+		if (!(*planesMask & (1 << i))) continue;
+
+		// The corners furthest along the plane's normal and furthest against it
+		const Vector4 plane = frustum->planes[i];
+		const Vector3 inner = (Vector3){
+			(plane.x >= 0) ? boundsMax.x : boundsMin.x,
+			(plane.y >= 0) ? boundsMax.y : boundsMin.y,
+			(plane.z >= 0) ? boundsMax.z : boundsMin.z,
+		};
+		const Vector3 outer = (Vector3){
+			(plane.x >= 0) ? boundsMin.x : boundsMax.x,
+			(plane.y >= 0) ? boundsMin.y : boundsMax.y,
+			(plane.z >= 0) ? boundsMin.z : boundsMax.z,
+		};
+
+		if (plane.x * inner.x + plane.y * inner.y + plane.z * inner.z + plane.w < 0) return false;
+		if (plane.x * outer.x + plane.y * outer.y + plane.z * outer.z + plane.w >= 0) *planesMask &= ~(1 << i);
+	}
+	return true;
+}
+
+static int CompareIds(const void* a, const void* b) {
+	const uint32_t idA = *(const uint32_t*)a;
+	const uint32_t idB = *(const uint32_t*)b;
+	return (idA > idB) - (idA < idB);
+}
+
+typedef struct CullEntry {
+	uint32_t node;
+	uint32_t planesMask;  // Planes the node's parent isn't entirely inside of
+} CullEntry;
+
+bool RasterSceneCull(RasterScene* scene, Matrix viewProjection) {
+	scene->visibleIds->size = 0;
+	scene->nodesVisited = 0;
+	scene->objectsTested = 0;
+	if (!RasterSceneUpdate(scene)) return false;
+	if (!scene->nodesSize) return true;
+
+	const RasterFrustum frustum = RasterFrustumFromMatrix(viewProjection);
+	const RasterSceneObject* objects = scene->objects->data;
+
+	CullEntry stack[CULL_STACK_SIZE];
+	uint32_t stackSize = 0;
+	stack[stackSize++] = (CullEntry){.node = 0, .planesMask = ALL_PLANES_MASK};
+
+	while (stackSize) {
+		const CullEntry entry = stack[--stackSize];
+		const RasterSceneNode* node = scene->nodes + entry.node;
+		scene->nodesVisited++;
+
+		uint32_t planesMask = entry.planesMask;
+		if (!BoxInFrustum(&frustum, node->boundsMin, node->boundsMax, &planesMask)) continue;
+
+		if (!node->objectsCount) {
+			stack[stackSize++] = (CullEntry){.node = node->index, .planesMask = planesMask};
+			stack[stackSize++] = (CullEntry){.node = entry.node + 1, .planesMask = planesMask};
+			continue;
+		}
+
+		for (uint32_t i = 0; i < node->objectsCount; i++) {
+			const uint32_t id = scene->leafObjects[node->index + i];
+			uint32_t objectPlanesMask = planesMask;
+			scene->objectsTested++;
+			if (!BoxInFrustum(&frustum, objects[id].boundsMin, objects[id].boundsMax, &objectPlanesMask)) continue;
+			if (!RasterSceneIdArrayPush(scene->visibleIds, id)) return false;
+		}
+	}
+
+	qsort(scene->visibleIds->data, scene->visibleIds->size, sizeof(uint32_t), CompareIds);
+	return true;
+}
+
+// ============= Drawing =============
+
+bool RasterSceneDraw(RasterScene* scene, RasterTarget* screen) {
+	RasterStatsEnter(&screen->stats, RASTER_STAGE_TRANSFORM);
+	const bool culled = RasterSceneCull(scene, screen->viewProjection);
+	RasterStatsLeave(&screen->stats);
+	if (!culled) return false;
+
+	const RasterSceneObject* objects = scene->objects->data;
+	const uint32_t* ids = scene->visibleIds->data;
+	const size_t visibleSize = scene->visibleIds->size;
+	RasterSceneTransformArray* transforms = scene->drawTransforms;
+
+	// Models split in several meshlets are drawn one by one, so their meshlets get culled
+	for (size_t i = 0; i < visibleSize;) {
+		const RasterModel* model = objects[ids[i]].model;
+		if (model->meshletsSize > 1) {
+			RasterTargetDrawModelEx(screen, model, objects[ids[i]].transform);
+			i++;
+			continue;
+		}
+
+		transforms->size = 0;
+		for (; i < visibleSize && objects[ids[i]].model == model; i++) {
+			if (!RasterSceneTransformArrayPush(transforms, objects[ids[i]].transform)) return false;
+		}
+		RasterTargetDrawModelInstanced(screen, model, transforms->data, NULL, transforms->size);
+	}
+
+	return true;
+}
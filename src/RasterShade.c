@@ -0,0 +1,67 @@
+#include "RasterShade.h"
+
+void RasterColorPlanesSetup(RasterColorPlanes* planes, const RasterTriangle* tri, const Vector3 positions[3], const Vector3 colors[3]) {
+	planes->originX = tri->bounds.minX;
+	planes->originY = tri->bounds.minY;
+
+	const float values[3][3] = {
+		{colors[0].x, colors[1].x, colors[2].x},
+		{colors[0].y, colors[1].y, colors[2].y},
+		{colors[0].z, colors[1].z, colors[2].z},
+	};
+	RasterPlane channels[3];
+	RasterTriangleSetupPlanes(tri, (Vector2){positions[0].x, positions[0].y}, (Vector2){positions[1].x, positions[1].y},
+							  (Vector2){positions[2].x, positions[2].y}, values, 3, channels);
+	planes->r = channels[0];
+	planes->g = channels[1];
+	planes->b = channels[2];
+}
+
+// Every pixel of a span is shaded, flat triangles go through RasterTriangleFill's block kernels instead
+static inline __attribute__((always_inline)) RasterFillCounts FillSpans(const RasterTriangle* tri, const RasterShader* shader,
+																		 Color* pixels, uint32_t stride, RasterShadeKernel kernel) {
+	uint32_t written = 0;
+	for (int32_t y = tri->bounds.minY; y < tri->bounds.maxY; y++) {
+		int32_t spanMinX;
+		int32_t spanMaxX;
+		if (!RasterTriangleRowSpan(tri, y, &spanMinX, &spanMaxX)) continue;
+
+		Color* row = pixels + Index1D(0, y, stride);
+		for (int32_t x = spanMinX; x < spanMaxX; x++) row[x] = RasterShadePixel(shader, kernel, x, y);
+		written += spanMaxX - spanMinX;
+	}
+	return (RasterFillCounts){.tested = written, .written = written};
+}
+
+#define DefineFillSpans(name, kernel)                                                                                     \
+	static RasterFillCounts name(const RasterFillTarget* target, const RasterTriangle* tri, const RasterShader* shader) { \
+		return FillSpans(tri, shader, target->pixels, target->stride, kernel);                                            \
+	}
+
+DefineFillSpans(FillGouraud, RASTER_KERNEL_GOURAUD);
+DefineFillSpans(FillNearest, RASTER_KERNEL_NEAREST);
+DefineFillSpans(FillBilinear, RASTER_KERNEL_BILINEAR);
+
+static RasterFillCounts FillFlat(const RasterFillTarget* target, const RasterTriangle* tri, const RasterShader* shader) {
+	const uint32_t written = RasterTriangleFill(tri, target->pixels, target->stride, shader->col);
+	return (RasterFillCounts){.tested = written, .written = written};
+}
+
+// Without depths to write, there is nothing to do
+static RasterFillCounts FillNothing(const RasterFillTarget* target, const RasterTriangle* tri, const RasterShader* shader) {
+	(void)target;
+	(void)tri;
+	(void)shader;
+	return (RasterFillCounts){0};
+}
+
+RasterFillFunc RasterShadeSelectFill(RasterShadeKernel kernel) {
+	static const RasterFillFunc fills[RASTER_KERNEL_COUNT] = {
+		[RASTER_KERNEL_FLAT] = FillFlat,
+		[RASTER_KERNEL_GOURAUD] = FillGouraud,
+		[RASTER_KERNEL_NEAREST] = FillNearest,
+		[RASTER_KERNEL_BILINEAR] = FillBilinear,
+		[RASTER_KERNEL_DEPTH_ONLY] = FillNothing,
+	};
+	return fills[kernel];
+}
@@ -0,0 +1,139 @@
+#define _POSIX_C_SOURCE 200809L	 // clock_gettime
+
+#include "RasterStats.h"
+
+#include <time.h>
+
+#define OVERLAY_LINES_COUNT (RASTER_STAGE_COUNT + 7)
+#define OVERLAY_LINE_LEN 96
+
+static const char* stageNames[RASTER_STAGE_COUNT] = {
+	[RASTER_STAGE_OTHER] = "other",
+	[RASTER_STAGE_CLEAR] = "clear",
+	[RASTER_STAGE_TRANSFORM] = "transform",
+	[RASTER_STAGE_SETUP] = "setup",
+	[RASTER_STAGE_RASTER] = "raster",
+	[RASTER_STAGE_UPLOAD] = "upload",
+	[RASTER_STAGE_PRESENT] = "present",
+	[RASTER_STAGE_OUTPUT] = "output",
+};
+
+const char* RasterStageName(RasterStage stage) { return (stage < RASTER_STAGE_COUNT) ? stageNames[stage] : "unknown"; }
+
+uint64_t RasterStatsMonotonicNs(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void RasterStatsInit(RasterStats* stats) {
+	*stats = (RasterStats){0};
+	atomic_init(&stats->workerPixelsTested, 0);
+	atomic_init(&stats->workerPixelsWritten, 0);
+	RasterStatsBeginFrame(stats);
+}
+
+void RasterStatsBeginFrame(RasterStats* stats) {
+	const uint64_t frameIndex = stats->frame.frameIndex;
+
+	stats->frame = (RasterFrameStats){.frameIndex = frameIndex};
+	for (uint32_t i = 0; i < RASTER_STAGE_COUNT; i++) stats->stagesTicks[i] = 0;
+	atomic_store_explicit(&stats->workerPixelsTested, 0, memory_order_relaxed);
+	atomic_store_explicit(&stats->workerPixelsWritten, 0, memory_order_relaxed);
+
+	stats->frameStartNs = RasterStatsMonotonicNs();
+	stats->frameStartTicks = RasterStatsTicks();
+	stats->stage = RASTER_STAGE_OTHER;
+	stats->stageStartTicks = stats->frameStartTicks;
+}
+
+const RasterFrameStats* RasterStatsEndFrame(RasterStats* stats, uint64_t pixelsCount) {
+	RasterStatsSwitchStage(stats, RASTER_STAGE_OTHER);
+
+	RasterFrameStats* frame = &stats->frame;
+	frame->frameNs = RasterStatsMonotonicNs() - stats->frameStartNs;
+
+	// The ticks' rate is measured over the frame itself, against the monotonic clock
+	const uint64_t frameTicks = stats->stageStartTicks - stats->frameStartTicks;
+	const double nsPerTick = frameTicks ? frame->frameNs / frameTicks : 0.0;
+	for (uint32_t i = 0; i < RASTER_STAGE_COUNT; i++) {
+		frame->stagesNs[i] = stats->stagesTicks[i] * nsPerTick;
+	}
+
+	frame->pixelsTested += atomic_load_explicit(&stats->workerPixelsTested, memory_order_relaxed);
+	frame->pixelsWritten += atomic_load_explicit(&stats->workerPixelsWritten, memory_order_relaxed);
+	frame->overdraw = pixelsCount ? (double)frame->pixelsWritten / pixelsCount : 0.0;
+
+	stats->last = *frame;
+	frame->frameIndex++;
+	return &stats->last;
+}
+
+bool RasterStatsWriteCSVHeader(FILE* file) {
+	bool success = fprintf(file, "frame,frame_ns") >= 0;
+	for (uint32_t i = 0; i < RASTER_STAGE_COUNT; i++) {
+		success = (fprintf(file, ",%s_ns", RasterStageName(i)) >= 0) && success;
+	}
+	success = (fprintf(file, ",triangles_submitted,triangles_culled,triangles_drawn,pixels_tested,pixels_written,overdraw") >= 0) && success;
+	success = (fprintf(file, ",wait_ns,interval_ns,width,height\n") >= 0) && success;
+	return success;
+}
+
+bool RasterStatsWriteCSV(FILE* file, const RasterFrameStats* frame) {
+	bool success = fprintf(file, "%llu,%.0f", (unsigned long long)frame->frameIndex, frame->frameNs) >= 0;
+	for (uint32_t i = 0; i < RASTER_STAGE_COUNT; i++) {
+		success = (fprintf(file, ",%.0f", frame->stagesNs[i]) >= 0) && success;
+	}
+	success = (fprintf(file, ",%llu,%llu,%llu,%llu,%llu,%.4f,%.0f,%.0f,%u,%u\n", (unsigned long long)frame->trianglesSubmitted,
+					   (unsigned long long)frame->trianglesCulled, (unsigned long long)frame->trianglesDrawn,
+					   (unsigned long long)frame->pixelsTested, (unsigned long long)frame->pixelsWritten, frame->overdraw, frame->waitNs,
+					   frame->intervalNs, frame->width, frame->height) >= 0) &&
+			  success;
+	return success;
+}
+
+bool RasterStatsWriteJSON(FILE* file, const RasterFrameStats* frame) {
+	bool success = fprintf(file, "{\"frame\":%llu,\"frame_ns\":%.0f", (unsigned long long)frame->frameIndex, frame->frameNs) >= 0;
+	for (uint32_t i = 0; i < RASTER_STAGE_COUNT; i++) {
+		success = (fprintf(file, ",\"%s_ns\":%.0f", RasterStageName(i), frame->stagesNs[i]) >= 0) && success;
+	}
+	success = (fprintf(file,
+					   ",\"triangles_submitted\":%llu,\"triangles_culled\":%llu,\"triangles_drawn\":%llu,\"pixels_tested\":%llu,"
+					   "\"pixels_written\":%llu,\"overdraw\":%.4f,\"wait_ns\":%.0f,\"interval_ns\":%.0f,\"width\":%u,\"height\":%u}\n",
+					   (unsigned long long)frame->trianglesSubmitted, (unsigned long long)frame->trianglesCulled,
+					   (unsigned long long)frame->trianglesDrawn, (unsigned long long)frame->pixelsTested,
+					   (unsigned long long)frame->pixelsWritten, frame->overdraw, frame->waitNs, frame->intervalNs, frame->width,
+					   frame->height) >= 0) &&
+			  success;
+	return success;
+}
+
+#ifndef RASTER_HEADLESS
+void RasterStatsDrawOverlay(const RasterFrameStats* frame, int32_t fontSize) {
+	char lines[OVERLAY_LINES_COUNT][OVERLAY_LINE_LEN];
+	uint32_t linesCount = 0;
+
+	snprintf(lines[linesCount++], OVERLAY_LINE_LEN, "Frame %llu: %.2f ms", (unsigned long long)frame->frameIndex, frame->frameNs * 1e-6);
+	for (uint32_t i = 0; i < RASTER_STAGE_COUNT; i++) {
+		snprintf(lines[linesCount++], OVERLAY_LINE_LEN, "  %-9s %6.2f ms", RasterStageName(i), frame->stagesNs[i] * 1e-6);
+	}
+	snprintf(lines[linesCount++], OVERLAY_LINE_LEN, "Triangles: %llu submitted, %llu culled, %llu drawn",
+			 (unsigned long long)frame->trianglesSubmitted, (unsigned long long)frame->trianglesCulled,
+			 (unsigned long long)frame->trianglesDrawn);
+	snprintf(lines[linesCount++], OVERLAY_LINE_LEN, "Pixels: %llu tested, %llu written", (unsigned long long)frame->pixelsTested,
+			 (unsigned long long)frame->pixelsWritten);
+	snprintf(lines[linesCount++], OVERLAY_LINE_LEN, "Overdraw: %.2f", frame->overdraw);
+	snprintf(lines[linesCount++], OVERLAY_LINE_LEN, "Pacing: %.2f ms apart, %.2f ms waited", frame->intervalNs * 1e-6, frame->waitNs * 1e-6);
+	snprintf(lines[linesCount++], OVERLAY_LINE_LEN, "Resolution: %ux%u", frame->width, frame->height);
+	if (!RASTER_STATS_ENABLED) snprintf(lines[linesCount++], OVERLAY_LINE_LEN, "(built without STATS=1)");
+
+	const int32_t lineHeight = fontSize + fontSize / 4;
+	int32_t width = 0;
+	for (uint32_t i = 0; i < linesCount; i++) width = Max(width, MeasureText(lines[i], fontSize));
+
+	DrawRectangle(0, 0, width + fontSize, linesCount * lineHeight + fontSize / 2, (Color){0, 0, 0, 160});
+	for (uint32_t i = 0; i < linesCount; i++) {
+		DrawText(lines[i], fontSize / 2, fontSize / 4 + i * lineHeight, fontSize, RAYWHITE);
+	}
+}
+#endif
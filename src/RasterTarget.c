@@ -1,5 +1,45 @@
 #include "RasterTarget.h"
 
+#include "RasterArena.h"
+#include "RasterFill.h"
+
+#define DEFAULT_SCREEN_HEIGHT_IN_WORLD 5.0f
+
+// Vertices transformed per job when the transform stage runs on the thread pool
+#define TRANSFORM_JOB_SIZE 8192
+// Instanced draws transform as many instances at once as fit in that many vertices (at least one)
+#define INSTANCE_BATCH_VERTICES 65536
+// Visible meshlets transformed per job, about as many vertices as TRANSFORM_JOB_SIZE
+#define MESHLET_JOB_SIZE (TRANSFORM_JOB_SIZE / RASTER_MESHLET_MAX_VERTICES)
+// Share of the color RASTER_SHADING_LAMBERT gives to faces turned away from the light
+#define LAMBERT_AMBIENT 0.25f
+// Direction the light shines in, into the default view (which looks towards +z, with +y down) from its top left
+#define DEFAULT_LIGHT_DIRECTION ((Vector3){0.5f, 1.0f, 1.0f})
+// Past that share of the target being dirty, one full upload is cheaper than packing and uploading the dirty rects
+#define PARTIAL_UPLOAD_MAX_PERCENT 50
+
+static uint32_t TilesCount(uint32_t pixelsCount) { return (pixelsCount + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE; }
+
+// Of a width by height frame, clamped to it
+static RasterRect TileRect(uint32_t width, uint32_t height, uint32_t tileIndex) {
+	const int32_t tilesX = TilesCount(width);
+	const int32_t tileX = tileIndex % tilesX;
+	const int32_t tileY = tileIndex / tilesX;
+
+	return (RasterRect){
+		.minX = tileX * RASTER_TILE_SIZE,
+		.minY = tileY * RASTER_TILE_SIZE,
+		.maxX = Min((tileX + 1) * RASTER_TILE_SIZE, (int32_t)width),
+		.maxY = Min((tileY + 1) * RASTER_TILE_SIZE, (int32_t)height),
+	};
+}
+
+// Of the whole target, every tile flags array is allocated for it
+static uint32_t RasterTargetMaxTileCount(const RasterTarget* screen) {
+	return TilesCount(screen->maxWidth) * TilesCount(screen->maxHeight);
+}
+
+#ifndef RASTER_HEADLESS
 static Image RasterTargetToImage(const RasterTarget* screen) {
 	return (Image){
 		.data = screen->pixels,
@@ -9,114 +49,577 @@ static Image RasterTargetToImage(const RasterTarget* screen) {
 		.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8,
 	};
 }
+#endif
 
-RasterTarget* RasterTargetCreate(uint32_t width, uint32_t height) {
+RasterTarget* RasterTargetCreateHeadless(uint32_t width, uint32_t height) {
 	RasterTarget* screen = NULL;
 	if (!Malloc(screen, sizeof(RasterTarget))) return NULL;
+	*screen = (RasterTarget){0};
 
 	if (!Malloc(screen->pixels, width * height * sizeof(Color))) FreeAndReturn(screen, NULL);
 	screen->width = width;
 	screen->height = height;
+	screen->maxWidth = width;
+	screen->maxHeight = height;
+	screen->viewProjection = RasterDefaultViewProjection(width, height, DEFAULT_SCREEN_HEIGHT_IN_WORLD);
+	screen->lightDirection = Vector3Normalize(DEFAULT_LIGHT_DIRECTION);
+	RasterStatsInit(&screen->stats);
+
+	// The pixels aren't initialized, so every tile counts as drawn until the first clear
+	screen->tilesX = TilesCount(width);
+	screen->tilesY = TilesCount(height);
+	if (!Malloc(screen->tileFlags, screen->tilesX * screen->tilesY)) {
+		Free(screen->pixels);
+		FreeAndReturn(screen, NULL);
+	}
+	memset(screen->tileFlags, RASTER_TILE_DRAWN, screen->tilesX * screen->tilesY);
+
+	return screen;
+}
+
+RasterTarget* RasterTargetCreate(uint32_t width, uint32_t height) {
+	RasterTarget* screen = RasterTargetCreateHeadless(width, height);
+	if (!screen) return NULL;
 
+#ifndef RASTER_HEADLESS
 	screen->tex = LoadTextureFromImage(RasterTargetToImage(screen));
 	if (!IsTextureValid(screen->tex)) {
+		Free(screen->tileFlags);
 		Free(screen->pixels);
 		FreeAndReturn(screen, NULL);
 	}
 
+	if (!Malloc(screen->texTileFlags, RasterTargetMaxTileCount(screen))) {
+		UnloadTexture(screen->tex);
+		Free(screen->tileFlags);
+		Free(screen->pixels);
+		FreeAndReturn(screen, NULL);
+	}
+#endif
+
 	return screen;
 }
 
 void RasterTargetFree(RasterTarget* screen) {
+	RasterTargetCloseVideoStream(screen);
+	RasterTargetSetSaveQueueDepth(screen, 0);
+	RasterTargetSetThreadCount(screen, 1);
+	RasterTargetSetDepthFormat(screen, RASTER_DEPTH_NONE);
+	RasterTargetSetSampleCount(screen, 1);
+	if (screen->screenVertices) Free(screen->screenVertices);
+	if (screen->screenOutcodes) Free(screen->screenOutcodes);
+	if (screen->texTileFlags) Free(screen->texTileFlags);
+	if (screen->uploadPixels) Free(screen->uploadPixels);
+	Free(screen->tileFlags);
 	Free(screen->pixels);
-	UnloadTexture(screen->tex);
+#ifndef RASTER_HEADLESS
+	if (RasterTargetHasTexture(screen)) UnloadTexture(screen->tex);
+#endif
 	Free(screen);
 }
 
-typedef enum WriteBMPErr {
-	WRITE_BMP_NO_ERR = 0,
-	WRITE_BMP_FILE_ERR,
-	WRITE_BMP_HEADER_ERR,
-	WRITE_BMP_PIXELS_ERR,
-	WRITE_BMP_PADDING_ERR,
-} WriteBMPErr;
-
-#define WriteBMPCloseAndExit(err) \
-	{                             \
-		CloseFile(outFile);       \
-		return err;               \
-	}
-
-static WriteBMPErr WriteBMP(const char* path, Color* pixels, uint32_t width, uint32_t height) {
-	const uint32_t fileHeaderSize = 14;
-	const uint32_t infoHeaderSize = 40;
-	const uint32_t totalHeaderSize = fileHeaderSize + infoHeaderSize;
-	const uint32_t pixelDataOffset = totalHeaderSize;
-	const uint32_t planes = 1;
-	const uint32_t bpp = 24;
-
-	const uint32_t rowPixelSize = width * 3;
-	const uint32_t rowPaddingSize = ((rowPixelSize + 3) & -4) - rowPixelSize;
-	const uint32_t totalRowSize = rowPixelSize + rowPaddingSize;
-	const uint32_t totalFileSize = totalHeaderSize + totalRowSize * height;
-
-	FILE* outFile = TryOpenFile(path, "wb+");
-	if (!outFile) return WRITE_BMP_FILE_ERR;
-
-	if (!LuFileWriteChar(outFile, 'B')) WriteBMPCloseAndExit(WRITE_BMP_HEADER_ERR);
-	if (!LuFileWriteChar(outFile, 'M')) WriteBMPCloseAndExit(WRITE_BMP_HEADER_ERR);
-	if (!LuFileWriteUInt32(outFile, totalFileSize)) WriteBMPCloseAndExit(WRITE_BMP_HEADER_ERR);
-	if (!LuFileWriteUInt32(outFile, 0)) WriteBMPCloseAndExit(WRITE_BMP_HEADER_ERR);
-	if (!LuFileWriteUInt32(outFile, pixelDataOffset)) WriteBMPCloseAndExit(WRITE_BMP_HEADER_ERR);
-
-	if (!LuFileWriteUInt32(outFile, infoHeaderSize)) WriteBMPCloseAndExit(WRITE_BMP_HEADER_ERR);
-	if (!LuFileWriteUInt32(outFile, width)) WriteBMPCloseAndExit(WRITE_BMP_HEADER_ERR);
-	if (!LuFileWriteUInt32(outFile, height)) WriteBMPCloseAndExit(WRITE_BMP_HEADER_ERR);
-	if (!LuFileWriteUInt16(outFile, planes)) WriteBMPCloseAndExit(WRITE_BMP_HEADER_ERR);
-	if (!LuFileWriteUInt16(outFile, bpp)) WriteBMPCloseAndExit(WRITE_BMP_HEADER_ERR);
-	if (!LuFileWriteUInt32(outFile, 0)) WriteBMPCloseAndExit(WRITE_BMP_HEADER_ERR);
-	if (!LuFileWriteUInt32(outFile, 0)) WriteBMPCloseAndExit(WRITE_BMP_HEADER_ERR);
-	if (!LuFileWriteUInt32(outFile, 0)) WriteBMPCloseAndExit(WRITE_BMP_HEADER_ERR);
-	if (!LuFileWriteUInt32(outFile, 0)) WriteBMPCloseAndExit(WRITE_BMP_HEADER_ERR);
-	if (!LuFileWriteUInt32(outFile, 0)) WriteBMPCloseAndExit(WRITE_BMP_HEADER_ERR);
-	if (!LuFileWriteUInt32(outFile, 0)) WriteBMPCloseAndExit(WRITE_BMP_HEADER_ERR);
-
-	for (int32_t y = height - 1; y >= 0; y--) {
-		const Color* rowStart = pixels + (y * width);
-		for (uint32_t x = 0; x < width; x++) {
-			if (!LuFileWriteByte(outFile, rowStart[x].b)) WriteBMPCloseAndExit(WRITE_BMP_PIXELS_ERR);
-			if (!LuFileWriteByte(outFile, rowStart[x].g)) WriteBMPCloseAndExit(WRITE_BMP_PIXELS_ERR);
-			if (!LuFileWriteByte(outFile, rowStart[x].r)) WriteBMPCloseAndExit(WRITE_BMP_PIXELS_ERR);
+RasterTargetBuffer* RasterTargetBufferCreate(const RasterTarget* screen) {
+	RasterTargetBuffer* buffer = NULL;
+	if (!Malloc(buffer, sizeof(RasterTargetBuffer))) return NULL;
+	*buffer = (RasterTargetBuffer){0};
+
+	const uint32_t tilesCount = RasterTargetMaxTileCount(screen);
+	if (!Malloc(buffer->pixels, (size_t)screen->maxWidth * screen->maxHeight * sizeof(Color))) FreeAndReturn(buffer, NULL);
+	if (!Malloc(buffer->tileFlags, tilesCount)) {
+		Free(buffer->pixels);
+		FreeAndReturn(buffer, NULL);
+	}
+	memset(buffer->tileFlags, RASTER_TILE_DRAWN, tilesCount);
+	buffer->width = screen->width;
+	buffer->height = screen->height;
+
+	return buffer;
+}
+
+void RasterTargetBufferFree(RasterTargetBuffer* buffer) {
+	Free(buffer->tileFlags);
+	Free(buffer->pixels);
+	Free(buffer);
+}
+
+// The depth buffer stays with the target, so the tiles drawn in the outgoing frame are marked drawn in the incoming
+// one too, for the next clear to reset their depth as well
+// An incoming frame of another viewport is laid out differently, so all of it is rewritten by the next clear
+void RasterTargetSwapBuffer(RasterTarget* screen, RasterTargetBuffer* buffer) {
+	RasterTargetResolve(screen);
+
+	const uint32_t tilesCount = RasterTargetGetTileCount(screen);
+	if (buffer->width != screen->width || buffer->height != screen->height) {
+		memset(buffer->tileFlags, RASTER_TILE_DRAWN, tilesCount);
+		buffer->backgroundValid = false;
+	} else if (screen->depth) {
+		for (uint32_t i = 0; i < tilesCount; i++) buffer->tileFlags[i] |= screen->tileFlags[i] & RASTER_TILE_DRAWN;
+	}
+
+	const RasterTargetBuffer incoming = *buffer;
+	*buffer = (RasterTargetBuffer){
+		.pixels = screen->pixels,
+		.tileFlags = screen->tileFlags,
+		.background = screen->background,
+		.backgroundValid = screen->backgroundValid,
+		.width = screen->width,
+		.height = screen->height,
+	};
+
+	screen->pixels = incoming.pixels;
+	screen->tileFlags = incoming.tileFlags;
+	screen->background = incoming.background;
+	screen->backgroundValid = incoming.backgroundValid;
+}
+
+bool RasterTargetHasTexture(const RasterTarget* screen) { return screen->tex.id != 0; }
+
+bool RasterTargetSetViewport(RasterTarget* screen, uint32_t width, uint32_t height) {
+	if (!width || !height || width > screen->maxWidth || height > screen->maxHeight) return false;
+	if (width == screen->width && height == screen->height) return true;
+
+	// Neither can fail, as they were allocated for the whole target too
+	if (screen->depth) RasterDepthBufferSetSize(screen->depth, width, height);
+	if (screen->binner) RasterBinnerSetSize(screen->binner, width, height);
+	if (screen->samples) RasterSampleBufferSetSize(screen->samples, width, height);
+
+	screen->width = width;
+	screen->height = height;
+	screen->tilesX = TilesCount(width);
+	screen->tilesY = TilesCount(height);
+
+	// The pixels are still laid out for the previous viewport
+	memset(screen->tileFlags, RASTER_TILE_DRAWN, RasterTargetGetTileCount(screen));
+	screen->backgroundValid = false;
+	return true;
+}
+
+bool RasterTargetSetThreadCount(RasterTarget* screen, uint32_t threadCount) {
+	if (!threadCount) threadCount = RasterThreadPoolDefaultThreadCount();
+	if (threadCount == RasterTargetGetThreadCount(screen)) return true;
+
+	if (screen->threadPool) {
+		RasterThreadPoolFree(screen->threadPool);
+		RasterBinnerFree(screen->binner);
+		screen->threadPool = NULL;
+		screen->binner = NULL;
+	}
+	if (threadCount == 1) return true;
+
+	screen->binner = RasterBinnerCreate(screen->maxWidth, screen->maxHeight);
+	if (!screen->binner) return false;
+	RasterBinnerSetSize(screen->binner, screen->width, screen->height);
+
+	screen->threadPool = RasterThreadPoolCreate(threadCount);
+	if (!screen->threadPool) {
+		RasterBinnerFree(screen->binner);
+		screen->binner = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+uint32_t RasterTargetGetThreadCount(const RasterTarget* screen) {
+	return screen->threadPool ? RasterThreadPoolThreadCount(screen->threadPool) : 1;
+}
+
+bool RasterTargetSetDepthFormat(RasterTarget* screen, RasterDepthFormat format) {
+	if (format == RasterTargetGetDepthFormat(screen)) return true;
+
+	if (screen->depth) {
+		RasterDepthBufferFree(screen->depth);
+		screen->depth = NULL;
+	}
+	if (format == RASTER_DEPTH_NONE) return true;
+
+	screen->depth = RasterDepthBufferCreate(screen->maxWidth, screen->maxHeight, format);
+	if (!screen->depth) return false;
+
+	RasterDepthBufferSetSize(screen->depth, screen->width, screen->height);
+	return true;
+}
+
+RasterDepthFormat RasterTargetGetDepthFormat(const RasterTarget* screen) {
+	return screen->depth ? screen->depth->format : RASTER_DEPTH_NONE;
+}
+
+// The edges drawn so far are resolved first, so switching keeps them anti-aliased
+bool RasterTargetSetSampleCount(RasterTarget* screen, uint32_t samplesCount) {
+	if (samplesCount == RasterTargetGetSampleCount(screen)) return true;
+	if (samplesCount != 1 && samplesCount != 4 && samplesCount != 8) return false;
+
+	if (screen->samples) {
+		RasterTargetResolve(screen);
+		RasterSampleBufferFree(screen->samples);
+		screen->samples = NULL;
+	}
+	if (samplesCount == 1) return true;
+
+	screen->samples = RasterSampleBufferCreate(screen->maxWidth, screen->maxHeight, samplesCount);
+	if (!screen->samples) return false;
+
+	RasterSampleBufferSetSize(screen->samples, screen->width, screen->height);
+	return true;
+}
+
+uint32_t RasterTargetGetSampleCount(const RasterTarget* screen) { return screen->samples ? screen->samples->samplesCount : 1; }
+
+// Only the drawn tiles can have pixels with more than one color
+void RasterTargetResolve(RasterTarget* screen) {
+	if (!screen->samples || !screen->samples->unresolved) return;
+	RasterStatsEnter(&screen->stats, RASTER_STAGE_RASTER);
+
+	for (uint32_t i = 0; i < RasterTargetGetTileCount(screen); i++) {
+		if (!(screen->tileFlags[i] & RASTER_TILE_DRAWN)) continue;
+		RasterSampleBufferResolve(screen->samples, screen->pixels, RasterTargetTileRect(screen, i));
+	}
+	screen->samples->unresolved = false;
+
+	RasterStatsLeave(&screen->stats);
+}
+
+void RasterTargetSetViewProjection(RasterTarget* screen, Matrix viewProjection) { screen->viewProjection = viewProjection; }
+
+void RasterTargetSetCamera(RasterTarget* screen, Camera3D camera) {
+	screen->viewProjection = RasterCameraViewProjection(camera, (float)screen->maxWidth / screen->maxHeight);
+}
+
+void RasterTargetSetTexture(RasterTarget* screen, const RasterTexture* texture, RasterTextureFilter filter) {
+	screen->texture = texture;
+	screen->textureFilter = filter;
+}
+
+const RasterTexture* RasterTargetGetTexture(const RasterTarget* screen) { return screen->texture; }
+
+void RasterTargetSetShading(RasterTarget* screen, RasterShading shading) { screen->shading = shading; }
+
+RasterShading RasterTargetGetShading(const RasterTarget* screen) { return screen->shading; }
+
+void RasterTargetSetLightDirection(RasterTarget* screen, Vector3 direction) { screen->lightDirection = Vector3Normalize(direction); }
+
+void RasterTargetSetCullMode(RasterTarget* screen, RasterCullMode mode) { screen->cullMode = mode; }
+
+RasterCullStats RasterTargetGetCullStats(const RasterTarget* screen) { return screen->cullStats; }
+
+void RasterTargetResetCullStats(RasterTarget* screen) { screen->cullStats = (RasterCullStats){0}; }
+
+bool RasterTargetSetSaveQueueDepth(RasterTarget* screen, uint32_t queueDepth) {
+	if (queueDepth == RasterTargetGetSaveQueueDepth(screen)) return true;
+
+	bool success = true;
+	if (screen->frameWriter) {
+		success = RasterFrameWriterFlush(screen->frameWriter);
+		RasterFrameWriterFree(screen->frameWriter);
+		screen->frameWriter = NULL;
+	}
+	if (!queueDepth) return success;
+
+	screen->frameWriter = RasterFrameWriterCreate(queueDepth);
+	return success && screen->frameWriter;
+}
+
+uint32_t RasterTargetGetSaveQueueDepth(const RasterTarget* screen) {
+	return screen->frameWriter ? RasterFrameWriterQueueDepth(screen->frameWriter) : 0;
+}
+
+bool RasterTargetSaveToFile(RasterTarget* screen, const char* path) {
+	RasterTargetResolve(screen);
+	if (screen->frameWriter) return RasterFrameWriterQueue(screen->frameWriter, path, screen->pixels, screen->width, screen->height);
+	return RasterWriteBMP(path, screen->pixels, screen->width, screen->height);
+}
+
+bool RasterTargetSaveBufferToFile(const RasterTarget* screen, const RasterTargetBuffer* buffer, const char* path) {
+	if (screen->frameWriter) return RasterFrameWriterQueue(screen->frameWriter, path, buffer->pixels, buffer->width, buffer->height);
+	return RasterWriteBMP(path, buffer->pixels, buffer->width, buffer->height);
+}
+
+bool RasterTargetFlushSaves(RasterTarget* screen) { return !screen->frameWriter || RasterFrameWriterFlush(screen->frameWriter); }
+
+bool RasterTargetOpenVideoStream(RasterTarget* screen, const char* path, RasterVideoFormat format, uint32_t framesPerSecond,
+								 uint32_t queueDepth) {
+	if (screen->videoSink) RasterTargetCloseVideoStream(screen);
+
+	screen->videoSink = RasterVideoSinkOpen(path, format, screen->width, screen->height, framesPerSecond, queueDepth);
+	return screen->videoSink != NULL;
+}
+
+// Every frame of a stream has the same size
+static bool RasterTargetStreamPixels(RasterTarget* screen, const Color* pixels, uint32_t width, uint32_t height) {
+	const RasterVideoSink* sink = screen->videoSink;
+	if (!sink || width != sink->width || height != sink->height) return false;
+	return RasterVideoSinkPush(screen->videoSink, pixels);
+}
+
+bool RasterTargetStreamFrame(RasterTarget* screen) {
+	RasterTargetResolve(screen);
+	return RasterTargetStreamPixels(screen, screen->pixels, screen->width, screen->height);
+}
+
+bool RasterTargetStreamBuffer(RasterTarget* screen, const RasterTargetBuffer* buffer) {
+	return RasterTargetStreamPixels(screen, buffer->pixels, buffer->width, buffer->height);
+}
+
+bool RasterTargetCloseVideoStream(RasterTarget* screen) {
+	if (!screen->videoSink) return true;
+
+	const bool success = RasterVideoSinkClose(screen->videoSink);
+	screen->videoSink = NULL;
+	return success;
+}
+
+void RasterTargetBeginFrameStats(RasterTarget* screen) {
+	RasterStatsBeginFrame(&screen->stats);
+	screen->frameStartCullStats = screen->cullStats;
+}
+
+// Zero if the cull stats were reset during the frame
+static uint64_t CountSince(uint64_t count, uint64_t start) { return (count >= start) ? count - start : 0; }
+
+const RasterFrameStats* RasterTargetEndFrameStats(RasterTarget* screen) {
+	const RasterCullStats* end = &screen->cullStats;
+	const RasterCullStats* start = &screen->frameStartCullStats;
+
+	RasterFrameStats* frame = &screen->stats.frame;
+	frame->trianglesSubmitted = CountSince(end->submitted, start->submitted);
+	frame->trianglesCulled = CountSince(end->frustumCulled, start->frustumCulled) + CountSince(end->backFaceCulled, start->backFaceCulled) +
+							 CountSince(end->degenerate, start->degenerate);
+	frame->trianglesDrawn = CountSince(end->rasterized, start->rasterized);
+	frame->width = screen->width;
+	frame->height = screen->height;
+
+	return RasterStatsEndFrame(&screen->stats, (uint64_t)screen->width * screen->height);
+}
+
+static uint32_t ColorBits(Color col) {
+	uint32_t bits;
+	memcpy(&bits, &col, sizeof(bits));
+	return bits;
+}
+
+#ifndef RASTER_HEADLESS
+static bool RasterTargetReserveUploadPixels(RasterTarget* screen, size_t count) {
+	if (count <= screen->uploadPixelsCapacity) return true;
+
+	if (screen->uploadPixels) Free(screen->uploadPixels);
+	screen->uploadPixels = NULL;
+	screen->uploadPixelsCapacity = 0;
+
+	if (!Malloc(screen->uploadPixels, count * sizeof(Color))) return false;
+	screen->uploadPixelsCapacity = count;
+	return true;
+}
+
+// Rects as wide as the frame are uploaded straight from its pixels, their rows being contiguous
+static bool RasterTargetUploadRect(RasterTarget* screen, const RasterTargetBuffer* frame, RasterRect rect) {
+	const uint32_t rectWidth = rect.maxX - rect.minX;
+	const uint32_t rectHeight = rect.maxY - rect.minY;
+
+	const Color* data = frame->pixels + Index1D(rect.minX, rect.minY, frame->width);
+	if (rectWidth != frame->width) {
+		if (!RasterTargetReserveUploadPixels(screen, (size_t)rectWidth * rectHeight)) return false;
+
+		for (uint32_t y = 0; y < rectHeight; y++) {
+			memcpy(screen->uploadPixels + (size_t)y * rectWidth, data + (size_t)y * frame->width, rectWidth * sizeof(Color));
+		}
+		data = screen->uploadPixels;
+	}
+
+	UpdateTextureRec(screen->tex, (Rectangle){rect.minX, rect.minY, rectWidth, rectHeight}, data);
+	return true;
+}
+
+static bool IsTileUploaded(const RasterTarget* screen, const RasterTargetBuffer* frame, uint32_t tileIndex) {
+	return (frame->tileFlags[tileIndex] | screen->texTileFlags[tileIndex]) & RASTER_TILE_DRAWN;
+}
+
+// One rect per row of tiles, from its first tile to upload to its last, merged with the rows below spanning the same
+// tiles, false if some couldn't be packed
+static bool RasterTargetUploadDirtyRects(RasterTarget* screen, const RasterTargetBuffer* frame) {
+	const uint32_t tilesX = TilesCount(frame->width);
+	const uint32_t tilesY = TilesCount(frame->height);
+	RasterRect pending = (RasterRect){0};
+	bool hasPending = false;
+
+	for (uint32_t tileY = 0; tileY < tilesY; tileY++) {
+		uint32_t first = 0;
+		while (first < tilesX && !IsTileUploaded(screen, frame, Index1D(first, tileY, tilesX))) first++;
+
+		if (first == tilesX) continue;
+
+		uint32_t last = tilesX - 1;
+		while (!IsTileUploaded(screen, frame, Index1D(last, tileY, tilesX))) last--;
+
+		RasterRect row = TileRect(frame->width, frame->height, Index1D(first, tileY, tilesX));
+		row.maxX = TileRect(frame->width, frame->height, Index1D(last, tileY, tilesX)).maxX;
+
+		if (hasPending && pending.minX == row.minX && pending.maxX == row.maxX && pending.maxY == row.minY) {
+			pending.maxY = row.maxY;
+			continue;
 		}
 
-		for (uint32_t i = 0; i < rowPaddingSize; i++) {
-			if (!LuFileWriteByte(outFile, 0)) WriteBMPCloseAndExit(WRITE_BMP_PADDING_ERR);
+		if (hasPending && !RasterTargetUploadRect(screen, frame, pending)) return false;
+		pending = row;
+		hasPending = true;
+	}
+
+	return !hasPending || RasterTargetUploadRect(screen, frame, pending);
+}
+
+// A tile only holding the same background in the texture and in the frame is already up to date, as long as the
+// texture holds a frame of the same viewport
+static void RasterTargetUpload(RasterTarget* screen, const RasterTargetBuffer* frame) {
+	const uint32_t tilesCount = TilesCount(frame->width) * TilesCount(frame->height);
+
+	bool partial = frame->width == screen->texWidth && frame->height == screen->texHeight && frame->backgroundValid &&
+				   screen->texBackgroundValid && ColorBits(frame->background) == ColorBits(screen->texBackground);
+	if (partial) {
+		uint64_t uploadedPixels = 0;
+		for (uint32_t i = 0; i < tilesCount; i++) {
+			if (!IsTileUploaded(screen, frame, i)) continue;
+
+			const RasterRect tileRect = TileRect(frame->width, frame->height, i);
+			uploadedPixels += (uint64_t)(tileRect.maxX - tileRect.minX) * (tileRect.maxY - tileRect.minY);
 		}
+		partial = uploadedPixels * 100 <= (uint64_t)frame->width * frame->height * PARTIAL_UPLOAD_MAX_PERCENT;
 	}
 
-	WriteBMPCloseAndExit(WRITE_BMP_NO_ERR);
+	if (!partial || !RasterTargetUploadDirtyRects(screen, frame)) {
+		UpdateTextureRec(screen->tex, (Rectangle){0, 0, frame->width, frame->height}, frame->pixels);
+	}
+
+	for (uint32_t i = 0; i < tilesCount; i++) screen->texTileFlags[i] = frame->tileFlags[i] & RASTER_TILE_DRAWN;
+	screen->texBackground = frame->background;
+	screen->texBackgroundValid = frame->backgroundValid;
+	screen->texWidth = frame->width;
+	screen->texHeight = frame->height;
 }
 
-bool RasterTargetSaveToFile(const RasterTarget* screen, const char* path) {
-	WriteBMPErr err = WriteBMP(path, screen->pixels, screen->width, screen->height);
-	return (err == WRITE_BMP_NO_ERR);
+void RasterTargetUpdateTexture(RasterTarget* screen) {
+	if (!RasterTargetHasTexture(screen)) return;
+	RasterTargetResolve(screen);
+
+	const RasterTargetBuffer frame = (RasterTargetBuffer){
+		.pixels = screen->pixels,
+		.tileFlags = screen->tileFlags,
+		.background = screen->background,
+		.backgroundValid = screen->backgroundValid,
+		.width = screen->width,
+		.height = screen->height,
+	};
+	RasterStatsEnter(&screen->stats, RASTER_STAGE_UPLOAD);
+	RasterTargetUpload(screen, &frame);
+	RasterStatsLeave(&screen->stats);
 }
 
-void RasterTargetUpdateTexture(RasterTarget* screen) { UpdateTexture(screen->tex, screen->pixels); }
+void RasterTargetUpdateTextureFromBuffer(RasterTarget* screen, const RasterTargetBuffer* buffer) {
+	if (!RasterTargetHasTexture(screen)) return;
+	RasterTargetUpload(screen, buffer);
+}
 
 void RasterTargetRenderTexture(const RasterTarget* screen) { RasterTargetRenderTextureEx(screen, 1); }
 
-void RasterTargetRenderTextureEx(const RasterTarget* screen, uint32_t scale) { DrawTextureEx(screen->tex, (Vector2){0}, 0.0f, scale, WHITE); }
+// The texture keeps raylib's point filtering, so a smaller viewport shows larger pixels rather than blurring
+void RasterTargetRenderTextureEx(const RasterTarget* screen, uint32_t scale) {
+	if (!RasterTargetHasTexture(screen)) return;
+
+	const Rectangle source = (Rectangle){0, 0, screen->texWidth, screen->texHeight};
+	const Rectangle dest = (Rectangle){0, 0, (float)screen->maxWidth * scale, (float)screen->maxHeight * scale};
+	DrawTexturePro(screen->tex, source, dest, (Vector2){0}, 0.0f, WHITE);
+}
+#endif
+
+uint32_t RasterTargetGetTileCount(const RasterTarget* screen) { return screen->tilesX * screen->tilesY; }
+
+RasterRect RasterTargetTileRect(const RasterTarget* screen, uint32_t tileIndex) {
+	return TileRect(screen->width, screen->height, tileIndex);
+}
+
+bool RasterTargetIsTileDirty(const RasterTarget* screen, uint32_t tileIndex) { return screen->tileFlags[tileIndex] != 0; }
+
+bool RasterTargetGetDirtyRect(const RasterTarget* screen, RasterRect* rect) {
+	RasterRect dirty = (RasterRect){.minX = INT32_MAX, .minY = INT32_MAX, .maxX = INT32_MIN, .maxY = INT32_MIN};
+	for (uint32_t i = 0; i < RasterTargetGetTileCount(screen); i++) {
+		if (!RasterTargetIsTileDirty(screen, i)) continue;
+
+		const RasterRect tileRect = RasterTargetTileRect(screen, i);
+		dirty.minX = Min(dirty.minX, tileRect.minX);
+		dirty.minY = Min(dirty.minY, tileRect.minY);
+		dirty.maxX = Max(dirty.maxX, tileRect.maxX);
+		dirty.maxY = Max(dirty.maxY, tileRect.maxY);
+	}
+
+	if (dirty.minX >= dirty.maxX) return false;
+	*rect = dirty;
+	return true;
+}
+
+void RasterTargetMarkDirty(RasterTarget* screen, RasterRect rect) {
+	rect.minX = Max(rect.minX, 0);
+	rect.minY = Max(rect.minY, 0);
+	rect.maxX = Min(rect.maxX, (int32_t)screen->width);
+	rect.maxY = Min(rect.maxY, (int32_t)screen->height);
+	if (rect.minX >= rect.maxX || rect.minY >= rect.maxY) return;
+
+	if (screen->samples) screen->samples->unresolved = true;
+	for (int32_t tileY = rect.minY / RASTER_TILE_SIZE; tileY <= (rect.maxY - 1) / RASTER_TILE_SIZE; tileY++) {
+		for (int32_t tileX = rect.minX / RASTER_TILE_SIZE; tileX <= (rect.maxX - 1) / RASTER_TILE_SIZE; tileX++) {
+			screen->tileFlags[Index1D(tileX, tileY, screen->tilesX)] |= RASTER_TILE_DRAWN;
+		}
+	}
+}
+
+// Rewrites the drawn tiles only, one fill per horizontal run of them
+static void RasterTargetClearDrawnTiles(RasterTarget* screen, uint32_t background) {
+	for (uint32_t tileY = 0; tileY < screen->tilesY; tileY++) {
+		const uint8_t* flags = screen->tileFlags + tileY * screen->tilesX;
+
+		uint32_t tileX = 0;
+		while (tileX < screen->tilesX) {
+			if (!(flags[tileX] & RASTER_TILE_DRAWN)) {
+				tileX++;
+				continue;
+			}
+
+			const uint32_t runStart = tileX;
+			while (tileX < screen->tilesX && (flags[tileX] & RASTER_TILE_DRAWN)) tileX++;
+
+			RasterRect run = RasterTargetTileRect(screen, Index1D(runStart, tileY, screen->tilesX));
+			run.maxX = RasterTargetTileRect(screen, Index1D(tileX - 1, tileY, screen->tilesX)).maxX;
+
+			RasterFillRect32((uint32_t*)screen->pixels, screen->width, run, background);
+			if (screen->depth) RasterDepthBufferClearRect(screen->depth, run);
+			if (screen->samples) RasterSampleBufferClearRect(screen->samples, run);
+		}
+	}
+}
 
 void RasterTargetClearBackground(RasterTarget* screen, Color col) {
-	const uint32_t pixelsCount = screen->width * screen->height;
-	for (uint32_t i = 0; i < pixelsCount; i++) {
-		screen->pixels[i] = col;
+	const uint32_t tilesCount = RasterTargetGetTileCount(screen);
+	RasterStatsEnter(&screen->stats, RASTER_STAGE_CLEAR);
+
+	if (screen->backgroundValid && ColorBits(col) == ColorBits(screen->background)) {
+		RasterTargetClearDrawnTiles(screen, ColorBits(col));
+		for (uint32_t i = 0; i < tilesCount; i++) {
+			screen->tileFlags[i] = (screen->tileFlags[i] & RASTER_TILE_DRAWN) ? RASTER_TILE_CLEARED : 0;
+		}
+	} else {
+		RasterFill32((uint32_t*)screen->pixels, (size_t)screen->width * screen->height, ColorBits(col));
+		if (screen->depth) RasterDepthBufferClear(screen->depth);
+		if (screen->samples) RasterSampleBufferClear(screen->samples);
+
+		memset(screen->tileFlags, RASTER_TILE_CLEARED, tilesCount);
+		screen->background = col;
+		screen->backgroundValid = true;
 	}
+
+	RasterStatsLeave(&screen->stats);
 }
 
 static void RasterTargetDrawPixelFast(RasterTarget* screen, uint32_t x, uint32_t y, Color col) {
 	screen->pixels[Index1D(x, y, screen->width)] = col;
+	if (screen->samples) screen->samples->masks[Index1D(x, y, screen->width)] = screen->samples->fullMask;
+	screen->tileFlags[Index1D(x / RASTER_TILE_SIZE, y / RASTER_TILE_SIZE, screen->tilesX)] |= RASTER_TILE_DRAWN;
 }
 
 void RasterTargetDrawPixel(RasterTarget* screen, uint32_t x, uint32_t y, Color col) {
@@ -124,90 +627,524 @@ void RasterTargetDrawPixel(RasterTarget* screen, uint32_t x, uint32_t y, Color c
 	RasterTargetDrawPixelFast(screen, x, y, col);
 }
 
-static Vector2 Vector2Round(Vector2 v) {
-	return (Vector2){
-		.x = roundf(v.x),
-		.y = roundf(v.y),
+static RasterRect RasterTargetBounds(const RasterTarget* screen) {
+	return (RasterRect){
+		.minX = 0,
+		.minY = 0,
+		.maxX = screen->width,
+		.maxY = screen->height,
 	};
 }
 
-static float SignedTriangleArea2(Vector2 a, Vector2 b, Vector2 c) { return (c.x - a.x) * (b.y - a.y) + (c.y - a.y) * (a.x - b.x); }
+// Multisampled targets also need the pixels whose center is outside of the triangle but some of their samples inside
+static bool RasterTargetSetupTriangle(const RasterTarget* screen, RasterTriangle* tri, Vector2 a, Vector2 b, Vector2 c) {
+	if (screen->samples) return RasterTriangleSetupSampled(tri, a, b, c, RasterTargetBounds(screen));
+	return RasterTriangleSetup(tri, a, b, c, RasterTargetBounds(screen));
+}
 
-static bool PointInClockwiseTriangle(Vector2 p, Vector2 a, Vector2 b, Vector2 c) {
-	const float areaABP = SignedTriangleArea2(a, b, p);
-	const float areaBCP = SignedTriangleArea2(b, c, p);
-	const float areaCAP = SignedTriangleArea2(c, a, p);
-	return ((areaABP >= 0) && (areaBCP >= 0) && (areaCAP >= 0));
+static bool RasterTargetSetupDepthTriangle(const RasterTarget* screen, RasterTriangle* tri, Vector3 a, Vector3 b, Vector3 c) {
+	if (screen->samples) return RasterTriangleSetupDepthSampled(tri, a, b, c, RasterTargetBounds(screen));
+	return RasterTriangleSetupDepth(tri, a, b, c, RasterTargetBounds(screen));
+}
+
+static RasterFillTarget RasterTargetFillTarget(RasterTarget* screen) {
+	return (RasterFillTarget){
+		.pixels = screen->pixels,
+		.stride = screen->width,
+		.depth = screen->depth,
+		.samples = screen->samples,
+	};
 }
 
 void RasterTargetDrawTriangle(RasterTarget* screen, Vector2 a, Vector2 b, Vector2 c, Color col) {
-	const Vector2 roundedA = Vector2Round(a);
-	const Vector2 roundedB = Vector2Round(b);
-	const Vector2 roundedC = Vector2Round(c);
-
-	int32_t minX = screen->width;
-	minX = Min(minX, roundedA.x);
-	minX = Min(minX, roundedB.x);
-	minX = Min(minX, roundedC.x);
-	minX = Max(minX, 0);
-
-	int32_t minY = screen->height;
-	minY = Min(minY, roundedA.y);
-	minY = Min(minY, roundedB.y);
-	minY = Min(minY, roundedC.y);
-	minY = Max(minY, 0);
-
-	int32_t maxX = 0;
-	maxX = Max(maxX, roundedA.x);
-	maxX = Max(maxX, roundedB.x);
-	maxX = Max(maxX, roundedC.x);
-	maxX = Min(maxX, screen->width);
-
-	int32_t maxY = 0;
-	maxY = Max(maxY, roundedA.y);
-	maxY = Max(maxY, roundedB.y);
-	maxY = Max(maxY, roundedC.y);
-	maxY = Min(maxY, screen->height);
-
-	for (int32_t y = minY; y < maxY; y++) {
-		for (int32_t x = minX; x < maxX; x++) {
-			Vector2 pos = (Vector2){.x = x, .y = y};
-			if (!PointInClockwiseTriangle(pos, a, b, c)) continue;
-
-			RasterTargetDrawPixelFast(screen, x, y, col);
-		}
+	RasterTriangle tri;
+	if (!RasterTargetSetupTriangle(screen, &tri, a, b, c)) return;
+
+	RasterTargetMarkDirty(screen, tri.bounds);
+
+	RasterStatsEnter(&screen->stats, RASTER_STAGE_RASTER);
+	RasterFillCounts counts;
+	if (screen->samples) {
+		const RasterFillTarget target = RasterTargetFillTarget(screen);
+		const RasterShader shader = (RasterShader){.col = col};
+		counts = RasterSampleBufferSelectFill(RASTER_DEPTH_NONE, RASTER_KERNEL_FLAT)(&target, &tri, &shader);
+	} else {
+		const uint32_t written = RasterTriangleFill(&tri, screen->pixels, screen->width, col);
+		counts = (RasterFillCounts){.tested = written, .written = written};
 	}
+	RasterStatsAdd(&screen->stats, pixelsTested, counts.tested);
+	RasterStatsAdd(&screen->stats, pixelsWritten, counts.written);
+	RasterStatsLeave(&screen->stats);
 }
 
-static Vector2 RasterWorldToScreen(RasterTarget* screen, Vector3 worldPos) {
-	const Vector2 halfScreenSizes = (Vector2){
-		.x = screen->width / 2.0f,
-		.y = screen->height / 2.0f,
+static void DrawBinnedTileJob(void* userData, uint32_t tileIndex) {
+	RasterTarget* screen = userData;
+	const RasterFillTarget target = RasterTargetFillTarget(screen);
+	const RasterFillCounts counts = RasterBinnerDrawTile(screen->binner, tileIndex, &target);
+
+	RasterStatsAddAtomic(&screen->stats, workerPixelsTested, counts.tested);
+	RasterStatsAddAtomic(&screen->stats, workerPixelsWritten, counts.written);
+}
+
+static void RasterTargetFlushBins(RasterTarget* screen) {
+	RasterStatsEnter(&screen->stats, RASTER_STAGE_RASTER);
+	RasterThreadPoolRun(screen->threadPool, DrawBinnedTileJob, screen, screen->binner->tilesX * screen->binner->tilesY);
+	RasterBinnerReset(screen->binner);
+	RasterStatsLeave(&screen->stats);
+}
+
+// uv and colorPlanes are only read by the kernels they are set up for
+static void RasterTargetFillTriangle(RasterTarget* screen, const RasterTriangle* tri, Color col, const RasterUVPlanes* uv,
+									 const RasterColorPlanes* colorPlanes) {
+	RasterStatsEnter(&screen->stats, RASTER_STAGE_RASTER);
+
+	RasterFillCounts counts = (RasterFillCounts){0};
+	if (!screen->depth || !RasterDepthBufferIsOccluded(screen->depth, tri)) {
+		RasterShader shader = (RasterShader){.col = col, .colors = colorPlanes, .uv = uv};
+		if (RasterShadeKernelIsTextured(screen->kernel)) shader.level = screen->texture->levels + uv->level;
+		const RasterFillTarget target = RasterTargetFillTarget(screen);
+		counts = screen->fill(&target, tri, &shader);
+	}
+
+	RasterStatsAdd(&screen->stats, pixelsTested, counts.tested);
+	RasterStatsAdd(&screen->stats, pixelsWritten, counts.written);
+	RasterStatsLeave(&screen->stats);
+}
+
+// Every triangle is binned before any is drawn, so each tile is rasterized by a single thread in submission order
+static void RasterTargetBinTriangle(RasterTarget* screen, const RasterTriangle* tri, Color col, const RasterUVPlanes* uv,
+									const RasterColorPlanes* colorPlanes) {
+	if (RasterBinnerPush(screen->binner, tri, col, uv, colorPlanes)) return;
+
+	// Out of memory for the bins, drawing what was already binned first keeps the submission order
+	RasterTargetFlushBins(screen);
+	RasterTargetFillTriangle(screen, tri, col, uv, colorPlanes);
+}
+
+static Vector3 ScreenPosition(const RasterScreenVertex* v) { return (Vector3){v->x, v->y, v->z}; }
+
+// What the draw's kernel interpolates across a triangle besides depth, the other members are left unset
+typedef struct VertexAttributes {
+	Vector2 texCoords;
+	Vector3 color;	// Channels in [0, 255]
+} VertexAttributes;
+
+static bool RasterTargetInterpolatesAttributes(const RasterTarget* screen) {
+	return screen->kernel == RASTER_KERNEL_GOURAUD || RasterShadeKernelIsTextured(screen->kernel);
+}
+
+static void RasterTargetDrawModelTriangle(RasterTarget* screen, const RasterScreenVertex* vertices[3],
+										  const VertexAttributes* attributes[3], Color col) {
+	const Vector3 positions[3] = {ScreenPosition(vertices[0]), ScreenPosition(vertices[1]), ScreenPosition(vertices[2])};
+
+	RasterTriangle tri;
+	if (screen->depth) {
+		if (!RasterTargetSetupDepthTriangle(screen, &tri, positions[0], positions[1], positions[2])) return;
+	} else {
+		const Vector2 a = (Vector2){positions[0].x, positions[0].y};
+		const Vector2 b = (Vector2){positions[1].x, positions[1].y};
+		const Vector2 c = (Vector2){positions[2].x, positions[2].y};
+		if (!RasterTargetSetupTriangle(screen, &tri, a, b, c)) return;
+	}
+
+	RasterUVPlanes uv;
+	RasterColorPlanes colorPlanes;
+	if (RasterShadeKernelIsTextured(screen->kernel)) {
+		const float w[3] = {vertices[0]->w, vertices[1]->w, vertices[2]->w};
+		const Vector2 texCoords[3] = {attributes[0]->texCoords, attributes[1]->texCoords, attributes[2]->texCoords};
+		RasterUVPlanesSetup(&uv, &tri, screen->texture, positions, w, texCoords);
+	} else if (screen->kernel == RASTER_KERNEL_GOURAUD) {
+		const Vector3 colors[3] = {attributes[0]->color, attributes[1]->color, attributes[2]->color};
+		RasterColorPlanesSetup(&colorPlanes, &tri, positions, colors);
+	}
+
+	// Marked on the submitting thread, even if the depth test ends up rejecting the triangle
+	RasterTargetMarkDirty(screen, tri.bounds);
+	if (screen->threadPool) RasterTargetBinTriangle(screen, &tri, col, &uv, &colorPlanes);
+	else RasterTargetFillTriangle(screen, &tri, col, &uv, &colorPlanes);
+}
+
+// Transforms count vertices of consecutive instances, instance i being transformed by mvps[i]
+typedef struct TransformJob {
+	const Vector3* positions;
+	size_t verticesSize;  // Per instance
+	const Matrix* mvps;
+	size_t count;
+	uint32_t width;
+	uint32_t height;
+	RasterScreenVertex* screenVertices;
+	uint16_t* outcodes;
+} TransformJob;
+
+// Jobs may span several instances, each of them is transformed separately
+static void TransformVertexRange(const TransformJob* job, size_t first, size_t count) {
+	const size_t end = first + count;
+	while (first < end) {
+		const size_t instance = first / job->verticesSize;
+		const size_t vertex = first - instance * job->verticesSize;
+		const size_t size = Min(end - first, job->verticesSize - vertex);
+
+		RasterTransformVertices(job->positions + vertex, size, job->mvps[instance], job->width, job->height, job->screenVertices + first,
+								job->outcodes + first);
+		first += size;
+	}
+}
+
+static void TransformJobFunc(void* userData, uint32_t jobIndex) {
+	const TransformJob* job = userData;
+	const size_t first = (size_t)jobIndex * TRANSFORM_JOB_SIZE;
+	TransformVertexRange(job, first, Min(job->count - first, (size_t)TRANSFORM_JOB_SIZE));
+}
+
+static bool RasterTargetReserveScreenVertices(RasterTarget* screen, size_t count) {
+	if (count <= screen->screenVerticesCapacity) return true;
+
+	if (screen->screenVertices) Free(screen->screenVertices);
+	if (screen->screenOutcodes) Free(screen->screenOutcodes);
+	screen->screenVertices = NULL;
+	screen->screenOutcodes = NULL;
+	screen->screenVerticesCapacity = 0;
+
+	if (!Malloc(screen->screenVertices, count * sizeof(RasterScreenVertex))) return false;
+	if (!Malloc(screen->screenOutcodes, count * sizeof(uint16_t))) return false;
+	screen->screenVerticesCapacity = count;
+	return true;
+}
+
+// Transforms every vertex of each instance once, triangles then only fetch their corners from screen->screenVertices,
+// instance i's vertices starting at i * model->verticesSize
+// screen->screenVertices must have room for all of them
+static void RasterTargetTransformInstances(RasterTarget* screen, const RasterModel* model, const Matrix* mvps, size_t instancesCount) {
+	TransformJob job = (TransformJob){
+		.positions = model->positions,
+		.verticesSize = model->verticesSize,
+		.mvps = mvps,
+		.count = model->verticesSize * instancesCount,
+		.width = screen->width,
+		.height = screen->height,
+		.screenVertices = screen->screenVertices,
+		.outcodes = screen->screenOutcodes,
 	};
 
-	const float screenHeightInWorld = 5.0f;
-	const float pixelsPerWorldUnit = screen->height / screenHeightInWorld;
+	const uint32_t jobCount = (job.count + TRANSFORM_JOB_SIZE - 1) / TRANSFORM_JOB_SIZE;
+	if (screen->threadPool && jobCount > 1) {
+		RasterThreadPoolRun(screen->threadPool, TransformJobFunc, &job, jobCount);
+	} else if (job.count) {
+		TransformVertexRange(&job, 0, job.count);
+	}
+}
+
+// Back-faces are either culled or flipped to the winding setup draws, the polygon is then drawn as a fan
+// attributes has one entry per polygon vertex
+static void RasterTargetDrawPolygon(RasterTarget* screen, const RasterScreenVertex* polygon, const VertexAttributes* attributes,
+									uint32_t size, Color col) {
+	const double area = RasterPolygonArea(polygon, size);
+	if (area == 0) {
+		screen->cullStats.degenerate++;
+		return;
+	}
 
-	return (Vector2){
-		.x = halfScreenSizes.x + worldPos.x * pixelsPerWorldUnit,
-		.y = halfScreenSizes.y + worldPos.y * pixelsPerWorldUnit,
+	const bool front = area > 0;
+	if ((front && screen->cullMode == RASTER_CULL_FRONT) || (!front && screen->cullMode == RASTER_CULL_BACK)) {
+		screen->cullStats.backFaceCulled++;
+		return;
+	}
+
+	for (uint32_t i = 1; i + 1 < size; i++) {
+		const uint32_t ib = front ? i : i + 1;
+		const uint32_t ic = front ? i + 1 : i;
+		const RasterScreenVertex* vertices[3] = {polygon, polygon + ib, polygon + ic};
+		const VertexAttributes* triAttributes[3] = {attributes, attributes + ib, attributes + ic};
+
+		RasterTargetDrawModelTriangle(screen, vertices, triAttributes, col);
+		screen->cullStats.rasterized++;
+	}
+}
+
+// Channels in [0, 255], col being the triangle's face or instance color
+static Vector3 RasterTargetVertexColor(const RasterTarget* screen, size_t index, Color col) {
+	if (screen->shading == RASTER_SHADING_VERTEX) {
+		const Color vertexColor = screen->model->colors[index];
+		return (Vector3){vertexColor.r, vertexColor.g, vertexColor.b};
+	}
+
+	const float diffuse = fmaxf(Vector3DotProduct(screen->model->normals[index], screen->modelLight), 0.0f);
+	const float intensity = LAMBERT_AMBIENT + (1.0f - LAMBERT_AMBIENT) * diffuse;
+	return (Vector3){col.r * intensity, col.g * intensity, col.b * intensity};
+}
+
+static VertexAttributes RasterTargetVertexAttributes(const RasterTarget* screen, size_t index, Color col) {
+	VertexAttributes attributes = (VertexAttributes){0};
+	if (RasterShadeKernelIsTextured(screen->kernel)) attributes.texCoords = screen->model->texCoords[index];
+	else if (screen->kernel == RASTER_KERNEL_GOURAUD) attributes.color = RasterTargetVertexColor(screen, index, col);
+	return attributes;
+}
+
+static VertexAttributes InterpolateAttributes(const VertexAttributes attributes[3], Vector3 weights) {
+	return (VertexAttributes){
+		.texCoords = Vector2Add(Vector2Add(Vector2Scale(attributes[0].texCoords, weights.x), Vector2Scale(attributes[1].texCoords, weights.y)),
+								Vector2Scale(attributes[2].texCoords, weights.z)),
+		.color = Vector3Add(Vector3Add(Vector3Scale(attributes[0].color, weights.x), Vector3Scale(attributes[1].color, weights.y)),
+							Vector3Scale(attributes[2].color, weights.z)),
+	};
+}
+
+// Culling stage, triangles entirely outside of the view are rejected from their outcodes alone, and only the ones
+// crossing the near or far plane or the guard band are clipped, the rest is drawn as is
+// The indices are the model's, the instance's transformed vertices start at vertexOffset
+static void RasterTargetDrawScreenTriangle(RasterTarget* screen, size_t vertexOffset, size_t ia, size_t ib, size_t ic, Color col) {
+	screen->cullStats.submitted++;
+
+	const uint16_t* screenOutcodes = screen->screenOutcodes + vertexOffset;
+	const uint16_t outcodes[3] = {screenOutcodes[ia], screenOutcodes[ib], screenOutcodes[ic]};
+	if (outcodes[0] & outcodes[1] & outcodes[2] & RASTER_OUT_VIEW_MASK) {
+		screen->cullStats.frustumCulled++;
+		return;
+	}
+
+	const RasterScreenVertex* screenVertices = screen->screenVertices + vertexOffset;
+	const RasterScreenVertex* triangle[3] = {screenVertices + ia, screenVertices + ib, screenVertices + ic};
+	const VertexAttributes triAttributes[3] = {
+		RasterTargetVertexAttributes(screen, ia, col),
+		RasterTargetVertexAttributes(screen, ib, col),
+		RasterTargetVertexAttributes(screen, ic, col),
+	};
+
+	if (!((outcodes[0] | outcodes[1] | outcodes[2]) & RASTER_OUT_CLIP_MASK)) {
+		const RasterScreenVertex polygon[3] = {*triangle[0], *triangle[1], *triangle[2]};
+		RasterTargetDrawPolygon(screen, polygon, triAttributes, 3, col);
+		return;
+	}
+
+	RasterScreenVertex polygon[RASTER_CLIP_MAX_VERTICES];
+	Vector3 weights[RASTER_CLIP_MAX_VERTICES];
+	const bool interpolated = RasterTargetInterpolatesAttributes(screen);
+	const uint32_t size = RasterClipTriangle(triangle, outcodes, polygon, interpolated ? weights : NULL);
+	if (!size) {
+		screen->cullStats.frustumCulled++;
+		return;
+	}
+
+	screen->cullStats.clipped++;
+	VertexAttributes attributes[RASTER_CLIP_MAX_VERTICES] = {0};
+	if (interpolated) {
+		for (uint32_t i = 0; i < size; i++) attributes[i] = InterpolateAttributes(triAttributes, weights[i]);
+	}
+	RasterTargetDrawPolygon(screen, polygon, attributes, size, col);
+}
+
+// Triangles without an instance color get their face color
+#define DrawModelTriangles(indexType)                                                                                          \
+	{                                                                                                                          \
+		const indexType* indices = model->indices;                                                                             \
+		for (size_t i = firstTriangle; i < firstTriangle + trianglesCount; i++) {                                              \
+			const Color col = instanceColor ? *instanceColor : model->faceColors[i];                                           \
+			RasterTargetDrawScreenTriangle(screen, vertexOffset, indices[i * 3], indices[i * 3 + 1], indices[i * 3 + 2], col); \
+		}                                                                                                                      \
+	}
+
+static void RasterTargetDrawInstanceTriangles(RasterTarget* screen, const RasterModel* model, size_t firstTriangle,
+											  size_t trianglesCount, size_t vertexOffset, const Color* instanceColor) {
+	if (model->indexType == RASTER_INDEX_UINT16) DrawModelTriangles(uint16_t) else DrawModelTriangles(uint32_t);
+}
+
+static RasterShadeKernel RasterTargetSelectKernel(const RasterTarget* screen) {
+	if (screen->shading == RASTER_SHADING_DEPTH_ONLY) return RASTER_KERNEL_DEPTH_ONLY;
+	if (screen->texture) return (screen->textureFilter == RASTER_TEXTURE_BILINEAR) ? RASTER_KERNEL_BILINEAR : RASTER_KERNEL_NEAREST;
+	return (screen->shading == RASTER_SHADING_FLAT) ? RASTER_KERNEL_FLAT : RASTER_KERNEL_GOURAUD;
+}
+
+// Normals are lit in model space, with the light brought there instead (exact for rotations and uniform scales)
+static void RasterTargetSetModelTransform(RasterTarget* screen, Matrix transform) {
+	if (screen->shading != RASTER_SHADING_LAMBERT) return;
+
+	Matrix inverse = MatrixInvert(transform);
+	inverse.m12 = inverse.m13 = inverse.m14 = 0.0f;
+	screen->modelLight = Vector3Normalize(Vector3Transform(Vector3Negate(screen->lightDirection), inverse));
+}
+
+// Every triangle of the draw goes to the binner before any is drawn, however many instances it has, and they are all
+// filled by the kernel selected here
+static void RasterTargetBeginModelTriangles(RasterTarget* screen, const RasterModel* model) {
+	screen->model = model;
+	screen->kernel = RasterTargetSelectKernel(screen);
+	if (screen->samples) screen->fill = RasterSampleBufferSelectFill(RasterTargetGetDepthFormat(screen), screen->kernel);
+	else screen->fill = RasterDepthBufferSelectFill(RasterTargetGetDepthFormat(screen), screen->kernel);
+	if (screen->threadPool) {
+		RasterBinnerReset(screen->binner);
+		RasterBinnerSetKernel(screen->binner, screen->kernel, screen->fill, screen->texture);
+	}
+}
+
+static void RasterTargetEndModelTriangles(RasterTarget* screen) {
+	if (screen->threadPool) RasterTargetFlushBins(screen);
+}
+
+// Transforms the vertices of the visible meshlets only, at the same place as RasterTargetTransformInstances would
+typedef struct MeshletTransformJob {
+	const RasterModel* model;
+	const uint32_t* visibleMeshlets;
+	uint32_t visibleCount;
+	Matrix mvp;
+	uint32_t width;
+	uint32_t height;
+	RasterScreenVertex* screenVertices;
+	uint16_t* outcodes;
+} MeshletTransformJob;
+
+static void MeshletTransformJobFunc(void* userData, uint32_t jobIndex) {
+	const MeshletTransformJob* job = userData;
+	const uint32_t first = jobIndex * MESHLET_JOB_SIZE;
+	const uint32_t end = Min(job->visibleCount, first + MESHLET_JOB_SIZE);
+
+	for (uint32_t i = first; i < end; i++) {
+		const RasterMeshlet* meshlet = job->model->meshlets + job->visibleMeshlets[i];
+		RasterTransformVertices(job->model->positions + meshlet->firstVertex, meshlet->verticesCount, job->mvp, job->width, job->height,
+								job->screenVertices + meshlet->firstVertex, job->outcodes + meshlet->firstVertex);
+	}
+}
+
+// Meshlets outside of the view or facing away are rejected as a whole, before any of their vertices are transformed
+static void RasterTargetDrawMeshlets(RasterTarget* screen, const RasterModel* model, Matrix mvp) {
+	RasterArena arena;
+	RasterArenaInit(&arena, 0);
+	uint32_t* visibleMeshlets = RasterArenaAllocArray(&arena, model->meshletsSize, sizeof(uint32_t));
+	if (!visibleMeshlets) {
+		LogString("Could not allocate the visible meshlets\n");
+		return;
+	}
+
+	const RasterMeshletView view = RasterMeshletViewFromMatrix(mvp, screen->cullMode);
+	uint32_t visibleCount = 0;
+	for (size_t i = 0; i < model->meshletsSize; i++) {
+		const RasterMeshlet* meshlet = model->meshlets + i;
+		const RasterMeshletVisibility visibility = RasterMeshletCull(&view, meshlet);
+		if (visibility == RASTER_MESHLET_VISIBLE) {
+			visibleMeshlets[visibleCount++] = i;
+			continue;
+		}
+
+		screen->cullStats.meshletsCulled++;
+		screen->cullStats.submitted += meshlet->trianglesCount;
+		if (visibility == RASTER_MESHLET_OUTSIDE) screen->cullStats.frustumCulled += meshlet->trianglesCount;
+		else screen->cullStats.backFaceCulled += meshlet->trianglesCount;
+	}
+
+	MeshletTransformJob job = (MeshletTransformJob){
+		.model = model,
+		.visibleMeshlets = visibleMeshlets,
+		.visibleCount = visibleCount,
+		.mvp = mvp,
+		.width = screen->width,
+		.height = screen->height,
+		.screenVertices = screen->screenVertices,
+		.outcodes = screen->screenOutcodes,
 	};
+
+	const uint32_t jobCount = (visibleCount + MESHLET_JOB_SIZE - 1) / MESHLET_JOB_SIZE;
+	if (screen->threadPool && jobCount > 1) {
+		RasterThreadPoolRun(screen->threadPool, MeshletTransformJobFunc, &job, jobCount);
+	} else {
+		for (uint32_t i = 0; i < jobCount; i++) MeshletTransformJobFunc(&job, i);
+	}
+
+	RasterStatsSwitch(&screen->stats, RASTER_STAGE_SETUP);
+	RasterTargetBeginModelTriangles(screen, model);
+
+	for (uint32_t i = 0; i < visibleCount; i++) {
+		const RasterMeshlet* meshlet = model->meshlets + visibleMeshlets[i];
+		RasterTargetDrawInstanceTriangles(screen, model, meshlet->firstTriangle, meshlet->trianglesCount, 0, NULL);
+	}
+
+	RasterTargetEndModelTriangles(screen);
+	RasterArenaFree(&arena);
 }
 
-void RasterTargetDrawModel(RasterTarget* screen, const RasterModel* model) {
-	for (size_t i = 0; i < model->facesSize; i++) {
-		const RasterModelFace* face = model->faces + i;
+void RasterTargetDrawModel(RasterTarget* screen, const RasterModel* model) { RasterTargetDrawModelEx(screen, model, MatrixIdentity()); }
+
+// Triangles filled on the calling thread switch to RASTER_STAGE_RASTER while they are, binned ones once flushed
+void RasterTargetDrawModelEx(RasterTarget* screen, const RasterModel* model, Matrix transform) {
+	RasterStatsEnter(&screen->stats, RASTER_STAGE_TRANSFORM);
+	if (!RasterTargetReserveScreenVertices(screen, model->verticesSize)) {
+		LogString("Could not allocate the transformed vertices\n");
+		RasterStatsLeave(&screen->stats);
+		return;
+	}
+
+	const Matrix mvp = MatrixMultiply(transform, screen->viewProjection);
+	RasterTargetSetModelTransform(screen, transform);
+	if (model->meshletsSize) {
+		RasterTargetDrawMeshlets(screen, model, mvp);
+		RasterStatsLeave(&screen->stats);
+		return;
+	}
+
+	RasterTargetTransformInstances(screen, model, &mvp, 1);
 
-		uint16_t aIdx = face->vertexIndeces[0];
-		const Vector2 a = RasterWorldToScreen(screen, model->vertices[aIdx]);
-		for (size_t j = 1; j < face->indicesSize - 1; j++) {
-			const uint16_t bIdx = face->vertexIndeces[j];
-			const Vector2 b = RasterWorldToScreen(screen, model->vertices[bIdx]);
+	RasterStatsSwitch(&screen->stats, RASTER_STAGE_SETUP);
+	RasterTargetBeginModelTriangles(screen, model);
+	RasterTargetDrawInstanceTriangles(screen, model, 0, model->trianglesSize, 0, NULL);
+	RasterTargetEndModelTriangles(screen);
+	RasterStatsLeave(&screen->stats);
+}
+
+static bool RasterTargetCullsInstance(const RasterFrustum* frustum, const RasterModel* model, Matrix transform) {
+	Vector3 center = model->boundsCenter;
+	float radius = model->boundsRadius;
+	RasterTransformSphere(transform, &center, &radius);
+	return RasterFrustumCullsSphere(frustum, center, radius);
+}
 
-			const uint16_t cIdx = face->vertexIndeces[j + 1];
-			const Vector2 c = RasterWorldToScreen(screen, model->vertices[cIdx]);
+// Instances are culled as a whole before any of their vertices are transformed, the visible ones are then transformed
+// in batches, each batch's triangles being submitted before the next batch overwrites screen->screenVertices
+void RasterTargetDrawModelInstanced(RasterTarget* screen, const RasterModel* model, const Matrix* transforms, const Color* colors,
+									uint32_t instancesCount) {
+	RasterStatsEnter(&screen->stats, RASTER_STAGE_TRANSFORM);
 
-			RasterTargetDrawTriangle(screen, a, b, c, GetColor((rand() << 1) | 0xFF));
+	const size_t batchVertices = Max(model->verticesSize, (size_t)1);
+	const size_t batchSize = Min(Max((size_t)INSTANCE_BATCH_VERTICES / batchVertices, (size_t)1), (size_t)instancesCount);
+	RasterArena arena;
+	RasterArenaInit(&arena, 0);
+	Matrix* mvps = RasterArenaAllocArray(&arena, instancesCount, sizeof(Matrix));
+	uint32_t* visible = RasterArenaAllocArray(&arena, instancesCount, sizeof(uint32_t));
+	if (!mvps || !visible || !RasterTargetReserveScreenVertices(screen, batchSize * model->verticesSize)) {
+		LogString("Could not allocate the transformed vertices\n");
+		RasterArenaFree(&arena);
+		RasterStatsLeave(&screen->stats);
+		return;
+	}
+
+	const RasterFrustum frustum = RasterFrustumFromMatrix(screen->viewProjection);
+	uint32_t visibleCount = 0;
+	for (uint32_t i = 0; i < instancesCount; i++) {
+		if (RasterTargetCullsInstance(&frustum, model, transforms[i])) {
+			screen->cullStats.instancesCulled++;
+			screen->cullStats.submitted += model->trianglesSize;
+			screen->cullStats.frustumCulled += model->trianglesSize;
+			continue;
 		}
+
+		mvps[visibleCount] = MatrixMultiply(transforms[i], screen->viewProjection);
+		visible[visibleCount++] = i;
 	}
+
+	RasterTargetBeginModelTriangles(screen, model);
+	for (uint32_t first = 0; first < visibleCount; first += batchSize) {
+		const uint32_t count = Min(visibleCount - first, (uint32_t)batchSize);
+
+		RasterStatsSwitch(&screen->stats, RASTER_STAGE_TRANSFORM);
+		RasterTargetTransformInstances(screen, model, mvps + first, count);
+
+		RasterStatsSwitch(&screen->stats, RASTER_STAGE_SETUP);
+		for (uint32_t i = 0; i < count; i++) {
+			const Color* instanceColor = colors ? colors + visible[first + i] : NULL;
+			RasterTargetSetModelTransform(screen, transforms[visible[first + i]]);
+			RasterTargetDrawInstanceTriangles(screen, model, 0, model->trianglesSize, (size_t)i * model->verticesSize, instanceColor);
+		}
+	}
+
+	RasterStatsSwitch(&screen->stats, RASTER_STAGE_SETUP);
+	RasterTargetEndModelTriangles(screen);
+	RasterArenaFree(&arena);
+	RasterStatsLeave(&screen->stats);
 }
@@ -0,0 +1,298 @@
+#include "RasterTexture.h"
+
+#include "RasterFileMap.h"
+
+#include <ctype.h>
+
+#define BMP_HEADERS_MIN_SIZE 54
+#define BMP_COMPRESSION_RGB 0
+#define PPM_MAX_VALUE 255
+
+// Width or height of the textures, so every level's blocks fit in a size_t
+#define MAX_TEXTURE_SIZE 32768
+
+static uint32_t BlocksCount(uint32_t texelsCount) {
+	return (texelsCount + RASTER_TEXTURE_BLOCK_SIZE - 1) / RASTER_TEXTURE_BLOCK_SIZE;
+}
+
+static size_t LevelSize(uint32_t width, uint32_t height) {
+	return (size_t)BlocksCount(width) * BlocksCount(height) * RASTER_TEXTURE_BLOCK_TEXELS;
+}
+
+// Rounded average of 4 colors, channel by channel
+static Color AverageColors(Color a, Color b, Color c, Color d) {
+	return (Color){
+		.r = (a.r + b.r + c.r + d.r + 2) / 4,
+		.g = (a.g + b.g + c.g + d.g + 2) / 4,
+		.b = (a.b + b.b + c.b + d.b + 2) / 4,
+		.a = (a.a + b.a + c.a + d.a + 2) / 4,
+	};
+}
+
+// Box filter, the last row and column of odd sized levels are averaged with themselves
+static void BuildLevel(const RasterTextureLevel* from, RasterTextureLevel* to) {
+	for (uint32_t y = 0; y < to->height; y++) {
+		const uint32_t y0 = Min(y * 2, from->height - 1);
+		const uint32_t y1 = Min(y * 2 + 1, from->height - 1);
+
+		for (uint32_t x = 0; x < to->width; x++) {
+			const uint32_t x0 = Min(x * 2, from->width - 1);
+			const uint32_t x1 = Min(x * 2 + 1, from->width - 1);
+
+			to->texels[RasterTexelIndex(to, x, y)] =
+				AverageColors(from->texels[RasterTexelIndex(from, x0, y0)], from->texels[RasterTexelIndex(from, x1, y0)],
+							  from->texels[RasterTexelIndex(from, x0, y1)], from->texels[RasterTexelIndex(from, x1, y1)]);
+		}
+	}
+}
+
+RasterTexture* RasterTextureCreate(const Color* pixels, uint32_t width, uint32_t height, bool mipmaps) {
+	if (!width || !height || width > MAX_TEXTURE_SIZE || height > MAX_TEXTURE_SIZE) return NULL;
+
+	RasterTexture* texture = NULL;
+	if (!Malloc(texture, sizeof(RasterTexture))) return NULL;
+	*texture = (RasterTexture){0};
+
+	size_t texelsSize = 0;
+	uint32_t levelWidth = width;
+	uint32_t levelHeight = height;
+	while (texture->levelsCount < RASTER_TEXTURE_MAX_LEVELS) {
+		texture->levels[texture->levelsCount++] = (RasterTextureLevel){
+			.width = levelWidth,
+			.height = levelHeight,
+			.blocksX = BlocksCount(levelWidth),
+		};
+		texelsSize += LevelSize(levelWidth, levelHeight);
+
+		if (!mipmaps || (levelWidth == 1 && levelHeight == 1)) break;
+		levelWidth = Max(levelWidth / 2, 1u);
+		levelHeight = Max(levelHeight / 2, 1u);
+	}
+
+	// Zeroed so the padding of partial blocks is deterministic
+	if (!Malloc(texture->texels, texelsSize * sizeof(Color))) FreeAndReturn(texture, NULL);
+	memset(texture->texels, 0, texelsSize * sizeof(Color));
+
+	Color* levelTexels = texture->texels;
+	for (uint32_t i = 0; i < texture->levelsCount; i++) {
+		RasterTextureLevel* level = texture->levels + i;
+		level->texels = levelTexels;
+		levelTexels += LevelSize(level->width, level->height);
+	}
+
+	const RasterTextureLevel* base = texture->levels;
+	for (uint32_t y = 0; y < height; y++) {
+		for (uint32_t x = 0; x < width; x++) {
+			base->texels[RasterTexelIndex(base, x, y)] = pixels[Index1D(x, y, width)];
+		}
+	}
+
+	for (uint32_t i = 1; i < texture->levelsCount; i++) {
+		BuildLevel(texture->levels + i - 1, texture->levels + i);
+	}
+
+	return texture;
+}
+
+RasterTexture* RasterTextureCreateChecker(uint32_t size, uint32_t cells, Color a, Color b, bool mipmaps) {
+	if (!size || !cells || cells > size) return NULL;
+
+	Color* pixels = NULL;
+	if (!Malloc(pixels, (size_t)size * size * sizeof(Color))) return NULL;
+
+	for (uint32_t y = 0; y < size; y++) {
+		for (uint32_t x = 0; x < size; x++) {
+			const uint32_t cellX = (uint64_t)x * cells / size;
+			const uint32_t cellY = (uint64_t)y * cells / size;
+			pixels[Index1D(x, y, size)] = ((cellX + cellY) % 2) ? b : a;
+		}
+	}
+
+	RasterTexture* texture = RasterTextureCreate(pixels, size, size, mipmaps);
+	Free(pixels);
+	return texture;
+}
+
+void RasterTextureFree(RasterTexture* texture) {
+	Free(texture->texels);
+	Free(texture);
+}
+
+// ============= Loading =============
+
+// Little endian, whatever the host's endianness
+static uint32_t GetUInt16(const uint8_t* data) { return data[0] | (data[1] << 8); }
+
+static uint32_t GetUInt32(const uint8_t* data) { return GetUInt16(data) | (GetUInt16(data + 2) << 16); }
+
+static RasterTexture* LoadBMP(const uint8_t* data, size_t size, bool mipmaps) {
+	if (size < BMP_HEADERS_MIN_SIZE) return NULL;
+
+	const uint32_t dataOffset = GetUInt32(data + 10);
+	const int32_t width = (int32_t)GetUInt32(data + 18);
+	const int32_t signedHeight = (int32_t)GetUInt32(data + 22);  // Negative for top-down BMPs
+	const uint32_t bitsPerPixel = GetUInt16(data + 28);
+	const uint32_t compression = GetUInt32(data + 30);
+
+	if ((bitsPerPixel != 24 && bitsPerPixel != 32) || compression != BMP_COMPRESSION_RGB) return NULL;
+	if (width <= 0 || width > MAX_TEXTURE_SIZE || !signedHeight || signedHeight < -MAX_TEXTURE_SIZE || signedHeight > MAX_TEXTURE_SIZE) {
+		return NULL;
+	}
+
+	const uint32_t height = (signedHeight < 0) ? -signedHeight : signedHeight;
+	const uint32_t pixelSize = bitsPerPixel / 8;
+	const size_t rowSize = ((size_t)width * pixelSize + 3) & ~(size_t)3;
+	if (dataOffset > size || rowSize * height > size - dataOffset) return NULL;
+
+	Color* pixels = NULL;
+	if (!Malloc(pixels, (size_t)width * height * sizeof(Color))) return NULL;
+
+	// The alpha byte of 32 bits BMPs without bit masks is unused
+	for (uint32_t y = 0; y < height; y++) {
+		const uint8_t* row = data + dataOffset + rowSize * ((signedHeight < 0) ? y : height - 1 - y);
+		for (int32_t x = 0; x < width; x++) {
+			const uint8_t* bgr = row + x * pixelSize;
+			pixels[Index1D(x, y, width)] = (Color){bgr[2], bgr[1], bgr[0], 0xFF};
+		}
+	}
+
+	RasterTexture* texture = RasterTextureCreate(pixels, width, height, mipmaps);
+	Free(pixels);
+	return texture;
+}
+
+// Skips whitespace and comments, then parses an unsigned decimal value
+static bool ScanPPMValue(const uint8_t** cursor, const uint8_t* end, uint32_t maxValue, uint32_t* value) {
+	const uint8_t* c = *cursor;
+	while (c < end && (isspace(*c) || *c == '#')) {
+		if (*c == '#') {
+			while (c < end && *c != '\n') c++;
+		} else {
+			c++;
+		}
+	}
+
+	uint64_t parsed = 0;
+	const uint8_t* digits = c;
+	while (c < end && isdigit(*c) && parsed <= maxValue) parsed = parsed * 10 + (*c++ - '0');
+	if (c == digits || parsed > maxValue) return false;
+
+	*value = parsed;
+	*cursor = c;
+	return true;
+}
+
+static RasterTexture* LoadPPM(const uint8_t* data, size_t size, bool mipmaps) {
+	const uint8_t* cursor = data + 2;
+	const uint8_t* end = data + size;
+
+	uint32_t width;
+	uint32_t height;
+	uint32_t maxValue;
+	if (!ScanPPMValue(&cursor, end, MAX_TEXTURE_SIZE, &width) || !ScanPPMValue(&cursor, end, MAX_TEXTURE_SIZE, &height)) return NULL;
+	if (!ScanPPMValue(&cursor, end, PPM_MAX_VALUE, &maxValue) || !width || !height || !maxValue) return NULL;
+
+	// A single whitespace separates the header from the texels
+	if (cursor >= end || !isspace(*cursor)) return NULL;
+	cursor++;
+	if ((size_t)(end - cursor) < (size_t)width * height * 3) return NULL;
+
+	Color* pixels = NULL;
+	if (!Malloc(pixels, (size_t)width * height * sizeof(Color))) return NULL;
+
+	for (size_t i = 0; i < (size_t)width * height; i++) {
+		const uint8_t* rgb = cursor + i * 3;
+		pixels[i] = (Color){
+			.r = Min((uint32_t)rgb[0], maxValue) * 255 / maxValue,
+			.g = Min((uint32_t)rgb[1], maxValue) * 255 / maxValue,
+			.b = Min((uint32_t)rgb[2], maxValue) * 255 / maxValue,
+			.a = 0xFF,
+		};
+	}
+
+	RasterTexture* texture = RasterTextureCreate(pixels, width, height, mipmaps);
+	Free(pixels);
+	return texture;
+}
+
+#ifndef RASTER_HEADLESS
+static RasterTexture* LoadWithRaylib(const char* path, bool mipmaps) {
+	Image image = LoadImage(path);
+	if (!IsImageValid(image)) return NULL;
+
+	ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+	RasterTexture* texture = NULL;
+	if (image.format == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) {
+		texture = RasterTextureCreate(image.data, image.width, image.height, mipmaps);
+	}
+
+	UnloadImage(image);
+	return texture;
+}
+#endif
+
+RasterTexture* LoadRasterTextureFromFile(const char* path, bool mipmaps) {
+	RasterFileMap file;
+	if (!RasterFileMapOpen(&file, path)) return NULL;
+
+	const uint8_t* data = (const uint8_t*)file.data;
+	RasterTexture* texture = NULL;
+	bool parsed = false;
+	if (file.size >= 2 && data[0] == 'B' && data[1] == 'M') {
+		texture = LoadBMP(data, file.size, mipmaps);
+		parsed = true;
+	} else if (file.size >= 2 && data[0] == 'P' && data[1] == '6') {
+		texture = LoadPPM(data, file.size, mipmaps);
+		parsed = true;
+	}
+	RasterFileMapClose(&file);
+
+#ifndef RASTER_HEADLESS
+	if (!parsed) texture = LoadWithRaylib(path, mipmaps);
+#else
+	(void)parsed;
+#endif
+
+	return texture;
+}
+
+// ============= Rasterization =============
+
+static float TriangleArea(Vector2 a, Vector2 b, Vector2 c) { return fabsf((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x)); }
+
+// The level with about one texel per pixel, estimated from the areas the whole triangle covers in both spaces
+static uint32_t SelectLevel(const RasterTexture* texture, const Vector3 positions[3], const Vector2 texCoords[3]) {
+	const RasterTextureLevel* base = texture->levels;
+	const float texelsArea = TriangleArea(texCoords[0], texCoords[1], texCoords[2]) * base->width * base->height;
+	const float pixelsArea = TriangleArea((Vector2){positions[0].x, positions[0].y}, (Vector2){positions[1].x, positions[1].y},
+										  (Vector2){positions[2].x, positions[2].y});
+	if (!(texelsArea > pixelsArea)) return 0;
+
+	// Each level has a quarter of the texels of the previous one
+	const float level = roundf(0.5f * log2f(texelsArea / pixelsArea));
+	return (level < texture->levelsCount - 1) ? (uint32_t)level : texture->levelsCount - 1;
+}
+
+void RasterUVPlanesSetup(RasterUVPlanes* uv, const RasterTriangle* tri, const RasterTexture* texture, const Vector3 positions[3],
+						 const float w[3], const Vector2 texCoords[3]) {
+	uv->level = SelectLevel(texture, positions, texCoords);
+	uv->originX = tri->bounds.minX;
+	uv->originY = tri->bounds.minY;
+
+	// Texture coordinates go up, texel rows go down
+	const RasterTextureLevel* level = texture->levels + uv->level;
+	float values[3][3];
+	for (uint32_t i = 0; i < 3; i++) {
+		const float oneOverW = 1.0f / w[i];
+		values[0][i] = texCoords[i].x * level->width * oneOverW;
+		values[1][i] = (1.0f - texCoords[i].y) * level->height * oneOverW;
+		values[2][i] = oneOverW;
+	}
+
+	RasterPlane planes[3];
+	RasterTriangleSetupPlanes(tri, (Vector2){positions[0].x, positions[0].y}, (Vector2){positions[1].x, positions[1].y},
+							  (Vector2){positions[2].x, positions[2].y}, values, 3, planes);
+	uv->uOverW = planes[0];
+	uv->vOverW = planes[1];
+	uv->oneOverW = planes[2];
+}
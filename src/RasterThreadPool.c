@@ -0,0 +1,121 @@
+#include "RasterThreadPool.h"
+
+#include <unistd.h>
+
+uint32_t RasterThreadPoolDefaultThreadCount(void) {
+#ifdef _SC_NPROCESSORS_ONLN
+	const long cpuCount = sysconf(_SC_NPROCESSORS_ONLN);
+	if (cpuCount > 0) return cpuCount;
+#endif
+	return 1;
+}
+
+static void RunPendingJobs(RasterThreadPool* pool) {
+	uint32_t jobIndex;
+	while ((jobIndex = atomic_fetch_add_explicit(&pool->nextJob, 1, memory_order_relaxed)) < pool->jobCount) {
+		pool->func(pool->userData, jobIndex);
+	}
+}
+
+static void* WorkerMain(void* userData) {
+	RasterThreadPool* pool = userData;
+	uint64_t seenGeneration = 0;
+
+	pthread_mutex_lock(&pool->mutex);
+	while (true) {
+		while (!pool->stopping && pool->generation == seenGeneration) {
+			pthread_cond_wait(&pool->workCond, &pool->mutex);
+		}
+		if (pool->stopping) break;
+
+		seenGeneration = pool->generation;
+		pthread_mutex_unlock(&pool->mutex);
+
+		RunPendingJobs(pool);
+
+		pthread_mutex_lock(&pool->mutex);
+		pool->busyWorkers--;
+		if (!pool->busyWorkers) pthread_cond_signal(&pool->doneCond);
+	}
+	pthread_mutex_unlock(&pool->mutex);
+
+	return NULL;
+}
+
+static void StopWorkers(RasterThreadPool* pool, uint32_t startedCount) {
+	pthread_mutex_lock(&pool->mutex);
+	pool->stopping = true;
+	pthread_cond_broadcast(&pool->workCond);
+	pthread_mutex_unlock(&pool->mutex);
+
+	for (uint32_t i = 0; i < startedCount; i++) {
+		pthread_join(pool->workers[i], NULL);
+	}
+}
+
+RasterThreadPool* RasterThreadPoolCreate(uint32_t threadCount) {
+	RasterThreadPool* pool = NULL;
+	if (!Malloc(pool, sizeof(RasterThreadPool))) return NULL;
+
+	*pool = (RasterThreadPool){0};
+	pool->workersSize = (threadCount > 1) ? threadCount - 1 : 0;
+	atomic_init(&pool->nextJob, 0);
+
+	if (pool->workersSize && !Malloc(pool->workers, pool->workersSize * sizeof(pthread_t))) FreeAndReturn(pool, NULL);
+
+	pthread_mutex_init(&pool->mutex, NULL);
+	pthread_cond_init(&pool->workCond, NULL);
+	pthread_cond_init(&pool->doneCond, NULL);
+
+	for (uint32_t i = 0; i < pool->workersSize; i++) {
+		if (pthread_create(pool->workers + i, NULL, WorkerMain, pool)) {
+			StopWorkers(pool, i);
+			pool->workersSize = 0;
+			RasterThreadPoolFree(pool);
+			return NULL;
+		}
+	}
+
+	return pool;
+}
+
+void RasterThreadPoolFree(RasterThreadPool* pool) {
+	StopWorkers(pool, pool->workersSize);
+
+	pthread_cond_destroy(&pool->doneCond);
+	pthread_cond_destroy(&pool->workCond);
+	pthread_mutex_destroy(&pool->mutex);
+
+	if (pool->workers) Free(pool->workers);
+	Free(pool);
+}
+
+uint32_t RasterThreadPoolThreadCount(const RasterThreadPool* pool) { return pool->workersSize + 1; }
+
+void RasterThreadPoolRun(RasterThreadPool* pool, RasterJobFunc func, void* userData, uint32_t jobCount) {
+	if (!jobCount) return;
+
+	pool->func = func;
+	pool->userData = userData;
+	pool->jobCount = jobCount;
+	atomic_store_explicit(&pool->nextJob, 0, memory_order_relaxed);
+
+	if (!pool->workersSize) {
+		RunPendingJobs(pool);
+		return;
+	}
+
+	pthread_mutex_lock(&pool->mutex);
+	pool->busyWorkers = pool->workersSize;
+	pool->generation++;
+	pthread_cond_broadcast(&pool->workCond);
+	pthread_mutex_unlock(&pool->mutex);
+
+	RunPendingJobs(pool);
+
+	pthread_mutex_lock(&pool->mutex);
+	while (pool->busyWorkers) {
+		pthread_cond_wait(&pool->doneCond, &pool->mutex);
+	}
+	pthread_mutex_unlock(&pool->mutex);
+}
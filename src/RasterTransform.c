@@ -0,0 +1,215 @@
+#include "RasterTransform.h"
+
+#if defined(__SSE2__)
+#define RASTER_SSE_TRANSFORM 1
+#include <immintrin.h>
+#else
+#define RASTER_SSE_TRANSFORM 0
+#endif
+
+Matrix RasterCameraViewProjection(Camera3D camera, float aspect) {
+	const Matrix view = MatrixLookAt(camera.position, camera.target, camera.up);
+
+	Matrix projection;
+	if (camera.projection == CAMERA_ORTHOGRAPHIC) {
+		const double top = camera.fovy / 2.0;
+		const double right = top * aspect;
+		projection = MatrixOrtho(-right, right, -top, top, RASTER_CAMERA_NEAR, RASTER_CAMERA_FAR);
+	} else {
+		projection = MatrixPerspective(camera.fovy * DEG2RAD, aspect, RASTER_CAMERA_NEAR, RASTER_CAMERA_FAR);
+	}
+
+	return MatrixMultiply(view, projection);
+}
+
+Matrix RasterDefaultViewProjection(uint32_t width, uint32_t height, float heightInWorld) {
+	const double halfHeight = heightInWorld / 2.0;
+	const double halfWidth = halfHeight * width / height;
+
+	// Swapped bottom/top and near/far flip y and make depth grow with z
+	return MatrixOrtho(-halfWidth, halfWidth, halfHeight, -halfHeight, heightInWorld, -heightInWorld);
+}
+
+// Each plane is a combination of the w row and another row of the clip space transform (-w <= x <= w, and so on)
+RasterFrustum RasterFrustumFromMatrix(Matrix mvp) {
+	const Vector4 rows[4] = {
+		{mvp.m0, mvp.m4, mvp.m8, mvp.m12},
+		{mvp.m1, mvp.m5, mvp.m9, mvp.m13},
+		{mvp.m2, mvp.m6, mvp.m10, mvp.m14},
+		{mvp.m3, mvp.m7, mvp.m11, mvp.m15},
+	};
+
+	RasterFrustum frustum;
+	for (uint32_t i = 0; i < 6; i++) {
+		const Vector4 row = rows[i / 2];
+		const float sign = (i % 2) ? -1.0f : 1.0f;
+		Vector4 plane = (Vector4){
+			rows[3].x + sign * row.x,
+			rows[3].y + sign * row.y,
+			rows[3].z + sign * row.z,
+			rows[3].w + sign * row.w,
+		};
+
+		// Degenerate planes are left as is, their distances are then only compared by sign
+		const float length = sqrtf(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+		if (length > 0) {
+			plane.x /= length;
+			plane.y /= length;
+			plane.z /= length;
+			plane.w /= length;
+		}
+		frustum.planes[i] = plane;
+	}
+	return frustum;
+}
+
+bool RasterFrustumCullsSphere(const RasterFrustum* frustum, Vector3 center, float radius) {
+	for (uint32_t i = 0; i < 6; i++) {
+		const Vector4* plane = frustum->planes + i;
+		if (plane->x * center.x + plane->y * center.y + plane->z * center.z + plane->w < -radius) return true;
+	}
+	return false;
+}
+
+void RasterTransformSphere(Matrix transform, Vector3* center, float* radius) {
+	const float scaleX = Vector3Length((Vector3){transform.m0, transform.m1, transform.m2});
+	const float scaleY = Vector3Length((Vector3){transform.m4, transform.m5, transform.m6});
+	const float scaleZ = Vector3Length((Vector3){transform.m8, transform.m9, transform.m10});
+
+	*center = Vector3Transform(*center, transform);
+	*radius *= fmaxf(scaleX, fmaxf(scaleY, scaleZ));
+}
+
+// Clip space to pixels and depth, before the perspective division (which it commutes with)
+static Matrix ViewportMatrix(uint32_t width, uint32_t height) {
+	const float halfWidth = width / 2.0f;
+	const float halfHeight = height / 2.0f;
+
+	Matrix viewport = MatrixIdentity();
+	viewport.m0 = halfWidth;
+	viewport.m12 = halfWidth;
+	viewport.m5 = -halfHeight;
+	viewport.m13 = halfHeight;
+	viewport.m10 = 0.5f;
+	viewport.m14 = 0.5f;
+	return viewport;
+}
+
+// Planes in pixels and depth before the division, x in [0, width * w], y in [0, height * w] and z in [0, w]
+static uint16_t VertexOutcode(float x, float y, float z, float w, float width, float height) {
+	const float guard = RASTER_GUARD_BAND * w;
+	uint16_t outcode = 0;
+	if (x < 0) outcode |= RASTER_OUT_LEFT;
+	if (x > width * w) outcode |= RASTER_OUT_RIGHT;
+	if (y < 0) outcode |= RASTER_OUT_TOP;
+	if (y > height * w) outcode |= RASTER_OUT_BOTTOM;
+	if (z < 0) outcode |= RASTER_OUT_NEAR;
+	if (z > w) outcode |= RASTER_OUT_FAR;
+	if (x < -guard) outcode |= RASTER_OUT_GUARD_LEFT;
+	if (x > guard) outcode |= RASTER_OUT_GUARD_RIGHT;
+	if (y < -guard) outcode |= RASTER_OUT_GUARD_TOP;
+	if (y > guard) outcode |= RASTER_OUT_GUARD_BOTTOM;
+	return outcode;
+}
+
+static RasterScreenVertex TransformVertex(Vector3 v, const Matrix* m, float width, float height, uint16_t* outcode) {
+	const float x = m->m0 * v.x + m->m4 * v.y + m->m8 * v.z + m->m12;
+	const float y = m->m1 * v.x + m->m5 * v.y + m->m9 * v.z + m->m13;
+	const float z = m->m2 * v.x + m->m6 * v.y + m->m10 * v.z + m->m14;
+	const float w = m->m3 * v.x + m->m7 * v.y + m->m11 * v.z + m->m15;
+
+	*outcode = VertexOutcode(x, y, z, w, width, height);
+	if (*outcode & RASTER_OUT_CLIP_MASK) return (RasterScreenVertex){x, y, z, w};
+	return (RasterScreenVertex){x / w, y / w, z / w, w};
+}
+
+#if RASTER_SSE_TRANSFORM
+
+// Same operations in the same order as TransformVertex, so both give the exact same results
+static __m128 TransformRow(__m128 x, __m128 y, __m128 z, float mx, float my, float mz, float mw) {
+	__m128 result = _mm_mul_ps(_mm_set1_ps(mx), x);
+	result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(my), y));
+	result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(mz), z));
+	return _mm_add_ps(result, _mm_set1_ps(mw));
+}
+
+// Lanes of mask get bit, others 0
+static __m128i OutcodeBit(__m128 mask, int32_t bit) { return _mm_and_si128(_mm_castps_si128(mask), _mm_set1_epi32(bit)); }
+
+static __m128i VertexOutcodes(__m128 x, __m128 y, __m128 z, __m128 w, float width, float height) {
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 guard = _mm_mul_ps(_mm_set1_ps(RASTER_GUARD_BAND), w);
+	const __m128 negGuard = _mm_sub_ps(zero, guard);
+
+	__m128i outcodes = OutcodeBit(_mm_cmplt_ps(x, zero), RASTER_OUT_LEFT);
+	outcodes = _mm_or_si128(outcodes, OutcodeBit(_mm_cmpgt_ps(x, _mm_mul_ps(_mm_set1_ps(width), w)), RASTER_OUT_RIGHT));
+	outcodes = _mm_or_si128(outcodes, OutcodeBit(_mm_cmplt_ps(y, zero), RASTER_OUT_TOP));
+	outcodes = _mm_or_si128(outcodes, OutcodeBit(_mm_cmpgt_ps(y, _mm_mul_ps(_mm_set1_ps(height), w)), RASTER_OUT_BOTTOM));
+	outcodes = _mm_or_si128(outcodes, OutcodeBit(_mm_cmplt_ps(z, zero), RASTER_OUT_NEAR));
+	outcodes = _mm_or_si128(outcodes, OutcodeBit(_mm_cmpgt_ps(z, w), RASTER_OUT_FAR));
+	outcodes = _mm_or_si128(outcodes, OutcodeBit(_mm_cmplt_ps(x, negGuard), RASTER_OUT_GUARD_LEFT));
+	outcodes = _mm_or_si128(outcodes, OutcodeBit(_mm_cmpgt_ps(x, guard), RASTER_OUT_GUARD_RIGHT));
+	outcodes = _mm_or_si128(outcodes, OutcodeBit(_mm_cmplt_ps(y, negGuard), RASTER_OUT_GUARD_TOP));
+	outcodes = _mm_or_si128(outcodes, OutcodeBit(_mm_cmpgt_ps(y, guard), RASTER_OUT_GUARD_BOTTOM));
+	return outcodes;
+}
+
+// Divided by w, except in the lanes of keep
+static __m128 DivideUnless(__m128 value, __m128 w, __m128 keep) {
+	return _mm_or_ps(_mm_and_ps(keep, value), _mm_andnot_ps(keep, _mm_div_ps(value, w)));
+}
+
+// 4 vertices per iteration, their 12 floats are loaded as is and shuffled into one register per coordinate
+static size_t TransformVerticesSSE(const Vector3* positions, size_t count, const Matrix* m, float width, float height,
+								   RasterScreenVertex* screenVertices, uint16_t* outcodes) {
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const float* src = (const float*)(positions + i);
+		const __m128 p0 = _mm_loadu_ps(src);	  // x0 y0 z0 x1
+		const __m128 p1 = _mm_loadu_ps(src + 4);  // y1 z1 x2 y2
+		const __m128 p2 = _mm_loadu_ps(src + 8);  // z2 x3 y3 z3
+
+		const __m128 x = _mm_shuffle_ps(p0, _mm_shuffle_ps(p1, p2, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+		const __m128 y = _mm_shuffle_ps(_mm_shuffle_ps(p0, p1, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(p1, p2, _MM_SHUFFLE(2, 2, 3, 3)),
+										_MM_SHUFFLE(2, 0, 2, 0));
+		const __m128 z = _mm_shuffle_ps(_mm_shuffle_ps(p0, p1, _MM_SHUFFLE(1, 1, 2, 2)), p2, _MM_SHUFFLE(3, 0, 2, 0));
+
+		const __m128 clipX = TransformRow(x, y, z, m->m0, m->m4, m->m8, m->m12);
+		const __m128 clipY = TransformRow(x, y, z, m->m1, m->m5, m->m9, m->m13);
+		const __m128 clipZ = TransformRow(x, y, z, m->m2, m->m6, m->m10, m->m14);
+		const __m128 w = TransformRow(x, y, z, m->m3, m->m7, m->m11, m->m15);
+
+		const __m128i codes = VertexOutcodes(clipX, clipY, clipZ, w, width, height);
+		_mm_storel_epi64((__m128i*)(outcodes + i), _mm_packs_epi32(codes, codes));
+		const __m128 keep = _mm_castsi128_ps(_mm_cmpgt_epi32(_mm_and_si128(codes, _mm_set1_epi32(RASTER_OUT_CLIP_MASK)), _mm_setzero_si128()));
+
+		__m128 screenX = DivideUnless(clipX, w, keep);
+		__m128 screenY = DivideUnless(clipY, w, keep);
+		__m128 screenZ = DivideUnless(clipZ, w, keep);
+		__m128 screenW = w;
+
+		_MM_TRANSPOSE4_PS(screenX, screenY, screenZ, screenW);
+		float* dst = (float*)(screenVertices + i);
+		_mm_storeu_ps(dst, screenX);
+		_mm_storeu_ps(dst + 4, screenY);
+		_mm_storeu_ps(dst + 8, screenZ);
+		_mm_storeu_ps(dst + 12, screenW);
+	}
+	return i;
+}
+
+#endif	// RASTER_SSE_TRANSFORM
+
+void RasterTransformVertices(const Vector3* positions, size_t count, Matrix mvp, uint32_t width, uint32_t height,
+							 RasterScreenVertex* screenVertices, uint16_t* outcodes) {
+	const Matrix m = MatrixMultiply(mvp, ViewportMatrix(width, height));
+
+	size_t i = 0;
+#if RASTER_SSE_TRANSFORM
+	i = TransformVerticesSSE(positions, count, &m, width, height, screenVertices, outcodes);
+#endif
+
+	for (; i < count; i++) {
+		screenVertices[i] = TransformVertex(positions[i], &m, width, height, outcodes + i);
+	}
+}
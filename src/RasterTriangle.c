@@ -0,0 +1,505 @@
+#include "RasterTriangle.h"
+
+#include <stdatomic.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define RASTER_X86_KERNELS 1
+#include <immintrin.h>
+#else
+#define RASTER_X86_KERNELS 0
+#endif
+
+typedef struct FixedVertex {
+	int64_t x;
+	int64_t y;
+} FixedVertex;
+
+static bool IsInCoordLimit(Vector2 v) {
+	return (fabsf(v.x) <= RASTER_COORD_LIMIT) && (fabsf(v.y) <= RASTER_COORD_LIMIT);	// Also false for NaNs
+}
+
+static FixedVertex ToFixedVertex(Vector2 v) {
+	return (FixedVertex){
+		.x = llroundf(v.x * RASTER_SUBPIXEL_ONE),
+		.y = llroundf(v.y * RASTER_SUBPIXEL_ONE),
+	};
+}
+
+// Same orientation as the old SignedTriangleArea2, E(p) = (p.x - v0.x) * (v1.y - v0.y) - (p.y - v0.y) * (v1.x - v0.x)
+static int64_t EdgeFunction(FixedVertex v0, FixedVertex v1, FixedVertex p) {
+	return (p.x - v0.x) * (v1.y - v0.y) - (p.y - v0.y) * (v1.x - v0.x);
+}
+
+// Top-left fill rule: pixel centers exactly on an edge only belong to the triangle if the edge is a top or left one,
+// so two triangles sharing an edge never both draw the pixels along it
+static bool IsTopLeftEdge(FixedVertex v0, FixedVertex v1) {
+	const int64_t dx = v1.x - v0.x;
+	const int64_t dy = v1.y - v0.y;
+	return (dy > 0) || (dy == 0 && dx < 0);
+}
+
+static RasterEdge EdgeSetup(FixedVertex v0, FixedVertex v1, FixedVertex origin) {
+	return (RasterEdge){
+		.stepX = (v1.y - v0.y) * RASTER_SUBPIXEL_ONE,
+		.stepY = -(v1.x - v0.x) * RASTER_SUBPIXEL_ONE,
+		.origin = EdgeFunction(v0, v1, origin) - (IsTopLeftEdge(v0, v1) ? 0 : 1),
+	};
+}
+
+// Index of the first pixel whose center is >= fixedCoord
+static int64_t FirstPixelFrom(int64_t fixedCoord) {
+	return (fixedCoord - RASTER_SUBPIXEL_HALF + RASTER_SUBPIXEL_ONE - 1) >> RASTER_SUBPIXEL_BITS;
+}
+
+// Index of the first pixel whose center is > fixedCoord
+static int64_t FirstPixelAfter(int64_t fixedCoord) {
+	return ((fixedCoord - RASTER_SUBPIXEL_HALF) >> RASTER_SUBPIXEL_BITS) + 1;
+}
+
+// Center of the top-left pixel of the bounds, where the edges and planes are evaluated from
+static FixedVertex BoundsOrigin(const RasterTriangle* tri) {
+	return (FixedVertex){
+		.x = ((int64_t)tri->bounds.minX << RASTER_SUBPIXEL_BITS) + RASTER_SUBPIXEL_HALF,
+		.y = ((int64_t)tri->bounds.minY << RASTER_SUBPIXEL_BITS) + RASTER_SUBPIXEL_HALF,
+	};
+}
+
+// The bounds hold every pixel whose center is within margin (in subpixels) of the triangle's vertices bounds
+static bool TriangleSetup(RasterTriangle* tri, Vector2 a, Vector2 b, Vector2 c, RasterRect clip, int64_t margin) {
+	if (!IsInCoordLimit(a) || !IsInCoordLimit(b) || !IsInCoordLimit(c)) return false;
+
+	const FixedVertex fixedA = ToFixedVertex(a);
+	const FixedVertex fixedB = ToFixedVertex(b);
+	const FixedVertex fixedC = ToFixedVertex(c);
+
+	// Degenerate and counter-clockwise triangles cover nothing
+	if (EdgeFunction(fixedA, fixedB, fixedC) <= 0) return false;
+
+	const int64_t minX = FirstPixelFrom(Min(fixedA.x, Min(fixedB.x, fixedC.x)) - margin);
+	const int64_t minY = FirstPixelFrom(Min(fixedA.y, Min(fixedB.y, fixedC.y)) - margin);
+	const int64_t maxX = FirstPixelAfter(Max(fixedA.x, Max(fixedB.x, fixedC.x)) + margin);
+	const int64_t maxY = FirstPixelAfter(Max(fixedA.y, Max(fixedB.y, fixedC.y)) + margin);
+
+	tri->bounds = (RasterRect){
+		.minX = Max(minX, clip.minX),
+		.minY = Max(minY, clip.minY),
+		.maxX = Min(maxX, clip.maxX),
+		.maxY = Min(maxY, clip.maxY),
+	};
+	if (tri->bounds.minX >= tri->bounds.maxX || tri->bounds.minY >= tri->bounds.maxY) return false;
+
+	const FixedVertex origin = BoundsOrigin(tri);
+
+	tri->edges[0] = EdgeSetup(fixedA, fixedB, origin);
+	tri->edges[1] = EdgeSetup(fixedB, fixedC, origin);
+	tri->edges[2] = EdgeSetup(fixedC, fixedA, origin);
+	tri->depth = (RasterDepthPlane){0};
+
+	return true;
+}
+
+bool RasterTriangleSetup(RasterTriangle* tri, Vector2 a, Vector2 b, Vector2 c, RasterRect clip) {
+	return TriangleSetup(tri, a, b, c, clip, 0);
+}
+
+bool RasterTriangleSetupSampled(RasterTriangle* tri, Vector2 a, Vector2 b, Vector2 c, RasterRect clip) {
+	return TriangleSetup(tri, a, b, c, clip, RASTER_SUBPIXEL_HALF);
+}
+
+// A vertex's barycentric weight at p is the edge function of the opposite edge at p over the one of the whole triangle
+static RasterPlane PlaneSetup(const RasterTriangle* tri, FixedVertex fixedA, FixedVertex fixedB, FixedVertex fixedC, float valueA,
+							  float valueB, float valueC) {
+	const FixedVertex origin = BoundsOrigin(tri);
+
+	const double area = EdgeFunction(fixedA, fixedB, fixedC);
+	const double weightA = valueA / area;
+	const double weightB = valueB / area;
+	const double weightC = valueC / area;
+
+	return (RasterPlane){
+		.stepX = tri->edges[1].stepX * weightA + tri->edges[2].stepX * weightB + tri->edges[0].stepX * weightC,
+		.stepY = tri->edges[1].stepY * weightA + tri->edges[2].stepY * weightB + tri->edges[0].stepY * weightC,
+		.origin = EdgeFunction(fixedB, fixedC, origin) * weightA + EdgeFunction(fixedC, fixedA, origin) * weightB +
+				  EdgeFunction(fixedA, fixedB, origin) * weightC,
+	};
+}
+
+static bool TriangleSetupDepth(RasterTriangle* tri, Vector3 a, Vector3 b, Vector3 c, RasterRect clip, int64_t margin) {
+	const Vector2 a2 = (Vector2){.x = a.x, .y = a.y};
+	const Vector2 b2 = (Vector2){.x = b.x, .y = b.y};
+	const Vector2 c2 = (Vector2){.x = c.x, .y = c.y};
+	if (!TriangleSetup(tri, a2, b2, c2, clip, margin)) return false;
+
+	const RasterPlane plane = PlaneSetup(tri, ToFixedVertex(a2), ToFixedVertex(b2), ToFixedVertex(c2), a.z, b.z, c.z);
+	tri->depth = (RasterDepthPlane){
+		.stepX = plane.stepX,
+		.stepY = plane.stepY,
+		.origin = plane.origin,
+		.min = fminf(a.z, fminf(b.z, c.z)),
+		.max = fmaxf(a.z, fmaxf(b.z, c.z)),
+		.originX = tri->bounds.minX,
+		.originY = tri->bounds.minY,
+	};
+
+	return true;
+}
+
+bool RasterTriangleSetupDepth(RasterTriangle* tri, Vector3 a, Vector3 b, Vector3 c, RasterRect clip) {
+	return TriangleSetupDepth(tri, a, b, c, clip, 0);
+}
+
+bool RasterTriangleSetupDepthSampled(RasterTriangle* tri, Vector3 a, Vector3 b, Vector3 c, RasterRect clip) {
+	return TriangleSetupDepth(tri, a, b, c, clip, RASTER_SUBPIXEL_HALF);
+}
+
+void RasterTriangleSetupPlanes(const RasterTriangle* tri, Vector2 a, Vector2 b, Vector2 c, const float (*values)[3], uint32_t count,
+							   RasterPlane* planes) {
+	const FixedVertex fixedA = ToFixedVertex(a);
+	const FixedVertex fixedB = ToFixedVertex(b);
+	const FixedVertex fixedC = ToFixedVertex(c);
+
+	for (uint32_t i = 0; i < count; i++) {
+		planes[i] = PlaneSetup(tri, fixedA, fixedB, fixedC, values[i][0], values[i][1], values[i][2]);
+	}
+}
+
+bool RasterTriangleClip(const RasterTriangle* tri, RasterRect clip, RasterTriangle* clipped) {
+	clipped->bounds = (RasterRect){
+		.minX = Max(tri->bounds.minX, clip.minX),
+		.minY = Max(tri->bounds.minY, clip.minY),
+		.maxX = Min(tri->bounds.maxX, clip.maxX),
+		.maxY = Min(tri->bounds.maxY, clip.maxY),
+	};
+	if (clipped->bounds.minX >= clipped->bounds.maxX || clipped->bounds.minY >= clipped->bounds.maxY) return false;
+
+	const int64_t offsetX = clipped->bounds.minX - tri->bounds.minX;
+	const int64_t offsetY = clipped->bounds.minY - tri->bounds.minY;
+	for (uint32_t i = 0; i < 3; i++) {
+		const RasterEdge* edge = tri->edges + i;
+		clipped->edges[i] = (RasterEdge){
+			.stepX = edge->stepX,
+			.stepY = edge->stepY,
+			.origin = edge->origin + edge->stepX * offsetX + edge->stepY * offsetY,
+		};
+	}
+
+	clipped->depth = tri->depth;
+
+	return true;
+}
+
+// Narrows [*first, *last) (offsets from bounds.minX) to where an edge with rowValue at offset 0 is >= 0
+static void ClipSpanToEdge(int64_t rowValue, int64_t stepX, int64_t* first, int64_t* last) {
+	if (stepX > 0) {
+		if (rowValue < 0) *first = Max(*first, (-rowValue + stepX - 1) / stepX);
+	} else if (stepX < 0) {
+		if (rowValue < 0) *last = 0;
+		else *last = Min(*last, rowValue / -stepX + 1);
+	} else if (rowValue < 0) {
+		*last = 0;
+	}
+}
+
+static bool RowSpanFromValues(const RasterTriangle* tri, const int64_t rowValues[3], int32_t* spanMinX, int32_t* spanMaxX) {
+	int64_t first = 0;
+	int64_t last = tri->bounds.maxX - tri->bounds.minX;
+
+	for (uint32_t i = 0; i < 3; i++) {
+		ClipSpanToEdge(rowValues[i], tri->edges[i].stepX, &first, &last);
+	}
+	if (first >= last) return false;
+
+	*spanMinX = tri->bounds.minX + first;
+	*spanMaxX = tri->bounds.minX + last;
+	return true;
+}
+
+bool RasterTriangleRowSpan(const RasterTriangle* tri, int32_t y, int32_t* spanMinX, int32_t* spanMaxX) {
+	const int64_t rowOffset = y - tri->bounds.minY;
+	const int64_t rowValues[3] = {
+		tri->edges[0].origin + tri->edges[0].stepY * rowOffset,
+		tri->edges[1].origin + tri->edges[1].stepY * rowOffset,
+		tri->edges[2].origin + tri->edges[2].stepY * rowOffset,
+	};
+	return RowSpanFromValues(tri, rowValues, spanMinX, spanMaxX);
+}
+
+static uint32_t FillSpans(const RasterTriangle* tri, Color* pixels, uint32_t stride, Color col) {
+	uint32_t written = 0;
+	int64_t rowValues[3] = {
+		tri->edges[0].origin,
+		tri->edges[1].origin,
+		tri->edges[2].origin,
+	};
+
+	for (int32_t y = tri->bounds.minY; y < tri->bounds.maxY; y++) {
+		int32_t spanMinX;
+		int32_t spanMaxX;
+		if (RowSpanFromValues(tri, rowValues, &spanMinX, &spanMaxX)) {
+			Color* row = pixels + Index1D(0, y, stride);
+			for (int32_t x = spanMinX; x < spanMaxX; x++) {
+				row[x] = col;
+			}
+			written += spanMaxX - spanMinX;
+		}
+
+		rowValues[0] += tri->edges[0].stepY;
+		rowValues[1] += tri->edges[1].stepY;
+		rowValues[2] += tri->edges[2].stepY;
+	}
+
+	return written;
+}
+
+#if RASTER_X86_KERNELS
+
+// Writes col to the pixels of the 8 pixels row whose bit is set in covered, with a single wide store when all are
+typedef void (*WriteRowFunc)(Color* row, uint32_t covered, Color col);
+
+// Returns a bit per pixel of the 8 pixels row, set if at least one of the edges is < 0 there
+typedef uint32_t (*RowOutsideMaskFunc)(const int64_t* values, const int64_t* stepsX, uint32_t count);
+
+#define ROW_FULL_MASK ((1u << RASTER_BLOCK_SIZE) - 1)
+
+// Bits set in an 8 bits mask, without relying on a popcnt instruction
+static inline uint32_t PopCount8(uint32_t bits) {
+	bits = bits - ((bits >> 1) & 0x55);
+	bits = (bits & 0x33) + ((bits >> 2) & 0x33);
+	return (bits + (bits >> 4)) & 0x0F;
+}
+
+// Walks the bounds in RASTER_BLOCK_SIZE squared blocks, rejecting blocks outside of an edge and filling blocks inside of
+// all edges without any per pixel test, only the blocks crossed by an edge are tested pixel by pixel (row by row with SIMD)
+static inline __attribute__((always_inline)) uint32_t FillBlocks(const RasterTriangle* tri, Color* pixels, uint32_t stride, Color col,
+																  WriteRowFunc writeRow, RowOutsideMaskFunc rowOutsideMask) {
+	const RasterRect bounds = tri->bounds;
+	uint32_t written = 0;
+
+	int64_t blockRowValues[3] = {
+		tri->edges[0].origin,
+		tri->edges[1].origin,
+		tri->edges[2].origin,
+	};
+
+	for (int32_t by = bounds.minY; by < bounds.maxY; by += RASTER_BLOCK_SIZE) {
+		const int32_t rows = Min(RASTER_BLOCK_SIZE, bounds.maxY - by);
+
+		int64_t blockValues[3] = {blockRowValues[0], blockRowValues[1], blockRowValues[2]};
+		for (int32_t bx = bounds.minX; bx < bounds.maxX; bx += RASTER_BLOCK_SIZE) {
+			const int32_t cols = Min(RASTER_BLOCK_SIZE, bounds.maxX - bx);
+
+			int64_t crossingValues[3];
+			int64_t crossingStepsX[3];
+			int64_t crossingStepsY[3];
+			uint32_t crossingCount = 0;
+			bool rejected = false;
+
+			for (uint32_t i = 0; i < 3; i++) {
+				const RasterEdge* edge = tri->edges + i;
+				const int64_t toLastCol = edge->stepX * (cols - 1);
+				const int64_t toLastRow = edge->stepY * (rows - 1);
+				const int64_t minValue = blockValues[i] + Min(toLastCol, 0) + Min(toLastRow, 0);
+				const int64_t maxValue = blockValues[i] + Max(toLastCol, 0) + Max(toLastRow, 0);
+
+				if (maxValue < 0) {
+					rejected = true;
+					break;
+				}
+
+				if (minValue < 0) {
+					crossingValues[crossingCount] = blockValues[i];
+					crossingStepsX[crossingCount] = edge->stepX;
+					crossingStepsY[crossingCount] = edge->stepY;
+					crossingCount++;
+				}
+			}
+
+			for (uint32_t i = 0; i < 3; i++) {
+				blockValues[i] += tri->edges[i].stepX * RASTER_BLOCK_SIZE;
+			}
+			if (rejected) continue;
+
+			Color* blockStart = pixels + Index1D(bx, by, stride);
+			const uint32_t colsMask = ROW_FULL_MASK >> (RASTER_BLOCK_SIZE - cols);
+
+			for (int32_t r = 0; r < rows; r++) {
+				Color* row = blockStart + Index1D(0, r, stride);
+
+				uint32_t covered = colsMask;
+				if (crossingCount) {
+					covered &= ~rowOutsideMask(crossingValues, crossingStepsX, crossingCount);
+					for (uint32_t i = 0; i < crossingCount; i++) {
+						crossingValues[i] += crossingStepsY[i];
+					}
+				}
+
+				if (covered) {
+					writeRow(row, covered, col);
+					written += PopCount8(covered);
+				}
+			}
+		}
+
+		for (uint32_t i = 0; i < 3; i++) {
+			blockRowValues[i] += tri->edges[i].stepY * RASTER_BLOCK_SIZE;
+		}
+	}
+
+	return written;
+}
+
+static uint32_t ColorToBits(Color col) {
+	uint32_t bits;
+	memcpy(&bits, &col, sizeof(bits));
+	return bits;
+}
+
+__attribute__((target("sse2"))) static void WriteRowSSE2(Color* row, uint32_t covered, Color col) {
+	const __m128i colors = _mm_set1_epi32(ColorToBits(col));
+
+	for (uint32_t half = 0; half < 2; half++) {
+		__m128i* dst = (__m128i*)(row + half * 4);
+		const uint32_t halfCovered = (covered >> (half * 4)) & 0xF;
+
+		if (halfCovered == 0xF) {
+			_mm_storeu_si128(dst, colors);
+			continue;
+		}
+
+		// Partial halves may end past the bounds (or the buffer) and their other pixels may belong to another thread's
+		// tile, so only the covered pixels are stored
+		for (uint32_t i = 0; i < 4; i++) {
+			if (halfCovered & (1u << i)) row[half * 4 + i] = col;
+		}
+	}
+}
+
+// Edge values don't fit in 32 bits, so each SSE2 register holds 2 pixels (int64 lanes) and the sign bits are gathered
+// with movemask_pd
+__attribute__((target("sse2"))) static uint32_t RowOutsideMaskSSE2(const int64_t* values, const int64_t* stepsX, uint32_t count) {
+	__m128i outside01 = _mm_setzero_si128();
+	__m128i outside23 = _mm_setzero_si128();
+	__m128i outside45 = _mm_setzero_si128();
+	__m128i outside67 = _mm_setzero_si128();
+
+	for (uint32_t i = 0; i < count; i++) {
+		const __m128i twoSteps = _mm_set1_epi64x(stepsX[i] * 2);
+		const __m128i lanes01 = _mm_add_epi64(_mm_set1_epi64x(values[i]), _mm_set_epi64x(stepsX[i], 0));
+		const __m128i lanes23 = _mm_add_epi64(lanes01, twoSteps);
+		const __m128i lanes45 = _mm_add_epi64(lanes23, twoSteps);
+		const __m128i lanes67 = _mm_add_epi64(lanes45, twoSteps);
+
+		outside01 = _mm_or_si128(outside01, lanes01);
+		outside23 = _mm_or_si128(outside23, lanes23);
+		outside45 = _mm_or_si128(outside45, lanes45);
+		outside67 = _mm_or_si128(outside67, lanes67);
+	}
+
+	return _mm_movemask_pd(_mm_castsi128_pd(outside01)) | (_mm_movemask_pd(_mm_castsi128_pd(outside23)) << 2) |
+		   (_mm_movemask_pd(_mm_castsi128_pd(outside45)) << 4) | (_mm_movemask_pd(_mm_castsi128_pd(outside67)) << 6);
+}
+
+__attribute__((target("sse2"))) static uint32_t FillBlocksSSE2(const RasterTriangle* tri, Color* pixels, uint32_t stride, Color col) {
+	return FillBlocks(tri, pixels, stride, col, WriteRowSSE2, RowOutsideMaskSSE2);
+}
+
+__attribute__((target("avx2"))) static void WriteRowAVX2(Color* row, uint32_t covered, Color col) {
+	const __m256i colors = _mm256_set1_epi32(ColorToBits(col));
+
+	if (covered == ROW_FULL_MASK) {
+		_mm256_storeu_si256((__m256i*)row, colors);
+		return;
+	}
+
+	const __m256i laneBits = _mm256_set_epi32(128, 64, 32, 16, 8, 4, 2, 1);
+	const __m256i mask = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(covered), laneBits), laneBits);
+	_mm256_maskstore_epi32((int*)row, mask, colors);
+}
+
+__attribute__((target("avx2"))) static uint32_t RowOutsideMaskAVX2(const int64_t* values, const int64_t* stepsX, uint32_t count) {
+	__m256i outside0123 = _mm256_setzero_si256();
+	__m256i outside4567 = _mm256_setzero_si256();
+
+	for (uint32_t i = 0; i < count; i++) {
+		const int64_t step = stepsX[i];
+		const __m256i lanes0123 = _mm256_add_epi64(_mm256_set1_epi64x(values[i]), _mm256_set_epi64x(step * 3, step * 2, step, 0));
+		const __m256i lanes4567 = _mm256_add_epi64(lanes0123, _mm256_set1_epi64x(step * 4));
+
+		outside0123 = _mm256_or_si256(outside0123, lanes0123);
+		outside4567 = _mm256_or_si256(outside4567, lanes4567);
+	}
+
+	return _mm256_movemask_pd(_mm256_castsi256_pd(outside0123)) | (_mm256_movemask_pd(_mm256_castsi256_pd(outside4567)) << 4);
+}
+
+__attribute__((target("avx2"))) static uint32_t FillBlocksAVX2(const RasterTriangle* tri, Color* pixels, uint32_t stride, Color col) {
+	return FillBlocks(tri, pixels, stride, col, WriteRowAVX2, RowOutsideMaskAVX2);
+}
+
+#endif	// RASTER_X86_KERNELS
+
+typedef uint32_t (*FillKernel)(const RasterTriangle* tri, Color* pixels, uint32_t stride, Color col);
+
+static bool IsFillKernelSupported(RasterFillKernelType type) {
+	switch (type) {
+		case RASTER_FILL_KERNEL_SCALAR:
+			return true;
+#if RASTER_X86_KERNELS
+		case RASTER_FILL_KERNEL_SSE2:
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("sse2");
+		case RASTER_FILL_KERNEL_AVX2:
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2");
+#endif
+		default:
+			return false;
+	}
+}
+
+static FillKernel GetFillKernel(RasterFillKernelType type) {
+	switch (type) {
+#if RASTER_X86_KERNELS
+		case RASTER_FILL_KERNEL_SSE2:
+			return FillBlocksSSE2;
+		case RASTER_FILL_KERNEL_AVX2:
+			return FillBlocksAVX2;
+#endif
+		default:
+			return FillSpans;
+	}
+}
+
+// RASTER_FILL_KERNEL_AUTO until the first fill or selection
+static _Atomic RasterFillKernelType currentKernel = RASTER_FILL_KERNEL_AUTO;
+
+bool RasterTriangleSelectFillKernel(RasterFillKernelType type) {
+	if (type == RASTER_FILL_KERNEL_AUTO) {
+		type = RASTER_FILL_KERNEL_SCALAR;
+		if (IsFillKernelSupported(RASTER_FILL_KERNEL_SSE2)) type = RASTER_FILL_KERNEL_SSE2;
+		if (IsFillKernelSupported(RASTER_FILL_KERNEL_AVX2)) type = RASTER_FILL_KERNEL_AVX2;
+	}
+
+	if (!IsFillKernelSupported(type)) return false;
+
+	atomic_store_explicit(&currentKernel, type, memory_order_relaxed);
+	return true;
+}
+
+RasterFillKernelType RasterTriangleGetFillKernel(void) {
+	RasterFillKernelType type = atomic_load_explicit(&currentKernel, memory_order_relaxed);
+	if (type != RASTER_FILL_KERNEL_AUTO) return type;
+
+	RasterTriangleSelectFillKernel(RASTER_FILL_KERNEL_AUTO);
+	return atomic_load_explicit(&currentKernel, memory_order_relaxed);
+}
+
+uint32_t RasterTriangleFill(const RasterTriangle* tri, Color* pixels, uint32_t stride, Color col) {
+	const int32_t width = tri->bounds.maxX - tri->bounds.minX;
+	const int32_t height = tri->bounds.maxY - tri->bounds.minY;
+
+	// Small triangles would mostly hit partial blocks, solving their spans directly is cheaper
+	if (width < RASTER_BLOCK_SIZE || height < RASTER_BLOCK_SIZE) return FillSpans(tri, pixels, stride, col);
+
+	return GetFillKernel(RasterTriangleGetFillKernel())(tri, pixels, stride, col);
+}
@@ -0,0 +1,331 @@
+#define _POSIX_C_SOURCE 200809L	 // writev
+
+#include "RasterVideoSink.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define RASTER_HAS_WRITEV 1
+#include <sys/uio.h>
+#else
+#define RASTER_HAS_WRITEV 0
+struct iovec {
+	void* iov_base;
+	size_t iov_len;
+};
+#endif
+
+#if defined(__SSE2__)
+#define RASTER_SSE_VIDEO 1
+#include <immintrin.h>
+#else
+#define RASTER_SSE_VIDEO 0
+#endif
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+#define Y4M_FRAME_HEADER "FRAME\n"
+#define Y4M_FRAME_HEADER_LEN 6
+
+// ============= Y4M conversion =============
+
+// BT.601 limited range, in 8 bits fixed point, the chroma of each 2x2 block comes from the sums of its 4 pixels
+#define LUMA_R 66
+#define LUMA_G 129
+#define LUMA_B 25
+#define CHROMA_U_R -38
+#define CHROMA_U_G -74
+#define CHROMA_U_B 112
+#define CHROMA_V_R 112
+#define CHROMA_V_G -94
+#define CHROMA_V_B -18
+#define CHROMA_BIAS ((128 << 10) + 512)	 // Keeps the sums positive before the shift, and rounds them
+
+static uint32_t ChromaSize(uint32_t size) { return (size + 1) / 2; }
+
+static size_t Y4MFrameSize(uint32_t width, uint32_t height) {
+	return (size_t)width * height + 2 * (size_t)ChromaSize(width) * ChromaSize(height);
+}
+
+static inline uint8_t Luma(Color col) { return ((LUMA_R * col.r + LUMA_G * col.g + LUMA_B * col.b + 128) >> 8) + 16; }
+
+static inline uint8_t Chroma(int32_t r, int32_t g, int32_t b, int32_t weightR, int32_t weightG, int32_t weightB) {
+	return (weightR * r + weightG * g + weightB * b + CHROMA_BIAS) >> 10;
+}
+
+// Rows and columns past the frame's edges repeat the last ones, rows are the same pointers for odd heights
+typedef struct Y4MRowPair {
+	const Color* top;
+	const Color* bottom;
+	uint8_t* topLuma;
+	uint8_t* bottomLuma;
+	uint8_t* u;
+	uint8_t* v;
+} Y4MRowPair;
+
+static void ConvertRowPairScalar(const Y4MRowPair* rows, uint32_t x, uint32_t width) {
+	for (; x < width; x += 2) {
+		const uint32_t right = Min(x + 1, width - 1);
+		rows->topLuma[x] = Luma(rows->top[x]);
+		rows->bottomLuma[x] = Luma(rows->bottom[x]);
+		rows->topLuma[right] = Luma(rows->top[right]);
+		rows->bottomLuma[right] = Luma(rows->bottom[right]);
+
+		const int32_t r = rows->top[x].r + rows->top[right].r + rows->bottom[x].r + rows->bottom[right].r;
+		const int32_t g = rows->top[x].g + rows->top[right].g + rows->bottom[x].g + rows->bottom[right].g;
+		const int32_t b = rows->top[x].b + rows->top[right].b + rows->bottom[x].b + rows->bottom[right].b;
+		rows->u[x / 2] = Chroma(r, g, b, CHROMA_U_R, CHROMA_U_G, CHROMA_U_B);
+		rows->v[x / 2] = Chroma(r, g, b, CHROMA_V_R, CHROMA_V_G, CHROMA_V_B);
+	}
+}
+
+#if RASTER_SSE_VIDEO
+
+// Weighted sums of 4 pixels (or blocks), lo and hi hold 2 of them each with 16 bits RGBA channels
+static __m128i WeightedSums(__m128i lo, __m128i hi, __m128i weights) {
+	const __m128 a = _mm_castsi128_ps(_mm_madd_epi16(lo, weights));	 // RG of the first, BA of the first, RG of the second, ...
+	const __m128 b = _mm_castsi128_ps(_mm_madd_epi16(hi, weights));
+	return _mm_add_epi32(_mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))),
+						 _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))));
+}
+
+static __m128i Luma4(__m128i rgba) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i weights = _mm_setr_epi16(LUMA_R, LUMA_G, LUMA_B, 0, LUMA_R, LUMA_G, LUMA_B, 0);
+	const __m128i sums = WeightedSums(_mm_unpacklo_epi8(rgba, zero), _mm_unpackhi_epi8(rgba, zero), weights);
+	return _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(sums, _mm_set1_epi32(128)), 8), _mm_set1_epi32(16));
+}
+
+// Channel sums of the 2 blocks under 4 pixels of each row, as 16 bits RGBA
+static __m128i BlockSums2(__m128i top, __m128i bottom) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero));
+	const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero));
+	return _mm_unpacklo_epi64(_mm_add_epi16(lo, _mm_srli_si128(lo, 8)), _mm_add_epi16(hi, _mm_srli_si128(hi, 8)));
+}
+
+static void StoreChroma4(uint8_t* dst, __m128i blocksLo, __m128i blocksHi, int16_t weightR, int16_t weightG, int16_t weightB) {
+	const __m128i weights = _mm_setr_epi16(weightR, weightG, weightB, 0, weightR, weightG, weightB, 0);
+	const __m128i chroma = _mm_srai_epi32(_mm_add_epi32(WeightedSums(blocksLo, blocksHi, weights), _mm_set1_epi32(CHROMA_BIAS)), 10);
+	const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(chroma, chroma), chroma);
+	const int32_t bytes = _mm_cvtsi128_si32(packed);
+	memcpy(dst, &bytes, sizeof(bytes));
+}
+
+static void StoreLuma8(uint8_t* dst, __m128i lo, __m128i hi) {
+	const __m128i luma = _mm_packs_epi32(Luma4(lo), Luma4(hi));
+	_mm_storel_epi64((__m128i*)dst, _mm_packus_epi16(luma, luma));
+}
+
+// 8 pixels of both rows per iteration, same results as the scalar conversion
+static uint32_t ConvertRowPairSSE(const Y4MRowPair* rows, uint32_t width) {
+	uint32_t x = 0;
+	for (; x + 8 <= width; x += 8) {
+		const __m128i top0 = _mm_loadu_si128((const __m128i*)(rows->top + x));
+		const __m128i top1 = _mm_loadu_si128((const __m128i*)(rows->top + x + 4));
+		const __m128i bottom0 = _mm_loadu_si128((const __m128i*)(rows->bottom + x));
+		const __m128i bottom1 = _mm_loadu_si128((const __m128i*)(rows->bottom + x + 4));
+
+		StoreLuma8(rows->topLuma + x, top0, top1);
+		StoreLuma8(rows->bottomLuma + x, bottom0, bottom1);
+
+		const __m128i blocksLo = BlockSums2(top0, bottom0);
+		const __m128i blocksHi = BlockSums2(top1, bottom1);
+		StoreChroma4(rows->u + x / 2, blocksLo, blocksHi, CHROMA_U_R, CHROMA_U_G, CHROMA_U_B);
+		StoreChroma4(rows->v + x / 2, blocksLo, blocksHi, CHROMA_V_R, CHROMA_V_G, CHROMA_V_B);
+	}
+	return x;
+}
+
+#endif	// RASTER_SSE_VIDEO
+
+// Planar Y, then U and V at half the resolution (rounded up)
+static void ConvertY4M(const Color* pixels, uint32_t width, uint32_t height, uint8_t* planes) {
+	const uint32_t chromaWidth = ChromaSize(width);
+	uint8_t* lumaPlane = planes;
+	uint8_t* uPlane = lumaPlane + (size_t)width * height;
+	uint8_t* vPlane = uPlane + (size_t)chromaWidth * ChromaSize(height);
+
+	for (uint32_t y = 0; y < height; y += 2) {
+		const uint32_t bottomY = Min(y + 1, height - 1);
+		const Y4MRowPair rows = (Y4MRowPair){
+			.top = pixels + (size_t)y * width,
+			.bottom = pixels + (size_t)bottomY * width,
+			.topLuma = lumaPlane + (size_t)y * width,
+			.bottomLuma = lumaPlane + (size_t)bottomY * width,
+			.u = uPlane + (size_t)(y / 2) * chromaWidth,
+			.v = vPlane + (size_t)(y / 2) * chromaWidth,
+		};
+
+		uint32_t x = 0;
+#if RASTER_SSE_VIDEO
+		x = ConvertRowPairSSE(&rows, width);
+#endif
+		ConvertRowPairScalar(&rows, x, width);
+	}
+}
+
+// ============= Writing =============
+
+static size_t FrameSize(const RasterVideoSink* sink) {
+	if (sink->format == RASTER_VIDEO_Y4M) return Y4MFrameSize(sink->width, sink->height);
+	return (size_t)sink->width * sink->height * 3;
+}
+
+// Loops over partial writes, which pipes make common for frames larger than their buffer
+static bool WriteChunks(int fd, struct iovec* chunks, int chunksCount) {
+	while (chunksCount) {
+#if RASTER_HAS_WRITEV
+		const ssize_t written = writev(fd, chunks, chunksCount);
+#else
+		const ssize_t written = write(fd, chunks->iov_base, chunks->iov_len);
+#endif
+		if (written < 0) {
+			if (errno == EINTR) continue;
+			return false;
+		}
+
+		size_t left = written;
+		while (chunksCount && left >= chunks->iov_len) {
+			left -= chunks->iov_len;
+			chunks++;
+			chunksCount--;
+		}
+		if (chunksCount) {
+			chunks->iov_base = (uint8_t*)chunks->iov_base + left;
+			chunks->iov_len -= left;
+		}
+	}
+	return true;
+}
+
+// A single gathered write per frame: the stream's header (first Y4M frame only) or the PPM header, then the frame
+static bool WriteFrame(RasterVideoSink* sink, const Color* pixels) {
+	if (atomic_load(&sink->failed)) return false;
+
+	if (sink->format == RASTER_VIDEO_Y4M) ConvertY4M(pixels, sink->width, sink->height, sink->converted);
+	else RasterPackPixels24(pixels, (size_t)sink->width * sink->height, false, sink->converted);
+
+	struct iovec chunks[3];
+	int chunksCount = 0;
+	if (sink->format == RASTER_VIDEO_PPM || !sink->headerWritten) {
+		chunks[chunksCount++] = (struct iovec){.iov_base = sink->header, .iov_len = sink->headerSize};
+	}
+	if (sink->format == RASTER_VIDEO_Y4M) {
+		chunks[chunksCount++] = (struct iovec){.iov_base = Y4M_FRAME_HEADER, .iov_len = Y4M_FRAME_HEADER_LEN};
+	}
+	chunks[chunksCount++] = (struct iovec){.iov_base = sink->converted, .iov_len = sink->convertedSize};
+
+	if (!WriteChunks(sink->fd, chunks, chunksCount)) {
+		LogMessage("Could not write to the video stream (%s)\n", strerror(errno));
+		atomic_store(&sink->failed, true);
+		return false;
+	}
+
+	sink->headerWritten = true;
+	return true;
+}
+
+static bool WriteQueuedFrame(void* userData, const RasterFrameSlot* slot) { return WriteFrame(userData, slot->pixels); }
+
+// ============= Sink =============
+
+static bool FormatHeader(RasterVideoSink* sink) {
+	int headerSize;
+	if (sink->format == RASTER_VIDEO_Y4M) {
+		headerSize = snprintf(sink->header, RASTER_VIDEO_HEADER_SIZE, "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C420jpeg\n", sink->width,
+							  sink->height, sink->framesPerSecond);
+	} else {
+		headerSize = snprintf(sink->header, RASTER_VIDEO_HEADER_SIZE, "P6\n%u %u\n255\n", sink->width, sink->height);
+	}
+
+	if (headerSize < 0 || headerSize >= RASTER_VIDEO_HEADER_SIZE) return false;
+	sink->headerSize = headerSize;
+	return true;
+}
+
+#define RasterVideoSinkOpenFdExitFail()             \
+	{                                               \
+		if (sink->converted) Free(sink->converted); \
+		FreeAndReturn(sink, NULL);                  \
+	}
+
+RasterVideoSink* RasterVideoSinkOpenFd(int fd, RasterVideoFormat format, uint32_t width, uint32_t height, uint32_t framesPerSecond,
+									   uint32_t queueDepth) {
+	if (format != RASTER_VIDEO_Y4M && format != RASTER_VIDEO_PPM) return NULL;
+	if (!width || !height || !framesPerSecond) return NULL;
+
+	RasterVideoSink* sink = NULL;
+	if (!Malloc(sink, sizeof(RasterVideoSink))) return NULL;
+	*sink = (RasterVideoSink){
+		.fd = fd,
+		.format = format,
+		.width = width,
+		.height = height,
+		.framesPerSecond = framesPerSecond,
+	};
+	atomic_init(&sink->failed, false);
+
+	if (!FormatHeader(sink)) RasterVideoSinkOpenFdExitFail();
+
+	sink->convertedSize = FrameSize(sink);
+	if (!Malloc(sink->converted, sink->convertedSize)) RasterVideoSinkOpenFdExitFail();
+
+	if (queueDepth) {
+		sink->queue = RasterFrameWriterCreateEx(queueDepth, WriteQueuedFrame, sink);
+		if (!sink->queue) RasterVideoSinkOpenFdExitFail();
+	}
+
+	return sink;
+}
+
+RasterVideoSink* RasterVideoSinkOpen(const char* path, RasterVideoFormat format, uint32_t width, uint32_t height,
+									 uint32_t framesPerSecond, uint32_t queueDepth) {
+	if (!strcmp(path, "-")) return RasterVideoSinkOpenFd(STDOUT_FILENO, format, width, height, framesPerSecond, queueDepth);
+
+	const int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0644);
+	if (fd < 0) {
+		LogMessage("Could not open \"%s\" (%s)\n", path, strerror(errno));
+		return NULL;
+	}
+
+	RasterVideoSink* sink = RasterVideoSinkOpenFd(fd, format, width, height, framesPerSecond, queueDepth);
+	if (!sink) {
+		close(fd);
+		return NULL;
+	}
+
+	sink->ownsFd = true;
+	return sink;
+}
+
+bool RasterVideoSinkClose(RasterVideoSink* sink) {
+	bool success = true;
+	if (sink->queue) {
+		success = RasterFrameWriterFlush(sink->queue);
+		RasterFrameWriterFree(sink->queue);
+	}
+	success = success && !atomic_load(&sink->failed);
+
+	if (sink->ownsFd && close(sink->fd)) success = false;
+
+	Free(sink->converted);
+	Free(sink);
+	return success;
+}
+
+bool RasterVideoSinkPush(RasterVideoSink* sink, const Color* pixels) {
+	if (atomic_load(&sink->failed)) return false;
+	if (sink->queue) return RasterFrameWriterQueue(sink->queue, NULL, pixels, sink->width, sink->height);
+	return WriteFrame(sink, pixels);
+}
+
+bool RasterVideoSinkFlush(RasterVideoSink* sink) {
+	if (sink->queue && !RasterFrameWriterFlush(sink->queue)) return false;
+	return !atomic_load(&sink->failed);
+}
@@ -1,14 +1,32 @@
-#include "main.h"
-
-int main(void) {
-	App app = {0};
-	if (!AppInit(&app)) exit(EXIT_FAILURE);
-
-	while (!WindowShouldClose()) {
-		AppUpdate(&app);
-		AppRender(&app);
-	}
-	AppClose(&app);
-
-	exit(EXIT_SUCCESS);
-}
+#include "main.h"
+
+#ifndef RASTER_HEADLESS
+static int RunWindowed(void) {
+	App app = {0};
+	if (!AppInit(&app)) return EXIT_FAILURE;
+
+	while (!WindowShouldClose()) {
+		AppUpdate(&app);
+		AppRender(&app);
+	}
+	AppClose(&app);
+
+	return EXIT_SUCCESS;
+}
+#endif
+
+static int RunBatch(int argc, char** argv) {
+	BatchRenderOptions options;
+	if (!BatchRenderParseArgs(&options, argc, argv)) return EXIT_FAILURE;
+
+	return BatchRender(&options) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char** argv) {
+#ifndef RASTER_HEADLESS
+	// Any argument switches to batch rendering, which never opens a window
+	if (argc <= 1) exit(RunWindowed());
+#endif
+
+	exit(RunBatch(argc, argv));
+}
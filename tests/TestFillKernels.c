@@ -0,0 +1,84 @@
+#include <stdio.h>
+
+#include "RasterTriangle.h"
+
+// Every fill kernel must write exactly the pixels the scalar one does, the targets' widths not being multiples of the
+// blocks' so partial rows end at the bounds, and each buffer being allocated at its exact size so a sanitized build
+// (make test CC="gcc -fsanitize=address" LD="gcc -fsanitize=address") catches any access past it
+
+#define TRIANGLES_PER_TARGET 256
+#define TARGET_HEIGHT 21
+
+static const uint32_t targetWidths[] = {8, 9, 13, 15, 17, 21, 30, 37, 63, 67};
+
+static const RasterFillKernelType kernels[] = {RASTER_FILL_KERNEL_SSE2, RASTER_FILL_KERNEL_AVX2};
+static const char* kernelNames[] = {"sse2", "avx2"};
+
+static uint32_t NextRandom(uint32_t* state) {
+	*state = *state * 1664525u + 1013904223u;
+	return *state >> 8;
+}
+
+// In [-margin, size + margin), so some triangles are clipped by the target
+static float RandomCoord(uint32_t* state, uint32_t size, float margin) {
+	return (NextRandom(state) % 1024) / 1024.0f * (size + 2.0f * margin) - margin;
+}
+
+// Draws the same triangles whatever the kernel, returns the pixels written
+static uint64_t DrawTriangles(Color* pixels, uint32_t width, uint32_t height) {
+	const RasterRect clip = (RasterRect){.minX = 0, .minY = 0, .maxX = width, .maxY = height};
+	for (uint32_t i = 0; i < width * height; i++) pixels[i] = (Color){0, 0, 0, 255};
+
+	uint32_t state = width * 7919u + height;
+	uint64_t written = 0;
+	for (uint32_t i = 0; i < TRIANGLES_PER_TARGET; i++) {
+		const Vector2 a = (Vector2){RandomCoord(&state, width, 4.0f), RandomCoord(&state, height, 4.0f)};
+		const Vector2 b = (Vector2){RandomCoord(&state, width, 4.0f), RandomCoord(&state, height, 4.0f)};
+		const Vector2 c = (Vector2){RandomCoord(&state, width, 4.0f), RandomCoord(&state, height, 4.0f)};
+		const Color col = (Color){i, i * 3, i * 7, 255};
+
+		// Either winding is drawn, so about every triangle counts
+		RasterTriangle tri;
+		if (RasterTriangleSetup(&tri, a, b, c, clip) || RasterTriangleSetup(&tri, a, c, b, clip)) {
+			written += RasterTriangleFill(&tri, pixels, width, col);
+		}
+	}
+
+	return written;
+}
+
+int main(void) {
+	uint32_t failures = 0;
+
+	for (uint32_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+		if (!RasterTriangleSelectFillKernel(kernels[k])) {
+			LogMessage("Skipping the %s kernel, unsupported by this CPU or build\n", kernelNames[k]);
+			continue;
+		}
+
+		for (uint32_t w = 0; w < sizeof(targetWidths) / sizeof(targetWidths[0]); w++) {
+			const uint32_t width = targetWidths[w];
+			const size_t pixelsSize = (size_t)width * TARGET_HEIGHT * sizeof(Color);
+
+			Color* expected = NULL;
+			Color* actual = NULL;
+			if (!Malloc(expected, pixelsSize)) exit(EXIT_FAILURE);
+			if (!Malloc(actual, pixelsSize)) exit(EXIT_FAILURE);
+
+			RasterTriangleSelectFillKernel(RASTER_FILL_KERNEL_SCALAR);
+			const uint64_t expectedWritten = DrawTriangles(expected, width, TARGET_HEIGHT);
+			RasterTriangleSelectFillKernel(kernels[k]);
+			const uint64_t actualWritten = DrawTriangles(actual, width, TARGET_HEIGHT);
+
+			const bool passed = expectedWritten == actualWritten && !memcmp(expected, actual, pixelsSize);
+			LogMessage("%s %ux%u: %s\n", kernelNames[k], width, TARGET_HEIGHT, passed ? "ok" : "FAILED");
+			failures += !passed;
+
+			Free(expected);
+			Free(actual);
+		}
+	}
+
+	RasterTriangleSelectFillKernel(RASTER_FILL_KERNEL_AUTO);
+	exit(failures ? EXIT_FAILURE : EXIT_SUCCESS);
+}